@@ -46,28 +46,195 @@
 extern "C" {
 #endif
 
+/**
+ * Flags for SDL_PhysFS_EnumerateDirectoryEx().
+ */
+typedef Uint32 SDL_PhysFS_EnumerateFlags;
+
+#define SDL_PHYSFS_ENUMERATE_UNIQUE (1u << 0) /**< Skip names already provided by an earlier mount. */
+#define SDL_PHYSFS_ENUMERATE_SORTED (1u << 1) /**< Provide names sorted and unique, after reading the whole directory. */
+
+/**
+ * Flags for SDL_PhysFS_Walk().
+ */
+typedef Uint32 SDL_PhysFS_WalkFlags;
+
+#define SDL_PHYSFS_WALK_CASEINSENSITIVE (1u << 0) /**< Match the pattern case-insensitively, like SDL_GLOB_CASEINSENSITIVE. */
+#define SDL_PHYSFS_WALK_PARALLEL (1u << 1)        /**< Traverse subdirectories on worker threads. */
+
+/**
+ * Called by SDL_PhysFS_Walk() for each matching entry.
+ *
+ * @param userdata The pointer passed to SDL_PhysFS_Walk().
+ * @param path The full path of the entry in the search path.
+ * @param info The entry's type, size and times.
+ *
+ * @return SDL_ENUM_CONTINUE to keep walking, SDL_ENUM_SUCCESS to stop, or SDL_ENUM_FAILURE to stop with an error.
+ */
+typedef SDL_EnumerationResult (SDLCALL *SDL_PhysFS_WalkCallback)(void* userdata, const char* path, const SDL_PathInfo* info);
+
+/**
+ * Counters kept for each file and mount, when built with SDL_PHYSFS_STATS.
+ *
+ * @see SDL_PhysFS_GetStats()
+ */
+typedef struct SDL_PhysFS_Counters {
+    Uint64 opens;            /**< Files opened for reading. */
+    Uint64 reads;            /**< Read calls. */
+    Uint64 bytesRead;        /**< Bytes read. */
+    Uint64 seeks;            /**< Seek calls. */
+    Uint64 timeNS;           /**< Time spent opening, reading, seeking and closing, in nanoseconds. */
+    Uint64 cacheHits;        /**< Lookups answered by the path cache. */
+    Uint64 cacheMisses;      /**< Lookups the path cache had to resolve through the search path. */
+    Uint64 contentCacheHits; /**< Loads answered by the content cache, without opening the file. */
+} SDL_PhysFS_Counters;
+
+/**
+ * The counters for a single file or mount.
+ */
+typedef struct SDL_PhysFS_StatsEntry {
+    const char* name;             /**< The file's path in the search path, or the mounted directory or archive. */
+    SDL_PhysFS_Counters counters; /**< The counters. */
+} SDL_PhysFS_StatsEntry;
+
+/**
+ * A snapshot of the counters, from SDL_PhysFS_GetStats().
+ */
+typedef struct SDL_PhysFS_Stats {
+    SDL_PhysFS_Counters total;      /**< The counters across all files. */
+    SDL_PhysFS_StatsEntry* files;   /**< Each file, the most time spent first. */
+    int numFiles;                   /**< The number of files. */
+    SDL_PhysFS_StatsEntry* mounts;  /**< Each mount, the most time spent first. */
+    int numMounts;                  /**< The number of mounts. */
+} SDL_PhysFS_Stats;
+
+/**
+ * The operation reported to an SDL_PhysFS_TraceCallback.
+ */
+typedef enum SDL_PhysFS_TraceEvent {
+    SDL_PHYSFS_TRACE_OPEN,  /**< A file was opened for reading. */
+    SDL_PHYSFS_TRACE_READ,  /**< Data was read. bytes is the number of bytes read. */
+    SDL_PHYSFS_TRACE_SEEK,  /**< The position was changed. bytes is the new position, or -1 on failure. */
+    SDL_PHYSFS_TRACE_CLOSE  /**< The file was closed. */
+} SDL_PhysFS_TraceEvent;
+
+/**
+ * Called after each traced operation, on the thread that performed it.
+ *
+ * @param userdata The pointer passed to SDL_PhysFS_SetTraceCallback().
+ * @param event The operation.
+ * @param filename The file's path in the search path.
+ * @param timestampNS When the operation started, from SDL_GetTicksNS().
+ * @param durationNS How long the operation took, in nanoseconds.
+ * @param bytes Depends on the event, see SDL_PhysFS_TraceEvent.
+ */
+typedef void (SDLCALL *SDL_PhysFS_TraceCallback)(void* userdata, SDL_PhysFS_TraceEvent event, const char* filename, Uint64 timestampNS, Uint64 durationNS, Sint64 bytes);
+
+/**
+ * A queue of asynchronous loads, processed by a pool of worker threads.
+ *
+ * @see SDL_PhysFS_CreateAsyncQueue()
+ */
+typedef struct SDL_PhysFS_AsyncQueue SDL_PhysFS_AsyncQueue;
+
+/**
+ * A single asynchronous load, valid until its outcome has been retrieved.
+ *
+ * @see SDL_PhysFS_LoadFileAsync()
+ */
+typedef struct SDL_PhysFS_AsyncTask SDL_PhysFS_AsyncTask;
+
+/**
+ * The kind of asynchronous load that was requested.
+ */
+typedef enum SDL_PhysFS_AsyncType {
+    SDL_PHYSFS_ASYNC_LOADFILE,    /**< SDL_PhysFS_LoadFileAsync(): data and size are set. */
+    SDL_PHYSFS_ASYNC_LOADSURFACE, /**< SDL_PhysFS_LoadSurfaceAsync(): surface is set. */
+    SDL_PHYSFS_ASYNC_LOADWAV,     /**< SDL_PhysFS_LoadWAVAsync(): data, size and spec are set. */
+    SDL_PHYSFS_ASYNC_WRITEFILE    /**< SDL_PhysFS_WriteFileAtomicAsync(): size is set to the bytes written. */
+} SDL_PhysFS_AsyncType;
+
+/**
+ * The result of a finished asynchronous load.
+ *
+ * Ownership of data or surface passes to the caller, who frees them with SDL_free() or SDL_DestroySurface().
+ */
+typedef struct SDL_PhysFS_AsyncOutcome {
+    SDL_PhysFS_AsyncTask* task; /**< The task this outcome belongs to. It is no longer valid. */
+    SDL_PhysFS_AsyncType type;  /**< The kind of load. */
+    bool success;               /**< Whether the load succeeded. On failure, SDL_GetError() has the details. */
+    void* data;                 /**< The file contents or audio samples. */
+    size_t size;                /**< The size of data in bytes. */
+    SDL_Surface* surface;       /**< The loaded surface. */
+    SDL_AudioSpec spec;         /**< The format of the audio samples. */
+    void* userdata;             /**< The userdata passed when the load was queued. */
+} SDL_PhysFS_AsyncOutcome;
+
 SDL_PHYSFS_DEF int SDL_PhysFS_GetVersion(void);
 SDL_PHYSFS_DEF bool SDL_PhysFS_Init(const char* argv);
 SDL_PHYSFS_DEF bool SDL_PhysFS_InitEx(const char* argv, const char* org, const char* app);
 SDL_PHYSFS_DEF bool SDL_PhysFS_Quit();
+SDL_PHYSFS_DEF void SDL_PhysFS_RefreshMemoryFunctions(void);
 SDL_PHYSFS_DEF bool SDL_PhysFS_Mount(const char* newDir, const char* mountPoint);
 SDL_PHYSFS_DEF bool SDL_PhysFS_MountFromMemory(const unsigned char *fileData, size_t dataSize, const char* newDir, const char* mountPoint);
 SDL_PHYSFS_DEF bool SDL_PhysFS_MountFromIO(SDL_IOStream* src, const char* newDir, const char* mountPoint, bool closeio);
 SDL_PHYSFS_DEF bool SDL_PhysFS_Unmount(const char* oldDir);
+SDL_PHYSFS_DEF bool SDL_PhysFS_WriteMountIndex(const char* archive);
 SDL_PHYSFS_DEF SDL_IOStream* SDL_PhysFS_IOFromFile(const char* filename);
+SDL_PHYSFS_DEF SDL_IOStream* SDL_PhysFS_IOFromFileEx(const char* filename, size_t bufferSize);
+SDL_PHYSFS_DEF bool SDL_PhysFS_SetIORewindSize(SDL_IOStream* io, size_t size);
 SDL_PHYSFS_DEF SDL_Surface* SDL_PhysFS_LoadBMP(const char* filename);
 SDL_PHYSFS_DEF SDL_Surface* SDL_PhysFS_LoadJPG(const char* filename);
 SDL_PHYSFS_DEF SDL_Surface* SDL_PhysFS_LoadPNG(const char* filename);
 SDL_PHYSFS_DEF SDL_Surface* SDL_PhysFS_LoadSurface(const char* filename);
+SDL_PHYSFS_DEF SDL_Surface* SDL_PhysFS_LoadSurfaceFormat(const char* filename, SDL_PixelFormat format);
+SDL_PHYSFS_DEF bool SDL_PhysFS_LoadSurfacesFormat(const char** filenames, int count, SDL_PixelFormat format, SDL_Surface** surfaces);
+SDL_PHYSFS_DEF SDL_Texture* SDL_PhysFS_LoadTexture(SDL_Renderer* renderer, const char* filename);
+SDL_PHYSFS_DEF bool SDL_PhysFS_LoadTextures(SDL_Renderer* renderer, const char** filenames, int count, SDL_Texture** textures);
 SDL_PHYSFS_DEF bool SDL_PhysFS_LoadWAV(const char* filename, SDL_AudioSpec * spec, Uint8 ** audio_buf, Uint32 * audio_len);
+SDL_PHYSFS_DEF SDL_AudioStream* SDL_PhysFS_OpenAudioStream(const char* filename, const SDL_AudioSpec* dst_spec);
 SDL_PHYSFS_DEF void* SDL_PhysFS_LoadFile(const char* filename, size_t *datasize);
+SDL_PHYSFS_DEF int SDL_PhysFS_TryOpen(const char* filename, SDL_IOStream** io);
+SDL_PHYSFS_DEF int SDL_PhysFS_TryLoadFile(const char* filename, void** data, size_t* datasize);
+SDL_PHYSFS_DEF SDL_PhysFS_AsyncQueue* SDL_PhysFS_CreateAsyncQueue(int numThreads);
+SDL_PHYSFS_DEF void SDL_PhysFS_DestroyAsyncQueue(SDL_PhysFS_AsyncQueue* queue);
+SDL_PHYSFS_DEF SDL_PhysFS_AsyncTask* SDL_PhysFS_LoadFileAsync(const char* filename, SDL_PhysFS_AsyncQueue* queue, void* userdata);
+SDL_PHYSFS_DEF SDL_PhysFS_AsyncTask* SDL_PhysFS_LoadSurfaceAsync(const char* filename, SDL_PhysFS_AsyncQueue* queue, void* userdata);
+SDL_PHYSFS_DEF SDL_PhysFS_AsyncTask* SDL_PhysFS_LoadWAVAsync(const char* filename, SDL_PhysFS_AsyncQueue* queue, void* userdata);
+SDL_PHYSFS_DEF bool SDL_PhysFS_IsAsyncTaskDone(SDL_PhysFS_AsyncTask* task);
+SDL_PHYSFS_DEF bool SDL_PhysFS_WaitAsyncTask(SDL_PhysFS_AsyncTask* task, SDL_PhysFS_AsyncOutcome* outcome);
+SDL_PHYSFS_DEF bool SDL_PhysFS_GetAsyncResult(SDL_PhysFS_AsyncQueue* queue, SDL_PhysFS_AsyncOutcome* outcome);
+SDL_PHYSFS_DEF bool SDL_PhysFS_WaitAsyncResult(SDL_PhysFS_AsyncQueue* queue, SDL_PhysFS_AsyncOutcome* outcome, Sint32 timeoutMS);
+SDL_PHYSFS_DEF void* SDL_PhysFS_LoadFiles(const char** filenames, int count, void** buffers, size_t* sizes);
+SDL_PHYSFS_DEF const void* SDL_PhysFS_MapFile(const char* filename, size_t *datasize);
+SDL_PHYSFS_DEF void SDL_PhysFS_UnmapFile(const void* data);
 SDL_PHYSFS_DEF size_t SDL_PhysFS_WriteFile(const char* file, const void* buffer, size_t size);
+SDL_PHYSFS_DEF size_t SDL_PhysFS_WriteFileAtomic(const char* file, const void* buffer, size_t size);
+SDL_PHYSFS_DEF SDL_PhysFS_AsyncTask* SDL_PhysFS_WriteFileAtomicAsync(const char* file, const void* buffer, size_t size, SDL_PhysFS_AsyncQueue* queue, void* userdata);
+SDL_PHYSFS_DEF SDL_IOStream* SDL_PhysFS_OpenOverlayIO(const char* filename);
 SDL_PHYSFS_DEF bool SDL_PhysFS_SetWriteDir(const char* path);
 SDL_PHYSFS_DEF const char* SDL_PhysFS_GetWriteDir(void);
 SDL_PHYSFS_DEF char** SDL_PhysFS_LoadDirectoryFiles(const char *directory);
 SDL_PHYSFS_DEF bool SDL_PhysFS_EnumerateDirectory(const char* path, SDL_EnumerateDirectoryCallback callback, void *userdata);
+SDL_PHYSFS_DEF bool SDL_PhysFS_EnumerateDirectoryEx(const char* path, SDL_PhysFS_EnumerateFlags flags, SDL_EnumerateDirectoryCallback callback, void *userdata);
+SDL_PHYSFS_DEF bool SDL_PhysFS_Walk(const char* root, const char* pattern, SDL_PhysFS_WalkFlags flags, SDL_PhysFS_WalkCallback callback, void* userdata);
 SDL_PHYSFS_DEF void SDL_PhysFS_FreeDirectoryFiles(char** files);
 SDL_PHYSFS_DEF bool SDL_PhysFS_Exists(const char* file);
+SDL_PHYSFS_DEF void SDL_PhysFS_SetPathCacheEnabled(bool enabled);
+SDL_PHYSFS_DEF void SDL_PhysFS_SetParallelReads(bool enabled);
+SDL_PHYSFS_DEF void SDL_PhysFS_ClearPathCache(void);
+SDL_PHYSFS_DEF void SDL_PhysFS_SetContentCacheSize(size_t maxBytes);
+SDL_PHYSFS_DEF void SDL_PhysFS_ClearContentCache(void);
+SDL_PHYSFS_DEF const void* SDL_PhysFS_AcquireFile(const char* filename, size_t* datasize);
+SDL_PHYSFS_DEF void SDL_PhysFS_ReleaseFile(const void* data);
+SDL_PHYSFS_DEF void SDL_PhysFS_StartAccessRecording(void);
+SDL_PHYSFS_DEF bool SDL_PhysFS_StopAccessRecording(const char* manifest);
+SDL_PHYSFS_DEF bool SDL_PhysFS_Prefetch(const char* manifest);
+SDL_PHYSFS_DEF void SDL_PhysFS_WaitPrefetch(void);
+SDL_PHYSFS_DEF void SDL_PhysFS_CancelPrefetch(void);
+SDL_PHYSFS_DEF SDL_PhysFS_Stats* SDL_PhysFS_GetStats(void);
+SDL_PHYSFS_DEF void SDL_PhysFS_ResetStats(void);
+SDL_PHYSFS_DEF bool SDL_PhysFS_SetTraceCallback(SDL_PhysFS_TraceCallback callback, void* userdata);
 SDL_PHYSFS_DEF SDL_IOStatus SDL_PhysFS_IOStatus(int error);
 
 #ifdef _INCLUDE_PHYSFS_H_
@@ -171,638 +338,7286 @@ SDL_PHYSFS_DEF SDL_IOStream *SDL_PhysFS_OpenIO(PHYSFS_File *handle);
 #endif
 #include SDL_PHYSFS_PHYSFS_H
 
+// File descriptors for syncing writes to disk
+#if defined(__unix__) || defined(__APPLE__)
+#define SDL_PHYSFS_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Memory mapping for SDL_PhysFS_MapFile()
+#if !defined(SDL_PHYSFS_NO_MMAP) && defined(SDL_PHYSFS_POSIX)
+#define SDL_PHYSFS_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifndef SDL_PHYSFS_DIRECTORY_BUFFER_SIZE
+/**
+ * The default read buffer size for files opened from a directory mounted with SDL_PhysFS_Mount().
+ */
+#define SDL_PHYSFS_DIRECTORY_BUFFER_SIZE 4096
+#endif
+
+#ifndef SDL_PHYSFS_ARCHIVE_BUFFER_SIZE
+/**
+ * The default read buffer size for files opened from a mounted archive.
+ */
+#define SDL_PHYSFS_ARCHIVE_BUFFER_SIZE 16384
+#endif
+
+#ifndef SDL_PHYSFS_AUDIO_BUFFER_SIZE
+/**
+ * The most audio data SDL_PhysFS_OpenAudioStream() reads from a file at a time.
+ */
+#define SDL_PHYSFS_AUDIO_BUFFER_SIZE 16384
+#endif
+
+#ifndef SDL_PHYSFS_SEEK_SKIP_LIMIT
+/**
+ * The furthest forward seek on a file opened for reading that is done by reading ahead, rather than seeking.
+ */
+#define SDL_PHYSFS_SEEK_SKIP_LIMIT 4096
+#endif
+
+#ifndef SDL_PHYSFS_OVERLAY_BLOCK_SIZE
+/**
+ * The size of the blocks SDL_PhysFS_OpenOverlayIO() copies from the original file, the first time each is written to.
+ */
+#define SDL_PHYSFS_OVERLAY_BLOCK_SIZE 65536
+#endif
+
+#ifndef SDL_PHYSFS_MOUNT_INDEX_EXTENSION
+/**
+ * Appended to an archive's path to find the mount index that SDL_PhysFS_Mount() looks for beside it.
+ */
+#define SDL_PHYSFS_MOUNT_INDEX_EXTENSION ".sdlidx"
+#endif
+
+#ifndef SDL_PHYSFS_PATH_CACHE_MAX_MISSING
+/**
+ * The most missing paths the path cache remembers. Lookups of others still walk the search path.
+ */
+#define SDL_PHYSFS_PATH_CACHE_MAX_MISSING 4096
+#endif
+
+#ifndef SDL_PHYSFS_PREFETCH_THREADS
+/**
+ * The number of background threads used by SDL_PhysFS_Prefetch().
+ */
+#define SDL_PHYSFS_PREFETCH_THREADS 2
+#endif
+
+#ifndef SDL_PHYSFS_DECODE_THREADS
+/**
+ * The most threads SDL_PhysFS_LoadSurfacesFormat() decodes on, including the calling thread.
+ */
+#define SDL_PHYSFS_DECODE_THREADS 4
+#endif
+
+#ifndef SDL_PHYSFS_WALK_THREADS
+/**
+ * The most threads SDL_PhysFS_Walk() walks on with SDL_PHYSFS_WALK_PARALLEL, including the calling thread.
+ */
+#define SDL_PHYSFS_WALK_THREADS 4
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * Set on threads running SDL_PhysFS_TryOpen() or SDL_PhysFS_TryLoadFile(), which leave SDL's error alone.
+ *
+ * @internal
+ */
+static SDL_TLSID SDL_PhysFS_quietErrors;
+
+/**
+ * The number of quiet probes running on any thread. SDL_PhysFS_quietErrors is only looked up while there are some.
+ *
+ * @internal
+ */
+static SDL_AtomicInt SDL_PhysFS_quietProbes = { 0 };
+
 #ifndef SDL_PhysFS_SetError
 /**
  * Reports the latest PhysFS error to SDL.
  *
+ * The message is formatted straight away. Only quiet probes skip it, leaving
+ * the PhysFS error code for the probe to return. The thread's probe flag is
+ * only looked up while a probe is running somewhere, so other failures pay
+ * nothing extra.
+ *
  * @param description A description of the error that occurred.
  */
-#define SDL_PhysFS_SetError(description) do { SDL_SetError("SDL_PhysFS.h:%d: %s (%s)", __LINE__, description, PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode())); } while(0)
+#define SDL_PhysFS_SetError(description) do { if (SDL_GetAtomicInt(&SDL_PhysFS_quietProbes) == 0 || SDL_GetTLS(&SDL_PhysFS_quietErrors) == NULL) { SDL_SetError("SDL_PhysFS.h:%d: %s (%s)", __LINE__, description, PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode())); } } while(0)
 #endif
 
+static SDL_malloc_func SDL_PhysFS_malloc = NULL;
+static SDL_realloc_func SDL_PhysFS_realloc = NULL;
+static SDL_free_func SDL_PhysFS_free = NULL;
+
+#ifdef SDL_PHYSFS_POOL_ALLOCATOR
 /**
- * PhysFS Allocator Callback to malloc().
+ * Allocations are prefixed with a header holding their size class, keeping the payload aligned.
  *
  * @internal
  */
-static void* SDL_PhysFS_AllocatorMalloc(PHYSFS_uint64 size) {
-    SDL_malloc_func malloc_func;
-    SDL_GetMemoryFunctions(&malloc_func, NULL, NULL, NULL);
-    return malloc_func((size_t)size);
-}
+#define SDL_PHYSFS_POOL_HEADER_SIZE 16
+#define SDL_PHYSFS_POOL_CLASSES 5
+#define SDL_PHYSFS_POOL_CHUNK_BLOCKS 64
 
 /**
- * PhysFS Allocator Callback to realloc().
+ * A pool of same-sized blocks, for PhysFS's many small allocations such as file handles and directory entries.
  *
  * @internal
  */
-static void* SDL_PhysFS_AllocatorRealloc(void* mem, PHYSFS_uint64 size) {
-    SDL_realloc_func realloc_func;
-    SDL_GetMemoryFunctions(NULL, NULL, &realloc_func, NULL);
-    return realloc_func(mem, (size_t)size);
-}
+typedef struct SDL_PhysFS_Pool {
+    SDL_SpinLock lock;
+    void* free;
+} SDL_PhysFS_Pool;
+
+static SDL_PhysFS_Pool SDL_PhysFS_pools[SDL_PHYSFS_POOL_CLASSES];
+static void* SDL_PhysFS_poolChunks = NULL;
+static SDL_SpinLock SDL_PhysFS_poolChunksLock = 0;
 
 /**
- * PhysFS Allocator Callback to free().
+ * The payload size of blocks in the given size class: 32, 64, 128, 256 or 512 bytes.
  *
  * @internal
  */
-static void SDL_PhysFS_AllocatorFree(void* mem) {
-    SDL_free_func free_func;
-    SDL_GetMemoryFunctions(NULL, NULL, NULL, &free_func);
-    return free_func(mem);
+static size_t SDL_PhysFS_PoolClassSize(size_t sizeClass) {
+    return (size_t)32 << sizeClass;
 }
 
 /**
- * Get the version of SDL_PhysFS that is linked against your program.
+ * Finds the smallest size class that fits the given size, or SDL_PHYSFS_POOL_CLASSES if it's too large to pool.
  *
- * @return Returns the version of the linked library.
+ * @internal
  */
-int SDL_PhysFS_GetVersion(void) {
-    return SDL_PHYSFS_VERSION;
+static size_t SDL_PhysFS_PoolClass(PHYSFS_uint64 size) {
+    size_t sizeClass = 0;
+    while (sizeClass < SDL_PHYSFS_POOL_CLASSES && size > SDL_PhysFS_PoolClassSize(sizeClass)) {
+        sizeClass++;
+    }
+    return sizeClass;
 }
 
 /**
- * Initialize the PhysFS virtual file system.
- *
- * @return true on success, false otherwise.
+ * Allocates a chunk of blocks for the given size class, and adds them to its free list. The pool must be locked.
  *
- * @see SDL_PhysFS_Quit()
+ * @internal
  */
-bool SDL_PhysFS_Init(const char* argv) {
-    // Set up the memory functions.
-    PHYSFS_Allocator allocator;
-    allocator.Init = NULL;
-    allocator.Deinit = NULL;
-    allocator.Malloc = &SDL_PhysFS_AllocatorMalloc;
-    allocator.Realloc = &SDL_PhysFS_AllocatorRealloc;
-    allocator.Free = &SDL_PhysFS_AllocatorFree;
-    PHYSFS_setAllocator(&allocator);
-
-    if (PHYSFS_init(argv) == 0) {
-        SDL_PhysFS_SetError("Failed to initialize PhysFS");
+static bool SDL_PhysFS_PoolRefill(size_t sizeClass) {
+    size_t blockSize = SDL_PHYSFS_POOL_HEADER_SIZE + SDL_PhysFS_PoolClassSize(sizeClass);
+    Uint8* chunk = (Uint8*)SDL_PhysFS_malloc(SDL_PHYSFS_POOL_HEADER_SIZE + blockSize * SDL_PHYSFS_POOL_CHUNK_BLOCKS);
+    if (chunk == NULL) {
         return false;
     }
 
+    // Chunks are kept in a list of their own, to be released by SDL_PhysFS_Quit().
+    SDL_LockSpinlock(&SDL_PhysFS_poolChunksLock);
+    *(void**)chunk = SDL_PhysFS_poolChunks;
+    SDL_PhysFS_poolChunks = chunk;
+    SDL_UnlockSpinlock(&SDL_PhysFS_poolChunksLock);
+
+    for (size_t i = 0; i < SDL_PHYSFS_POOL_CHUNK_BLOCKS; i++) {
+        Uint8* block = chunk + SDL_PHYSFS_POOL_HEADER_SIZE + blockSize * i;
+        void** payload = (void**)(block + SDL_PHYSFS_POOL_HEADER_SIZE);
+        *(size_t*)block = sizeClass;
+        *payload = SDL_PhysFS_pools[sizeClass].free;
+        SDL_PhysFS_pools[sizeClass].free = payload;
+    }
+
     return true;
 }
 
 /**
- * Initializes the PhysFS virtual file system with access to SDL's preferences directory.
- *
- * Mounts the writable preferences directory as "/pref".
+ * PhysFS Allocator Callback to release the pools.
  *
- * @param org The name of your organization.
- * @param app The name of your application.
+ * @internal
+ */
+static void SDL_PhysFS_PoolDeinit(void) {
+    while (SDL_PhysFS_poolChunks != NULL) {
+        void* next = *(void**)SDL_PhysFS_poolChunks;
+        SDL_PhysFS_free(SDL_PhysFS_poolChunks);
+        SDL_PhysFS_poolChunks = next;
+    }
+
+    for (size_t i = 0; i < SDL_PHYSFS_POOL_CLASSES; i++) {
+        SDL_PhysFS_pools[i].free = NULL;
+    }
+}
+#endif
+
+/**
+ * Snapshots SDL's memory functions for the PhysFS allocator, so they aren't looked up on every allocation.
  *
- * @return true on success, false otherwise.
+ * Only call this while PhysFS holds no memory from the previous functions, such as before SDL_PhysFS_Init().
  *
  * @see SDL_PhysFS_Init()
  */
-bool SDL_PhysFS_InitEx(const char* argv, const char* org, const char* app) {
-    // Find the preferences path.
-    char* path = SDL_GetPrefPath(org, app);
-    if (path == NULL) {
-        SDL_PhysFS_SetError("Failed to find SDL's pref directory");
-        return false;
-    }
+void SDL_PhysFS_RefreshMemoryFunctions(void) {
+    SDL_GetMemoryFunctions(&SDL_PhysFS_malloc, NULL, &SDL_PhysFS_realloc, &SDL_PhysFS_free);
+}
 
-    // Initialize
-    if (SDL_PhysFS_Init(argv) == false) {
-        SDL_free(path);
-        return false;
+/**
+ * PhysFS Allocator Callback to malloc().
+ *
+ * @internal
+ */
+static void* SDL_PhysFS_AllocatorMalloc(PHYSFS_uint64 size) {
+#ifdef SDL_PHYSFS_POOL_ALLOCATOR
+    size_t sizeClass = SDL_PhysFS_PoolClass(size);
+    if (sizeClass < SDL_PHYSFS_POOL_CLASSES) {
+        SDL_PhysFS_Pool* pool = &SDL_PhysFS_pools[sizeClass];
+        SDL_LockSpinlock(&pool->lock);
+        if (pool->free == NULL && !SDL_PhysFS_PoolRefill(sizeClass)) {
+            SDL_UnlockSpinlock(&pool->lock);
+            return NULL;
+        }
+        void* payload = pool->free;
+        pool->free = *(void**)payload;
+        SDL_UnlockSpinlock(&pool->lock);
+        return payload;
     }
 
-    // Set up the write directory as /app
-    if (!SDL_PhysFS_SetWriteDir(path) || !SDL_PhysFS_Mount(path, "pref")) {
-        SDL_free(path);
-        SDL_PhysFS_Quit();
-        return false;
+    Uint8* block = (Uint8*)SDL_PhysFS_malloc((size_t)size + SDL_PHYSFS_POOL_HEADER_SIZE);
+    if (block == NULL) {
+        return NULL;
     }
-    SDL_free(path);
-
-    return true;
+    *(size_t*)block = SDL_PHYSFS_POOL_CLASSES;
+    return block + SDL_PHYSFS_POOL_HEADER_SIZE;
+#else
+    return SDL_PhysFS_malloc((size_t)size);
+#endif
 }
 
 /**
- * Close the PhysFS virtual file system.
+ * PhysFS Allocator Callback to free().
  *
- * @return true on success, false otherwise.
+ * @internal
  */
-bool SDL_PhysFS_Quit() {
-    if (PHYSFS_deinit() == 0) {
-        SDL_PhysFS_SetError("Failed to deinitialize PhysFS");
-        return false;
+static void SDL_PhysFS_AllocatorFree(void* mem) {
+#ifdef SDL_PHYSFS_POOL_ALLOCATOR
+    if (mem == NULL) {
+        return;
     }
 
-    // Remove the SDL allocator.
-    PHYSFS_setAllocator(NULL);
-
-    return true;
-}
-
-SDL_IOStatus SDL_PhysFS_IOStatus(int error) {
-    switch ((PHYSFS_ErrorCode)error) {
-        case PHYSFS_ERR_OK: return SDL_IO_STATUS_READY;
-        case PHYSFS_ERR_OTHER_ERROR: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_OUT_OF_MEMORY: return SDL_IO_STATUS_NOT_READY;
-        case PHYSFS_ERR_NOT_INITIALIZED: return SDL_IO_STATUS_NOT_READY;
-        case PHYSFS_ERR_IS_INITIALIZED: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_ARGV0_IS_NULL: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_UNSUPPORTED: return SDL_IO_STATUS_NOT_READY;
-        case PHYSFS_ERR_PAST_EOF: return SDL_IO_STATUS_EOF;
-        case PHYSFS_ERR_FILES_STILL_OPEN: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_INVALID_ARGUMENT: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_NOT_MOUNTED: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_NOT_FOUND: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_SYMLINK_FORBIDDEN: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_NO_WRITE_DIR: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_OPEN_FOR_READING: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_OPEN_FOR_WRITING: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_NOT_A_FILE: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_READ_ONLY: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_CORRUPT: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_SYMLINK_LOOP: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_IO: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_PERMISSION: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_NO_SPACE: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_BAD_FILENAME: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_BUSY: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_DIR_NOT_EMPTY: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_OS_ERROR: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_DUPLICATE: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_BAD_PASSWORD: return SDL_IO_STATUS_ERROR;
-        case PHYSFS_ERR_APP_CALLBACK: return SDL_IO_STATUS_ERROR;
+    Uint8* block = (Uint8*)mem - SDL_PHYSFS_POOL_HEADER_SIZE;
+    size_t sizeClass = *(size_t*)block;
+    if (sizeClass == SDL_PHYSFS_POOL_CLASSES) {
+        SDL_PhysFS_free(block);
+        return;
     }
 
-    return SDL_IO_STATUS_READY;
+    SDL_PhysFS_Pool* pool = &SDL_PhysFS_pools[sizeClass];
+    SDL_LockSpinlock(&pool->lock);
+    *(void**)mem = pool->free;
+    pool->free = mem;
+    SDL_UnlockSpinlock(&pool->lock);
+#else
+    SDL_PhysFS_free(mem);
+#endif
 }
 
 /**
- * Mounts the given directory, at the given mount point.
- *
- * @param newDir Directory or archive to add to the path, in platform-dependent notation.
- * @param mountPoint Location in the interpolated tree that this archive will be "mounted", in platform-independent notation. NULL or "" is equivalent to "/".
- *
- * @return true on success, false otherwise.
+ * PhysFS Allocator Callback to realloc().
  *
- * @see SDL_PhysFS_Unmount()
+ * @internal
  */
-bool SDL_PhysFS_Mount(const char* newDir, const char* mountPoint) {
-    if (PHYSFS_mount(newDir, mountPoint, 1) == 0) {
-        SDL_PhysFS_SetError("Failed to mount");
-        return false;
+static void* SDL_PhysFS_AllocatorRealloc(void* mem, PHYSFS_uint64 size) {
+#ifdef SDL_PHYSFS_POOL_ALLOCATOR
+    if (mem == NULL) {
+        return SDL_PhysFS_AllocatorMalloc(size);
     }
 
-    return true;
+    Uint8* block = (Uint8*)mem - SDL_PHYSFS_POOL_HEADER_SIZE;
+    size_t sizeClass = *(size_t*)block;
+    if (sizeClass == SDL_PHYSFS_POOL_CLASSES && SDL_PhysFS_PoolClass(size) == SDL_PHYSFS_POOL_CLASSES) {
+        block = (Uint8*)SDL_PhysFS_realloc(block, (size_t)size + SDL_PHYSFS_POOL_HEADER_SIZE);
+        return block != NULL ? block + SDL_PHYSFS_POOL_HEADER_SIZE : NULL;
+    }
+    if (sizeClass < SDL_PHYSFS_POOL_CLASSES && size <= SDL_PhysFS_PoolClassSize(sizeClass)) {
+        return mem;
+    }
+
+    // Moving between pooled and unpooled sizes needs a copy.
+    void* result = SDL_PhysFS_AllocatorMalloc(size);
+    if (result != NULL) {
+        size_t oldSize = sizeClass < SDL_PHYSFS_POOL_CLASSES ? SDL_PhysFS_PoolClassSize(sizeClass) : (size_t)size;
+        SDL_memcpy(result, mem, SDL_min(oldSize, (size_t)size));
+        SDL_PhysFS_AllocatorFree(mem);
+    }
+    return result;
+#else
+    return SDL_PhysFS_realloc(mem, (size_t)size);
+#endif
 }
 
 /**
- * Mounts the given file data as a mount point in PhysFS.
+ * An entry in an SDL_PhysFS_HashTable, keyed by a string stored alongside it.
  *
- * @param fileData The archive data as a file buffer.
- * @param dataSize The size of the file buffer.
- * @param newDir Filename that can represent this stream.
- * @param mountPoint The location in the tree that the archive will be mounted.
+ * @internal
+ */
+typedef struct SDL_PhysFS_HashEntry {
+    char* key;
+    Uint32 hash;
+    const void* value;
+    struct SDL_PhysFS_HashEntry* next;
+} SDL_PhysFS_HashEntry;
+
+/**
+ * A string-keyed hash table with chained buckets. It does no locking of its own.
  *
- * @return true on success, false otherwise.
+ * @internal
+ */
+typedef struct SDL_PhysFS_HashTable {
+    SDL_PhysFS_HashEntry** buckets;
+    Uint32 numBuckets;
+    Uint32 count;
+} SDL_PhysFS_HashTable;
+
+/**
+ * Finds the entry with the given key and hash, or NULL if there isn't one.
  *
- * @see SDL_PhysFS_Mount()
+ * @internal
  */
-bool SDL_PhysFS_MountFromMemory(const unsigned char *fileData, size_t dataSize, const char* newDir, const char* mountPoint) {
-    if (dataSize == 0) {
-        SDL_SetError("SDL_PhysFS_MountFromMemory: Cannot mount a data size of 0");
-        return false;
+static SDL_PhysFS_HashEntry* SDL_PhysFS_HashFind(SDL_PhysFS_HashTable* table, const char* key, Uint32 hash) {
+    if (table->numBuckets == 0) {
+        return NULL;
     }
 
-    if (PHYSFS_mountMemory(fileData, (PHYSFS_uint64)dataSize, 0, newDir, mountPoint, 1) == 0) {
-        SDL_PhysFS_SetError("Failed to mount internal memory");
-        return false;
+    for (SDL_PhysFS_HashEntry* entry = table->buckets[hash % table->numBuckets]; entry != NULL; entry = entry->next) {
+        if (entry->hash == hash && SDL_strcmp(entry->key, key) == 0) {
+            return entry;
+        }
     }
 
-    return true;
+    return NULL;
 }
 
 /**
- * Mounts the given IOStream as a mount point in PhysFS.
- *
- * @param src The IOStream to mount.
- * @param newDir Filename that can represent this stream.
- * @param mountPoint The location in the tree that the archive will be mounted.
- * @param closeio if true, calls SDL_CloseIO() on src before returning, even in the case of an error.
+ * Adds a new entry with a copy of the given key, growing the table to keep chains short.
  *
- * @return true on success, false otherwise.
+ * @return The new entry, or NULL if out of memory.
  *
- * @see SDL_PhysFS_Mount()
+ * @internal
  */
-SDL_PHYSFS_DEF bool SDL_PhysFS_MountFromIO(SDL_IOStream* src, const char* newDir, const char* mountPoint, bool closeio) {
-    if (src == NULL || newDir == NULL) {
-        return SDL_InvalidParamError("src or newDir");
+static SDL_PhysFS_HashEntry* SDL_PhysFS_HashInsert(SDL_PhysFS_HashTable* table, const char* key, Uint32 hash, const void* value) {
+    if (table->count >= table->numBuckets) {
+        Uint32 numBuckets = table->numBuckets > 0 ? table->numBuckets * 2 : 256;
+        SDL_PhysFS_HashEntry** buckets = (SDL_PhysFS_HashEntry**)SDL_calloc(numBuckets, sizeof(SDL_PhysFS_HashEntry*));
+        if (buckets == NULL && table->numBuckets == 0) {
+            return NULL;
+        }
+        if (buckets != NULL) {
+            for (Uint32 i = 0; i < table->numBuckets; i++) {
+                SDL_PhysFS_HashEntry* entry = table->buckets[i];
+                while (entry != NULL) {
+                    SDL_PhysFS_HashEntry* next = entry->next;
+                    entry->next = buckets[entry->hash % numBuckets];
+                    buckets[entry->hash % numBuckets] = entry;
+                    entry = next;
+                }
+            }
+            SDL_free(table->buckets);
+            table->buckets = buckets;
+            table->numBuckets = numBuckets;
+        }
     }
 
-    size_t dataSize = 0;
-    void* fileData = SDL_LoadFile_IO(src, &dataSize, closeio);
-    if (fileData == NULL) {
-        return false;
+    // The key and entry share an allocation.
+    size_t length = SDL_strlen(key);
+    SDL_PhysFS_HashEntry* entry = (SDL_PhysFS_HashEntry*)SDL_malloc(sizeof(SDL_PhysFS_HashEntry) + length + 1);
+    if (entry == NULL) {
+        return NULL;
     }
+    entry->key = (char*)(entry + 1);
+    SDL_memcpy(entry->key, key, length + 1);
+    entry->hash = hash;
+    entry->value = value;
 
-    return SDL_PhysFS_MountFromMemory(fileData, dataSize, newDir, mountPoint);
+    Uint32 bucket = hash % table->numBuckets;
+    entry->next = table->buckets[bucket];
+    table->buckets[bucket] = entry;
+    table->count++;
+    return entry;
 }
 
 /**
- * Unmounts the given directory or archive.
+ * Removes and frees the entry with the given key and hash, if there is one.
  *
- * @param oldDir The directory that was supplied to MountPhysFS's newDir.
- *
- * @return true on success, false otherwise.
- *
- * @see SDL_PhysFS_Mount()
+ * @internal
  */
-bool SDL_PhysFS_Unmount(const char* oldDir) {
-    if (PHYSFS_unmount(oldDir) == 0) {
-        SDL_PhysFS_SetError("Failed to unmount old directory");
-        return false;
+static void SDL_PhysFS_HashRemove(SDL_PhysFS_HashTable* table, const char* key, Uint32 hash) {
+    if (table->numBuckets == 0) {
+        return;
     }
 
-    return true;
+    for (SDL_PhysFS_HashEntry** it = &table->buckets[hash % table->numBuckets]; *it != NULL; it = &(*it)->next) {
+        SDL_PhysFS_HashEntry* entry = *it;
+        if (entry->hash == hash && SDL_strcmp(entry->key, key) == 0) {
+            *it = entry->next;
+            SDL_free(entry);
+            table->count--;
+            return;
+        }
+    }
 }
 
 /**
- * SDL_IOStream callback: size.
+ * Removes and frees every entry in the table.
  *
  * @internal
  */
-Sint64 SDLCALL SDL_PhysFS_GetIOSize(void *userdata) {
-    PHYSFS_File *handle = (PHYSFS_File *)userdata;
-    if (handle == NULL) {
-        return 0;
+static void SDL_PhysFS_HashClear(SDL_PhysFS_HashTable* table) {
+    for (Uint32 i = 0; i < table->numBuckets; i++) {
+        SDL_PhysFS_HashEntry* entry = table->buckets[i];
+        while (entry != NULL) {
+            SDL_PhysFS_HashEntry* next = entry->next;
+            SDL_free(entry);
+            entry = next;
+        }
     }
 
-    return (Sint64) PHYSFS_fileLength(handle);
+    SDL_free(table->buckets);
+    table->buckets = NULL;
+    table->numBuckets = 0;
+    table->count = 0;
 }
 
 /**
- * SDL_IOStream callback: seek.
+ * Hashes a string key for an SDL_PhysFS_HashTable.
  *
  * @internal
  */
-Sint64 SDLCALL SDL_PhysFS_SeekIO(void *userdata, Sint64 offset, SDL_IOWhence whence) {
-    PHYSFS_File *handle = (PHYSFS_File *)userdata;
-    PHYSFS_sint64 pos = 0;
+static Uint32 SDL_PhysFS_Hash(const char* key) {
+    return SDL_murmur3_32(key, SDL_strlen(key), 0);
+}
 
-    if (whence == SDL_IO_SEEK_SET) {
-        pos = (PHYSFS_sint64) offset;
+#ifdef SDL_PHYSFS_STATS
+/**
+ * The counters for each file and mount, keyed by name, and the installed trace callback.
+ *
+ * Counters are only freed on SDL_PhysFS_Quit(), so open streams can keep pointers to them.
+ *
+ * @internal
+ */
+static struct {
+    SDL_SpinLock lock;
+    SDL_PhysFS_HashTable files;
+    SDL_PhysFS_HashTable mounts;
+    SDL_PhysFS_Counters total;
+    SDL_PhysFS_TraceCallback trace;
+    void* traceUserdata;
+} SDL_PhysFS_stats = { 0, { NULL, 0, 0 }, { NULL, 0, 0 }, { 0, 0, 0, 0, 0, 0, 0, 0 }, NULL, NULL };
+
+/**
+ * Finds, or adds, the counters with the given name. The stats lock must be held.
+ *
+ * @internal
+ */
+static SDL_PhysFS_Counters* SDL_PhysFS_StatsFind(SDL_PhysFS_HashTable* table, const char* name) {
+    if (name == NULL) {
+        return NULL;
     }
-    else if (whence == SDL_IO_SEEK_CUR) {
-        const PHYSFS_sint64 current = PHYSFS_tell(handle);
-        if (current == -1) {
-            SDL_PhysFS_SetError("Cannot find position in file");
-            return -1;
-        }
 
-        if (offset == 0) {
-            return (Sint64) current;
+    Uint32 hash = SDL_PhysFS_Hash(name);
+    SDL_PhysFS_HashEntry* entry = SDL_PhysFS_HashFind(table, name, hash);
+    if (entry == NULL) {
+        SDL_PhysFS_Counters* counters = (SDL_PhysFS_Counters*)SDL_calloc(1, sizeof(SDL_PhysFS_Counters));
+        if (counters == NULL) {
+            return NULL;
         }
-
-        pos = current + ((PHYSFS_sint64) offset);
-    }
-    else if (whence == SDL_IO_SEEK_END) {
-        const PHYSFS_sint64 len = PHYSFS_fileLength(handle);
-        if (len == -1) {
-            SDL_PhysFS_SetError("Cannot find end of file");
-            return -1;
+        entry = SDL_PhysFS_HashInsert(table, name, hash, counters);
+        if (entry == NULL) {
+            SDL_free(counters);
+            return NULL;
         }
-
-        pos = len + ((PHYSFS_sint64) offset);
-    }
-    else {
-        SDL_PhysFS_SetError("Invalid 'whence' parameter");
-        return -1;
-    }
-
-    if (pos < 0) {
-        SDL_PhysFS_SetError("Attempt to seek past start of file");
-        return -1;
-    }
-
-    if (!PHYSFS_seek(handle, (PHYSFS_uint64)pos)) {
-        SDL_PhysFS_SetError("Failed to seek in file");
-        return -1;
     }
 
-    return (Sint64) pos;
+    return (SDL_PhysFS_Counters*)entry->value;
 }
 
 /**
- * SDL_IOStream callback: read.
+ * Finds the counters for a file and the mount that provides it.
  *
  * @internal
  */
-size_t SDLCALL SDL_PhysFS_ReadIO(void *userdata, void *ptr, size_t size, SDL_IOStatus *status) {
-    PHYSFS_File *handle = (PHYSFS_File *)userdata;
-    PHYSFS_sint64 rc = PHYSFS_readBytes(handle, ptr, (PHYSFS_uint64)size);
-    if (rc <= 0) {
-        *status = SDL_PhysFS_IOStatus(PHYSFS_getLastErrorCode());
-        rc = 0;
-    }
-
-    return (size_t)rc;
+static void SDL_PhysFS_StatsLookup(const char* filename, const char* realDir, SDL_PhysFS_Counters** file, SDL_PhysFS_Counters** mount) {
+    SDL_LockSpinlock(&SDL_PhysFS_stats.lock);
+    *file = SDL_PhysFS_StatsFind(&SDL_PhysFS_stats.files, filename);
+    *mount = SDL_PhysFS_StatsFind(&SDL_PhysFS_stats.mounts, realDir);
+    SDL_UnlockSpinlock(&SDL_PhysFS_stats.lock);
 }
 
 /**
- * SDL_IOStream callback: write.
+ * Counts a path cache hit or miss.
  *
  * @internal
  */
-size_t SDLCALL SDL_PhysFS_WriteIO(void *userdata, const void *ptr, size_t size, SDL_IOStatus *status) {
-    PHYSFS_File *handle = (PHYSFS_File *)userdata;
-    PHYSFS_sint64 wc;
-
-    if (handle == NULL) {
-        return 0;
+static void SDL_PhysFS_StatsCacheLookup(const char* filename, const char* realDir, bool hit) {
+    SDL_LockSpinlock(&SDL_PhysFS_stats.lock);
+    SDL_PhysFS_Counters* targets[3] = {
+        &SDL_PhysFS_stats.total,
+        SDL_PhysFS_StatsFind(&SDL_PhysFS_stats.files, filename),
+        SDL_PhysFS_StatsFind(&SDL_PhysFS_stats.mounts, realDir)
+    };
+    for (int i = 0; i < 3; i++) {
+        if (targets[i] != NULL) {
+            if (hit) {
+                targets[i]->cacheHits++;
+            }
+            else {
+                targets[i]->cacheMisses++;
+            }
+        }
     }
+    SDL_UnlockSpinlock(&SDL_PhysFS_stats.lock);
+}
 
-    wc = PHYSFS_writeBytes(handle, ptr, (PHYSFS_uint64)size);
-    if (wc < 0) {
-        SDL_PhysFS_SetError("Failed to write file");
-        if (status) {
-            *status = SDL_PhysFS_IOStatus(PHYSFS_getLastErrorCode());
+/**
+ * Counts a load answered by the content cache.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_StatsContentCacheHit(const char* filename, const char* realDir) {
+    SDL_LockSpinlock(&SDL_PhysFS_stats.lock);
+    SDL_PhysFS_Counters* targets[3] = {
+        &SDL_PhysFS_stats.total,
+        SDL_PhysFS_StatsFind(&SDL_PhysFS_stats.files, filename),
+        SDL_PhysFS_StatsFind(&SDL_PhysFS_stats.mounts, realDir)
+    };
+    for (int i = 0; i < 3; i++) {
+        if (targets[i] != NULL) {
+            targets[i]->contentCacheHits++;
         }
-        wc = 0;
     }
-
-    return (size_t)wc;
+    SDL_UnlockSpinlock(&SDL_PhysFS_stats.lock);
 }
 
 /**
- * SDL_IOStream callback: flush.
+ * Counts an operation that started at the given time, and reports it to the trace callback.
  *
  * @internal
  */
-bool SDLCALL SDL_PhysFS_FlushIO(void *userdata, SDL_IOStatus *status) {
-    PHYSFS_File* handle = (PHYSFS_File *)userdata;
-    if (handle == NULL) {
-        return false;
-    }
+static void SDL_PhysFS_StatsRecord(SDL_PhysFS_Counters* file, SDL_PhysFS_Counters* mount, SDL_PhysFS_TraceEvent event, const char* filename, Uint64 start, Sint64 bytes) {
+    Uint64 duration = SDL_GetTicksNS() - start;
 
-    if (PHYSFS_flush(handle) != 0) {
-        return true;
+    SDL_LockSpinlock(&SDL_PhysFS_stats.lock);
+    SDL_PhysFS_Counters* targets[3] = { &SDL_PhysFS_stats.total, file, mount };
+    for (int i = 0; i < 3; i++) {
+        if (targets[i] == NULL) {
+            continue;
+        }
+        switch (event) {
+            case SDL_PHYSFS_TRACE_OPEN: targets[i]->opens++; break;
+            case SDL_PHYSFS_TRACE_READ:
+                targets[i]->reads++;
+                targets[i]->bytesRead += bytes > 0 ? (Uint64)bytes : 0;
+                break;
+            case SDL_PHYSFS_TRACE_SEEK: targets[i]->seeks++; break;
+            case SDL_PHYSFS_TRACE_CLOSE: break;
+        }
+        targets[i]->timeNS += duration;
     }
+    SDL_PhysFS_TraceCallback trace = SDL_PhysFS_stats.trace;
+    void* traceUserdata = SDL_PhysFS_stats.traceUserdata;
+    SDL_UnlockSpinlock(&SDL_PhysFS_stats.lock);
 
-    if (status != NULL) {
-        *status = SDL_PhysFS_IOStatus(PHYSFS_getLastErrorCode());
+    if (trace != NULL) {
+        trace(traceUserdata, event, filename, start, duration, bytes);
     }
-
-    return false;
 }
 
 /**
- * SDL_IOStream callback: close.
+ * Frees the counters in a table, and the table's entries.
  *
  * @internal
  */
-bool SDLCALL SDL_PhysFS_CloseIO(void *userdata) {
-    PHYSFS_File *handle = (PHYSFS_File *)userdata;
-
-    if (handle != NULL) {
-        if (!PHYSFS_close(handle)) {
-            SDL_PhysFS_SetError("Failed to close file");
-            return false;
+static void SDL_PhysFS_StatsClearTable(SDL_PhysFS_HashTable* table) {
+    for (Uint32 i = 0; i < table->numBuckets; i++) {
+        for (SDL_PhysFS_HashEntry* entry = table->buckets[i]; entry != NULL; entry = entry->next) {
+            SDL_free((void*)entry->value);
         }
-
-        return true;
     }
-
-    return false;
+    SDL_PhysFS_HashClear(table);
 }
 
 /**
- * Creates a SDL_IOStream based on the given PHYSFS_File.
+ * Copies a table's counters and names into a stats snapshot.
+ *
+ * @internal
  */
-SDL_IOStream *SDL_PhysFS_OpenIO(PHYSFS_File *handle) {
-    if (handle == NULL) {
-        SDL_InvalidParamError("handle");
-        return NULL;
+static void SDL_PhysFS_StatsCopyTable(const SDL_PhysFS_HashTable* table, SDL_PhysFS_StatsEntry* entries, char** strings) {
+    for (Uint32 i = 0; i < table->numBuckets; i++) {
+        for (SDL_PhysFS_HashEntry* entry = table->buckets[i]; entry != NULL; entry = entry->next) {
+            size_t length = SDL_strlen(entry->key) + 1;
+            SDL_memcpy(*strings, entry->key, length);
+            entries->name = *strings;
+            entries->counters = *(const SDL_PhysFS_Counters*)entry->value;
+            entries++;
+            *strings += length;
+        }
     }
+}
 
-    SDL_IOStreamInterface iface;
-    SDL_INIT_INTERFACE(&iface);
-    iface.size = SDL_PhysFS_GetIOSize;
-    iface.seek  = SDL_PhysFS_SeekIO;
-    iface.read  = SDL_PhysFS_ReadIO;
-    iface.write = SDL_PhysFS_WriteIO;
-    iface.flush = SDL_PhysFS_FlushIO;
-    iface.close = SDL_PhysFS_CloseIO;
-    return SDL_OpenIO(&iface, (void*)handle);
+/**
+ * Orders stats entries by the most time spent.
+ *
+ * @internal
+ */
+static int SDLCALL SDL_PhysFS_CompareStatsEntries(const void* a, const void* b) {
+    Uint64 left = ((const SDL_PhysFS_StatsEntry*)a)->counters.timeNS;
+    Uint64 right = ((const SDL_PhysFS_StatsEntry*)b)->counters.timeNS;
+    return (left < right) - (left > right);
 }
+#endif
 
 /**
- * Loads a SDL_IOStream from the given filename in PhysFS.
+ * Takes a snapshot of the I/O counters for each file and mount.
  *
- * @param filename The filename to load from PhysFS.
+ * Counters are only kept when SDL_PHYSFS_STATS is defined before including
+ * the implementation. Otherwise, all of the instrumentation is compiled out.
  *
- * @return The resulting SDL_IOStream*, which must be freed with SDL_CloseIO() afterwards. NULL on failure, use SDL_GetError() to see details.
+ * Reads and seeks are counted for streams from SDL_PhysFS_IOFromFile(), and
+ * the functions built on it, and for SDL_PhysFS_LoadFile().
+ *
+ * @return The snapshot, which must be freed with SDL_free(), or NULL on failure. Use SDL_GetError() for details.
+ *
+ * @see SDL_PhysFS_ResetStats()
+ * @see SDL_PhysFS_SetTraceCallback()
  */
-SDL_IOStream* SDL_PhysFS_IOFromFile(const char* filename) {
-    PHYSFS_File* handle = PHYSFS_openRead(filename);
-    if (handle == NULL) {
-        SDL_PhysFS_SetError("Failed to open file for reading");
-        return NULL;
+SDL_PhysFS_Stats* SDL_PhysFS_GetStats(void) {
+#ifdef SDL_PHYSFS_STATS
+    SDL_LockSpinlock(&SDL_PhysFS_stats.lock);
+    size_t count = (size_t)SDL_PhysFS_stats.files.count + SDL_PhysFS_stats.mounts.count;
+    size_t size = sizeof(SDL_PhysFS_Stats) + count * sizeof(SDL_PhysFS_StatsEntry);
+    const SDL_PhysFS_HashTable* tables[2] = { &SDL_PhysFS_stats.files, &SDL_PhysFS_stats.mounts };
+    for (int t = 0; t < 2; t++) {
+        for (Uint32 i = 0; i < tables[t]->numBuckets; i++) {
+            for (SDL_PhysFS_HashEntry* entry = tables[t]->buckets[i]; entry != NULL; entry = entry->next) {
+                size += SDL_strlen(entry->key) + 1;
+            }
+        }
     }
 
-    return SDL_PhysFS_OpenIO(handle);
+    // The snapshot, its entries and their names share an allocation.
+    SDL_PhysFS_Stats* stats = (SDL_PhysFS_Stats*)SDL_malloc(size);
+    if (stats != NULL) {
+        stats->total = SDL_PhysFS_stats.total;
+        stats->numFiles = (int)SDL_PhysFS_stats.files.count;
+        stats->numMounts = (int)SDL_PhysFS_stats.mounts.count;
+        stats->files = (SDL_PhysFS_StatsEntry*)(stats + 1);
+        stats->mounts = stats->files + stats->numFiles;
+        char* strings = (char*)(stats->mounts + stats->numMounts);
+        SDL_PhysFS_StatsCopyTable(&SDL_PhysFS_stats.files, stats->files, &strings);
+        SDL_PhysFS_StatsCopyTable(&SDL_PhysFS_stats.mounts, stats->mounts, &strings);
+    }
+    SDL_UnlockSpinlock(&SDL_PhysFS_stats.lock);
+
+    if (stats != NULL) {
+        SDL_qsort(stats->files, (size_t)stats->numFiles, sizeof(SDL_PhysFS_StatsEntry), SDL_PhysFS_CompareStatsEntries);
+        SDL_qsort(stats->mounts, (size_t)stats->numMounts, sizeof(SDL_PhysFS_StatsEntry), SDL_PhysFS_CompareStatsEntries);
+    }
+
+    return stats;
+#else
+    SDL_Unsupported();
+    return NULL;
+#endif
 }
 
 /**
- * Loads a bitmap file from PhysFS into an SDL_Surface.
+ * Sets all of the I/O counters back to zero.
  *
- * @param filename The filename to load.
- *
- * @return The SDL_Surface, or NULL on failure, use SDL_GetError() for details.
+ * @see SDL_PhysFS_GetStats()
  */
-SDL_Surface* SDL_PhysFS_LoadBMP(const char* filename) {
-    SDL_IOStream* io = SDL_PhysFS_IOFromFile(filename);
-    if (io == NULL) {
-        return NULL;
+void SDL_PhysFS_ResetStats(void) {
+#ifdef SDL_PHYSFS_STATS
+    SDL_LockSpinlock(&SDL_PhysFS_stats.lock);
+    SDL_zero(SDL_PhysFS_stats.total);
+    const SDL_PhysFS_HashTable* tables[2] = { &SDL_PhysFS_stats.files, &SDL_PhysFS_stats.mounts };
+    for (int t = 0; t < 2; t++) {
+        for (Uint32 i = 0; i < tables[t]->numBuckets; i++) {
+            for (SDL_PhysFS_HashEntry* entry = tables[t]->buckets[i]; entry != NULL; entry = entry->next) {
+                SDL_zerop((SDL_PhysFS_Counters*)entry->value);
+            }
+        }
     }
-
-    return SDL_LoadBMP_IO(io, 1);
+    SDL_UnlockSpinlock(&SDL_PhysFS_stats.lock);
+#endif
 }
 
 /**
- * Loads a JPG file from PhysFS.
+ * Installs a callback that is told about each open, read, seek and close, as they happen.
  *
- * @param filename The filename of the JPG file to load.
+ * Requires SDL_PHYSFS_STATS to be defined before including the implementation.
  *
- * @return The SDL_Surface, or NULL on failure, use SDL_GetError() for details.
+ * @param callback The callback, or NULL to remove it.
+ * @param userdata A pointer that is passed to the callback.
+ *
+ * @return true on success, or false if tracing was compiled out. Use SDL_GetError() for details.
+ *
+ * @see SDL_PhysFS_GetStats()
  */
-SDL_Surface* SDL_PhysFS_LoadJPG(const char* filename) {
-#if SDL_VERSION_ATLEAST(3, 6, 0)
-    SDL_IOStream* io = SDL_PhysFS_IOFromFile(filename);
-    if (io == NULL) {
-        return NULL;
-    }
-
-    return SDL_LoadJPG_IO(io, true);
+bool SDL_PhysFS_SetTraceCallback(SDL_PhysFS_TraceCallback callback, void* userdata) {
+#ifdef SDL_PHYSFS_STATS
+    SDL_LockSpinlock(&SDL_PhysFS_stats.lock);
+    SDL_PhysFS_stats.trace = callback;
+    SDL_PhysFS_stats.traceUserdata = userdata;
+    SDL_UnlockSpinlock(&SDL_PhysFS_stats.lock);
+    return true;
 #else
-    (void)filename;
-    SDL_PhysFS_SetError("SDL_PhysFS_LoadJPG requires SDL 3.6.0 or newer");
-    return NULL;
+    (void)callback;
+    (void)userdata;
+    return SDL_Unsupported();
 #endif
 }
 
 /**
- * Loads a PNG file from PhysFS.
+ * Maps virtual paths to the directory or archive that provides them, when enabled.
  *
- * @param filename The filename of the PNG file to load.
+ * The table's values are the keys of dirs, which holds a copy of each
+ * directory or archive name that has been cached. Those copies are kept until
+ * SDL_PhysFS_Quit(), so they stay valid for callers after an unmount clears
+ * the table. Missing paths are kept with a NULL value, up to
+ * SDL_PHYSFS_PATH_CACHE_MAX_MISSING of them.
  *
- * @return The SDL_Surface, or NULL on failure, use SDL_GetError() for details.
+ * @internal
  */
-SDL_Surface* SDL_PhysFS_LoadPNG(const char* filename) {
-    SDL_IOStream* io = SDL_PhysFS_IOFromFile(filename);
-    if (io == NULL) {
-        return NULL;
-    }
-
-    return SDL_LoadPNG_IO(io, 1);
-}
+static struct {
+    SDL_SpinLock lock;
+    SDL_AtomicInt enabled;
+    SDL_PhysFS_HashTable table;
+    SDL_PhysFS_HashTable dirs;
+    Uint32 missing;
+    Uint32 generation;
+} SDL_PhysFS_pathCache = { 0, { 0 }, { NULL, 0, 0 }, { NULL, 0, 0 }, 0, 0 };
 
 /**
- * Loads a surface from any supported image format through PhysFS.
+ * Forgets every resolved path in the path cache, and every file in the content cache.
  *
- * @param filename The filename of the image file to load.
+ * This is done automatically by SDL_PhysFS's mount, unmount and write functions. Call it after changing the search path with PhysFS directly.
  *
- * @return The SDL_Surface, or NULL on failure, use SDL_GetError() for details.
+ * @see SDL_PhysFS_SetPathCacheEnabled()
+ * @see SDL_PhysFS_SetContentCacheSize()
  */
-SDL_Surface* SDL_PhysFS_LoadSurface(const char* filename) {
-    SDL_IOStream* io = SDL_PhysFS_IOFromFile(filename);
-    if (io == NULL) {
-        return NULL;
-    }
+void SDL_PhysFS_ClearPathCache(void) {
+    SDL_LockSpinlock(&SDL_PhysFS_pathCache.lock);
+    SDL_PhysFS_HashClear(&SDL_PhysFS_pathCache.table);
+    SDL_PhysFS_pathCache.missing = 0;
+    SDL_PhysFS_pathCache.generation++;
+    SDL_UnlockSpinlock(&SDL_PhysFS_pathCache.lock);
 
-    return SDL_LoadSurface_IO(io, true);
+    SDL_PhysFS_ClearContentCache();
 }
 
 /**
- * Loads a wav file from PhysFS.
+ * Enables or disables the path cache.
  *
- * @param filename The filename of the wav file to load.
+ * With many directories and archives mounted, each lookup walks the whole
+ * search path. The path cache remembers which one provides each path, and
+ * whether it exists at all, so repeated SDL_PhysFS_Exists() calls and opens
+ * of missing files are answered without walking the search path again. Up to
+ * SDL_PHYSFS_PATH_CACHE_MAX_MISSING missing paths are remembered.
  *
- * @return True or false depending on if loading was successful. Use SDL_GetError() for details of the failure.
+ * The cache is disabled by default.
+ *
+ * @param enabled Whether to cache resolved paths.
+ *
+ * @see SDL_PhysFS_ClearPathCache()
  */
-bool SDL_PhysFS_LoadWAV(const char* filename, SDL_AudioSpec * spec, Uint8 ** audio_buf, Uint32 * audio_len) {
-    SDL_IOStream* io = SDL_PhysFS_IOFromFile(filename);
-    if (io == NULL) {
-        return false;
-    }
-
-    return SDL_LoadWAV_IO(io, 1, spec, audio_buf, audio_len);
+void SDL_PhysFS_SetPathCacheEnabled(bool enabled) {
+    SDL_LockSpinlock(&SDL_PhysFS_pathCache.lock);
+    SDL_PhysFS_HashClear(&SDL_PhysFS_pathCache.table);
+    SDL_PhysFS_pathCache.missing = 0;
+    SDL_PhysFS_pathCache.generation++;
+    SDL_SetAtomicInt(&SDL_PhysFS_pathCache.enabled, enabled ? 1 : 0);
+    SDL_UnlockSpinlock(&SDL_PhysFS_pathCache.lock);
 }
 
 /**
- * Loads all the file data from a given filename.
+ * Finds the directory or archive that provides a path, through the path cache when it's enabled.
  *
- * @param filename The name of the file to load.
- * @param datasize Where to put the resulting size of the file.
+ * @return The directory or archive, or NULL if the path doesn't exist. Through the cache, this is a copy that stays valid until SDL_PhysFS_Quit().
  *
- * @return A new memory buffer containing all the data from the file. NULL on failure, use SDL_GetError() for details.
+ * @internal
  */
-void* SDL_PhysFS_LoadFile(const char* filename, size_t *datasize) {
-    if (filename == NULL) {
-        SDL_InvalidParamError("filename");
-        return NULL;
+static const char* SDL_PhysFS_GetRealDir(const char* filename) {
+    if (SDL_GetAtomicInt(&SDL_PhysFS_pathCache.enabled) == 0 || filename == NULL) {
+        return PHYSFS_getRealDir(filename);
     }
 
-    PHYSFS_File* handle = PHYSFS_openRead(filename);
-    if (handle == NULL) {
+    Uint32 hash = SDL_PhysFS_Hash(filename);
+    SDL_LockSpinlock(&SDL_PhysFS_pathCache.lock);
+    SDL_PhysFS_HashEntry* entry = SDL_PhysFS_HashFind(&SDL_PhysFS_pathCache.table, filename, hash);
+    if (entry != NULL) {
+        const char* realDir = (const char*)entry->value;
+        SDL_UnlockSpinlock(&SDL_PhysFS_pathCache.lock);
+#ifdef SDL_PHYSFS_STATS
+        SDL_PhysFS_StatsCacheLookup(filename, realDir, true);
+#endif
+        return realDir;
+    }
+    Uint32 generation = SDL_PhysFS_pathCache.generation;
+    SDL_UnlockSpinlock(&SDL_PhysFS_pathCache.lock);
+
+    // Resolve the path outside of the lock, as it walks the search path.
+    const char* realDir = PHYSFS_getRealDir(filename);
+
+    // Swap PhysFS's name, which goes away on unmount, for the cache's own copy.
+    SDL_LockSpinlock(&SDL_PhysFS_pathCache.lock);
+    if (realDir != NULL) {
+        Uint32 dirHash = SDL_PhysFS_Hash(realDir);
+        SDL_PhysFS_HashEntry* dir = SDL_PhysFS_HashFind(&SDL_PhysFS_pathCache.dirs, realDir, dirHash);
+        if (dir == NULL) {
+            dir = SDL_PhysFS_HashInsert(&SDL_PhysFS_pathCache.dirs, realDir, dirHash, NULL);
+        }
+        if (dir == NULL) {
+            SDL_UnlockSpinlock(&SDL_PhysFS_pathCache.lock);
+            return realDir;
+        }
+        realDir = dir->key;
+    }
+
+    // Skip caching if the search path changed while it was being resolved.
+    if (SDL_GetAtomicInt(&SDL_PhysFS_pathCache.enabled) != 0 && generation == SDL_PhysFS_pathCache.generation &&
+        SDL_PhysFS_HashFind(&SDL_PhysFS_pathCache.table, filename, hash) == NULL) {
+        if (realDir != NULL) {
+            SDL_PhysFS_HashInsert(&SDL_PhysFS_pathCache.table, filename, hash, realDir);
+        }
+        else if (SDL_PhysFS_pathCache.missing < SDL_PHYSFS_PATH_CACHE_MAX_MISSING &&
+                 SDL_PhysFS_HashInsert(&SDL_PhysFS_pathCache.table, filename, hash, NULL) != NULL) {
+            SDL_PhysFS_pathCache.missing++;
+        }
+    }
+    SDL_UnlockSpinlock(&SDL_PhysFS_pathCache.lock);
+#ifdef SDL_PHYSFS_STATS
+    SDL_PhysFS_StatsCacheLookup(filename, realDir, false);
+#endif
+
+    return realDir;
+}
+
+/**
+ * Checks the path cache for a file that is known not to exist, so opening it can fail early.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_IsKnownMissing(const char* filename) {
+    if (SDL_GetAtomicInt(&SDL_PhysFS_pathCache.enabled) == 0 || SDL_PhysFS_GetRealDir(filename) != NULL) {
+        return false;
+    }
+
+    PHYSFS_setErrorCode(PHYSFS_ERR_NOT_FOUND);
+    return true;
+}
+
+/**
+ * The type of each directory and archive file mounted by SDL_PhysFS_Mount(),
+ * keyed by the name it was mounted with, so reads can tell a directory from an
+ * archive without checking the disk. Anything else PhysFS reports as a real
+ * directory, such as an archive mounted from memory, isn't on disk.
+ *
+ * @internal
+ */
+static struct {
+    SDL_SpinLock lock;
+    SDL_PhysFS_HashTable table;
+} SDL_PhysFS_mountedPaths = { 0, { NULL, 0, 0 } };
+
+/**
+ * Remembers whether a path mounted by SDL_PhysFS_Mount() is a directory or an archive file.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_RememberMountedPath(const char* newDir) {
+    SDL_PathInfo info;
+    if (newDir == NULL || !SDL_GetPathInfo(newDir, &info) || (info.type != SDL_PATHTYPE_DIRECTORY && info.type != SDL_PATHTYPE_FILE)) {
+        return;
+    }
+
+    Uint32 hash = SDL_PhysFS_Hash(newDir);
+    SDL_LockSpinlock(&SDL_PhysFS_mountedPaths.lock);
+    if (SDL_PhysFS_HashFind(&SDL_PhysFS_mountedPaths.table, newDir, hash) == NULL) {
+        SDL_PhysFS_HashInsert(&SDL_PhysFS_mountedPaths.table, newDir, hash, (const void*)(uintptr_t)info.type);
+    }
+    SDL_UnlockSpinlock(&SDL_PhysFS_mountedPaths.lock);
+}
+
+/**
+ * Finds whether a directory or archive from SDL_PhysFS_GetRealDir() was mounted from disk as a directory or an archive file.
+ *
+ * @return SDL_PATHTYPE_DIRECTORY or SDL_PATHTYPE_FILE, or SDL_PATHTYPE_NONE if it wasn't mounted by SDL_PhysFS_Mount().
+ *
+ * @internal
+ */
+static SDL_PathType SDL_PhysFS_GetMountedPathType(const char* realDir) {
+    SDL_LockSpinlock(&SDL_PhysFS_mountedPaths.lock);
+    SDL_PhysFS_HashEntry* entry = SDL_PhysFS_HashFind(&SDL_PhysFS_mountedPaths.table, realDir, SDL_PhysFS_Hash(realDir));
+    SDL_PathType type = entry != NULL ? (SDL_PathType)(uintptr_t)entry->value : SDL_PATHTYPE_NONE;
+    SDL_UnlockSpinlock(&SDL_PhysFS_mountedPaths.lock);
+    return type;
+}
+
+// The content pack format, for SDL_PhysFS's archiver and the sdl_physfs_cas tool that builds them.
+#define SDL_PHYSFS_CONTENT_PACK_MAGIC "SDLPFCAS"
+#define SDL_PHYSFS_CONTENT_PACK_VERSION 2
+#define SDL_PHYSFS_CONTENT_PACK_HEADER_SIZE 72
+#define SDL_PHYSFS_CONTENT_PACK_HASH_SIZE 32
+#define SDL_PHYSFS_CONTENT_PACK_RECORD_SIZE 48
+
+/**
+ * A file or directory in a content pack.
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_ContentNode {
+    const char* name;
+    bool directory;
+    const Uint8* hash; /**< The SHA-256 of the file's contents, in the pack's index. */
+    Uint64 size;
+    Sint64 offset; /**< Where the blob starts in the pack, or -1 if it's in a base pack. */
+    struct SDL_PhysFS_ContentNode* children;
+    struct SDL_PhysFS_ContentNode* next;
+} SDL_PhysFS_ContentNode;
+
+/**
+ * A mounted content pack.
+ *
+ * A content pack is a blob store with an index of paths, where each path names
+ * its blob by the hash and size of its contents. Identical files are stored
+ * once, however many paths share them.
+ *
+ * The file starts with a 72 byte header: the magic, then the version, blob
+ * count, entry count and strings size as 32-bit values, the offset of the
+ * index as a 64-bit value, the base count as a 32-bit value and 4 reserved
+ * bytes, all little-endian, and then the pack's identity, which is the SHA-256
+ * of its index. The blobs follow, and the index runs to the end of the file.
+ * It holds the identity of each base pack, a record of the hash, offset and
+ * size of each blob, sorted by hash and size, a record of the hash, size, name
+ * offset and name length of each path, and the null-terminated paths. Hashes
+ * are the SHA-256 of the contents.
+ *
+ * A delta pack holds only the blobs its bases don't have, and the rest are
+ * found in whichever of its base packs are mounted. Other packs are never
+ * searched, even if they have a blob with the same hash and size.
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_ContentPack {
+    PHYSFS_Io* io;
+    SDL_AtomicInt refcount;
+    Uint8 id[SDL_PHYSFS_CONTENT_PACK_HASH_SIZE];
+    Uint8* index;
+    const Uint8* bases;
+    Uint32 baseCount;
+    const Uint8* blobs;
+    Uint32 blobCount;
+    SDL_PhysFS_ContentNode* files;
+    SDL_PhysFS_ContentNode root;
+    SDL_PhysFS_HashTable paths;
+    struct SDL_PhysFS_ContentPack* next;
+} SDL_PhysFS_ContentPack;
+
+/**
+ * The mounted content packs, where delta packs find the blobs they share with their bases.
+ *
+ * @internal
+ */
+static struct {
+    SDL_SpinLock lock;
+    SDL_PhysFS_ContentPack* packs;
+} SDL_PhysFS_contentPacks = { 0, NULL };
+
+/**
+ * The state of a PHYSFS_Io that reads one blob from a content pack.
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_BlobHandle {
+    PHYSFS_Io* source;
+    Uint64 offset;
+    Uint64 size;
+    Uint64 position;
+} SDL_PhysFS_BlobHandle;
+
+static Uint32 SDL_PhysFS_ReadLE32(const Uint8* data) {
+    return (Uint32)data[0] | ((Uint32)data[1] << 8) | ((Uint32)data[2] << 16) | ((Uint32)data[3] << 24);
+}
+
+static Uint64 SDL_PhysFS_ReadLE64(const Uint8* data) {
+    return (Uint64)SDL_PhysFS_ReadLE32(data) | ((Uint64)SDL_PhysFS_ReadLE32(data + 4) << 32);
+}
+
+static PHYSFS_Io* SDL_PhysFS_CreateBlobIo(PHYSFS_Io* source, Uint64 offset, Uint64 size);
+
+/**
+ * PHYSFS_Io callback for blobs: read.
+ *
+ * @internal
+ */
+static PHYSFS_sint64 SDL_PhysFS_BlobIoRead(PHYSFS_Io* io, void* buf, PHYSFS_uint64 len) {
+    SDL_PhysFS_BlobHandle* handle = (SDL_PhysFS_BlobHandle*)io->opaque;
+    len = SDL_min(len, handle->size - handle->position);
+    if (len == 0) {
+        return 0;
+    }
+
+    PHYSFS_sint64 rc = handle->source->read(handle->source, buf, len);
+    if (rc > 0) {
+        handle->position += (Uint64)rc;
+    }
+
+    return rc;
+}
+
+/**
+ * PHYSFS_Io callback for blobs: write. Content packs are read-only.
+ *
+ * @internal
+ */
+static PHYSFS_sint64 SDL_PhysFS_BlobIoWrite(PHYSFS_Io* io, const void* buffer, PHYSFS_uint64 len) {
+    (void)io;
+    (void)buffer;
+    (void)len;
+    PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+    return -1;
+}
+
+/**
+ * PHYSFS_Io callback for blobs: seek.
+ *
+ * @internal
+ */
+static int SDL_PhysFS_BlobIoSeek(PHYSFS_Io* io, PHYSFS_uint64 offset) {
+    SDL_PhysFS_BlobHandle* handle = (SDL_PhysFS_BlobHandle*)io->opaque;
+    if (offset > handle->size) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_PAST_EOF);
+        return 0;
+    }
+    if (!handle->source->seek(handle->source, handle->offset + offset)) {
+        return 0;
+    }
+
+    handle->position = offset;
+    return 1;
+}
+
+/**
+ * PHYSFS_Io callback for blobs: tell.
+ *
+ * @internal
+ */
+static PHYSFS_sint64 SDL_PhysFS_BlobIoTell(PHYSFS_Io* io) {
+    return (PHYSFS_sint64)((SDL_PhysFS_BlobHandle*)io->opaque)->position;
+}
+
+/**
+ * PHYSFS_Io callback for blobs: length.
+ *
+ * @internal
+ */
+static PHYSFS_sint64 SDL_PhysFS_BlobIoLength(PHYSFS_Io* io) {
+    return (PHYSFS_sint64)((SDL_PhysFS_BlobHandle*)io->opaque)->size;
+}
+
+/**
+ * PHYSFS_Io callback for blobs: duplicate. The new PHYSFS_Io starts at position 0.
+ *
+ * @internal
+ */
+static PHYSFS_Io* SDL_PhysFS_BlobIoDuplicate(PHYSFS_Io* io) {
+    SDL_PhysFS_BlobHandle* handle = (SDL_PhysFS_BlobHandle*)io->opaque;
+    PHYSFS_Io* source = handle->source->duplicate(handle->source);
+    if (source == NULL) {
+        return NULL;
+    }
+
+    return SDL_PhysFS_CreateBlobIo(source, handle->offset, handle->size);
+}
+
+/**
+ * PHYSFS_Io callback for blobs: flush.
+ *
+ * @internal
+ */
+static int SDL_PhysFS_BlobIoFlush(PHYSFS_Io* io) {
+    (void)io;
+    return 1;
+}
+
+/**
+ * PHYSFS_Io callback for blobs: destroy.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_BlobIoDestroy(PHYSFS_Io* io) {
+    SDL_PhysFS_BlobHandle* handle = (SDL_PhysFS_BlobHandle*)io->opaque;
+    handle->source->destroy(handle->source);
+    SDL_free(handle);
+    SDL_free(io);
+}
+
+/**
+ * Creates a PHYSFS_Io that reads a blob, taking ownership of the source, which is its own duplicate of the pack's.
+ *
+ * @internal
+ */
+static PHYSFS_Io* SDL_PhysFS_CreateBlobIo(PHYSFS_Io* source, Uint64 offset, Uint64 size) {
+    PHYSFS_Io* io = (PHYSFS_Io*)SDL_malloc(sizeof(PHYSFS_Io));
+    SDL_PhysFS_BlobHandle* handle = (SDL_PhysFS_BlobHandle*)SDL_malloc(sizeof(SDL_PhysFS_BlobHandle));
+    if (io == NULL || handle == NULL || !source->seek(source, offset)) {
+        SDL_free(io);
+        SDL_free(handle);
+        source->destroy(source);
+        PHYSFS_setErrorCode(io == NULL || handle == NULL ? PHYSFS_ERR_OUT_OF_MEMORY : PHYSFS_ERR_IO);
+        return NULL;
+    }
+
+    handle->source = source;
+    handle->offset = offset;
+    handle->size = size;
+    handle->position = 0;
+
+    io->version = 0;
+    io->opaque = handle;
+    io->read = SDL_PhysFS_BlobIoRead;
+    io->write = SDL_PhysFS_BlobIoWrite;
+    io->seek = SDL_PhysFS_BlobIoSeek;
+    io->tell = SDL_PhysFS_BlobIoTell;
+    io->length = SDL_PhysFS_BlobIoLength;
+    io->duplicate = SDL_PhysFS_BlobIoDuplicate;
+    io->flush = SDL_PhysFS_BlobIoFlush;
+    io->destroy = SDL_PhysFS_BlobIoDestroy;
+    return io;
+}
+
+/**
+ * Finds a blob in a content pack's sorted blob records.
+ *
+ * @return The blob's offset in the pack, or -1 if the pack doesn't have it.
+ *
+ * @internal
+ */
+static Sint64 SDL_PhysFS_ContentPackFindBlob(const SDL_PhysFS_ContentPack* pack, const Uint8* hash, Uint64 size) {
+    Uint32 low = 0;
+    Uint32 high = pack->blobCount;
+    while (low < high) {
+        Uint32 middle = low + (high - low) / 2;
+        const Uint8* record = pack->blobs + (size_t)middle * SDL_PHYSFS_CONTENT_PACK_RECORD_SIZE;
+        int order = SDL_memcmp(record, hash, SDL_PHYSFS_CONTENT_PACK_HASH_SIZE);
+        Uint64 recordSize = SDL_PhysFS_ReadLE64(record + SDL_PHYSFS_CONTENT_PACK_HASH_SIZE + 8);
+        if (order == 0 && recordSize == size) {
+            return (Sint64)SDL_PhysFS_ReadLE64(record + SDL_PHYSFS_CONTENT_PACK_HASH_SIZE);
+        }
+        if (order < 0 || (order == 0 && recordSize < size)) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * Finds a file or directory in a content pack. The empty path is the root.
+ *
+ * @internal
+ */
+static SDL_PhysFS_ContentNode* SDL_PhysFS_ContentPackFind(SDL_PhysFS_ContentPack* pack, const char* path) {
+    if (*path == '\0') {
+        return &pack->root;
+    }
+
+    SDL_PhysFS_HashEntry* entry = SDL_PhysFS_HashFind(&pack->paths, path, SDL_PhysFS_Hash(path));
+    return entry != NULL ? (SDL_PhysFS_ContentNode*)entry->value : NULL;
+}
+
+/**
+ * Adds a node to the pack's path table, under its parent directory.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_ContentPackLink(SDL_PhysFS_ContentPack* pack, SDL_PhysFS_ContentNode* parent, const char* path, SDL_PhysFS_ContentNode* node) {
+    SDL_PhysFS_HashEntry* entry = SDL_PhysFS_HashInsert(&pack->paths, path, SDL_PhysFS_Hash(path), node);
+    if (entry == NULL) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_OUT_OF_MEMORY);
+        return false;
+    }
+
+    const char* lastSlash = SDL_strrchr(entry->key, '/');
+    node->name = lastSlash != NULL ? lastSlash + 1 : entry->key;
+    node->next = parent->children;
+    parent->children = node;
+    return true;
+}
+
+/**
+ * Adds a file to a content pack's tree, with each directory above it added the first time it's seen.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_ContentPackAddFile(SDL_PhysFS_ContentPack* pack, char* path, SDL_PhysFS_ContentNode* file) {
+    SDL_PhysFS_ContentNode* parent = &pack->root;
+    for (char* slash = SDL_strchr(path, '/'); slash != NULL; slash = SDL_strchr(slash + 1, '/')) {
+        *slash = '\0';
+        SDL_PhysFS_ContentNode* directory = SDL_PhysFS_ContentPackFind(pack, path);
+        if (directory == NULL) {
+            directory = (SDL_PhysFS_ContentNode*)SDL_calloc(1, sizeof(SDL_PhysFS_ContentNode));
+            if (directory == NULL || !SDL_PhysFS_ContentPackLink(pack, parent, path, directory)) {
+                SDL_free(directory);
+                *slash = '/';
+                return false;
+            }
+            directory->directory = true;
+            directory->offset = -1;
+        }
+        *slash = '/';
+
+        if (!directory->directory) {
+            PHYSFS_setErrorCode(PHYSFS_ERR_CORRUPT);
+            return false;
+        }
+        parent = directory;
+    }
+
+    if (SDL_PhysFS_ContentPackFind(pack, path) != NULL) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_CORRUPT);
+        return false;
+    }
+
+    return SDL_PhysFS_ContentPackLink(pack, parent, path, file);
+}
+
+/**
+ * Checks whether a content pack lists another as one of its bases.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_ContentPackHasBase(const SDL_PhysFS_ContentPack* pack, const SDL_PhysFS_ContentPack* base) {
+    for (Uint32 i = 0; i < pack->baseCount; i++) {
+        if (SDL_memcmp(pack->bases + (size_t)i * SDL_PHYSFS_CONTENT_PACK_HASH_SIZE, base->id, SDL_PHYSFS_CONTENT_PACK_HASH_SIZE) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Frees a content pack, without destroying its PHYSFS_Io.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_FreeContentPack(SDL_PhysFS_ContentPack* pack) {
+    // Directories are allocated one by one, and only the path table knows them all.
+    for (Uint32 i = 0; i < pack->paths.numBuckets; i++) {
+        for (SDL_PhysFS_HashEntry* entry = pack->paths.buckets[i]; entry != NULL; entry = entry->next) {
+            SDL_PhysFS_ContentNode* node = (SDL_PhysFS_ContentNode*)entry->value;
+            if (node->directory) {
+                SDL_free(node);
+            }
+        }
+    }
+
+    SDL_PhysFS_HashClear(&pack->paths);
+    SDL_free(pack->files);
+    SDL_free(pack->index);
+    SDL_free(pack);
+}
+
+/**
+ * Drops a reference to a mounted content pack, destroying it once it's been unmounted and nothing is still opening files from it.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_ReleaseContentPack(SDL_PhysFS_ContentPack* pack) {
+    if (SDL_AtomicDecRef(&pack->refcount)) {
+        pack->io->destroy(pack->io);
+        SDL_PhysFS_FreeContentPack(pack);
+    }
+}
+
+/**
+ * Reads a content pack's index, checking that every record stays within the pack.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_ContentPackLoadIndex(SDL_PhysFS_ContentPack* pack, Uint64 indexOffset, Uint32 entryCount, Uint32 stringsSize) {
+    const Uint8* blobs = pack->blobs;
+    for (Uint32 i = 0; i < pack->blobCount; i++) {
+        const Uint8* record = blobs + (size_t)i * SDL_PHYSFS_CONTENT_PACK_RECORD_SIZE;
+        Uint64 offset = SDL_PhysFS_ReadLE64(record + SDL_PHYSFS_CONTENT_PACK_HASH_SIZE);
+        Uint64 size = SDL_PhysFS_ReadLE64(record + SDL_PHYSFS_CONTENT_PACK_HASH_SIZE + 8);
+        if (offset < SDL_PHYSFS_CONTENT_PACK_HEADER_SIZE || size > indexOffset || offset > indexOffset - size) {
+            return false;
+        }
+
+        // Blob records must be sorted, and unique, to be searched.
+        if (i > 0) {
+            const Uint8* previous = record - SDL_PHYSFS_CONTENT_PACK_RECORD_SIZE;
+            int order = SDL_memcmp(record, previous, SDL_PHYSFS_CONTENT_PACK_HASH_SIZE);
+            if (order < 0 || (order == 0 && size <= SDL_PhysFS_ReadLE64(previous + SDL_PHYSFS_CONTENT_PACK_HASH_SIZE + 8))) {
+                return false;
+            }
+        }
+    }
+
+    const Uint8* entries = blobs + (size_t)pack->blobCount * SDL_PHYSFS_CONTENT_PACK_RECORD_SIZE;
+    char* strings = (char*)(entries + (size_t)entryCount * SDL_PHYSFS_CONTENT_PACK_RECORD_SIZE);
+    for (Uint32 i = 0; i < entryCount; i++) {
+        const Uint8* record = entries + (size_t)i * SDL_PHYSFS_CONTENT_PACK_RECORD_SIZE;
+        Uint32 nameOffset = SDL_PhysFS_ReadLE32(record + SDL_PHYSFS_CONTENT_PACK_HASH_SIZE + 8);
+        Uint32 nameLength = SDL_PhysFS_ReadLE32(record + SDL_PHYSFS_CONTENT_PACK_HASH_SIZE + 12);
+        if (nameLength == 0 || nameOffset >= stringsSize || nameLength >= stringsSize - nameOffset) {
+            return false;
+        }
+
+        char* name = strings + nameOffset;
+        if (name[nameLength] != '\0' || SDL_strlen(name) != nameLength ||
+            name[0] == '/' || name[nameLength - 1] == '/' || SDL_strstr(name, "//") != NULL) {
+            return false;
+        }
+
+        SDL_PhysFS_ContentNode* file = &pack->files[i];
+        file->hash = record;
+        file->size = SDL_PhysFS_ReadLE64(record + SDL_PHYSFS_CONTENT_PACK_HASH_SIZE);
+        file->offset = SDL_PhysFS_ContentPackFindBlob(pack, file->hash, file->size);
+        if (!SDL_PhysFS_ContentPackAddFile(pack, name, file)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * PHYSFS_Archiver callback for content packs: openArchive.
+ *
+ * @internal
+ */
+static void* SDL_PhysFS_ContentPackOpenArchive(PHYSFS_Io* io, const char* name, int forWrite, int* claimed) {
+    (void)name;
+    Uint8 header[SDL_PHYSFS_CONTENT_PACK_HEADER_SIZE];
+    if (!io->seek(io, 0) || io->read(io, header, sizeof(header)) != (PHYSFS_sint64)sizeof(header) ||
+        SDL_memcmp(header, SDL_PHYSFS_CONTENT_PACK_MAGIC, 8) != 0) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_UNSUPPORTED);
+        return NULL;
+    }
+
+    *claimed = 1;
+    if (forWrite) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+        return NULL;
+    }
+    if (SDL_PhysFS_ReadLE32(header + 8) != SDL_PHYSFS_CONTENT_PACK_VERSION) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_UNSUPPORTED);
+        return NULL;
+    }
+
+    // The index runs from its offset to the end of the file.
+    Uint32 blobCount = SDL_PhysFS_ReadLE32(header + 12);
+    Uint32 entryCount = SDL_PhysFS_ReadLE32(header + 16);
+    Uint32 stringsSize = SDL_PhysFS_ReadLE32(header + 20);
+    Uint64 indexOffset = SDL_PhysFS_ReadLE64(header + 24);
+    Uint32 baseCount = SDL_PhysFS_ReadLE32(header + 32);
+    Uint64 basesSize = (Uint64)baseCount * SDL_PHYSFS_CONTENT_PACK_HASH_SIZE;
+    Uint64 indexSize = basesSize + ((Uint64)blobCount + entryCount) * SDL_PHYSFS_CONTENT_PACK_RECORD_SIZE + stringsSize;
+    PHYSFS_sint64 length = io->length(io);
+    if (length < 0 || indexOffset < SDL_PHYSFS_CONTENT_PACK_HEADER_SIZE || indexOffset > (Uint64)length ||
+        indexSize != (Uint64)length - indexOffset || indexSize > SDL_SIZE_MAX) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_CORRUPT);
+        return NULL;
+    }
+
+    SDL_PhysFS_ContentPack* pack = (SDL_PhysFS_ContentPack*)SDL_calloc(1, sizeof(SDL_PhysFS_ContentPack));
+    if (pack == NULL) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_OUT_OF_MEMORY);
+        return NULL;
+    }
+    SDL_SetAtomicInt(&pack->refcount, 1);
+    SDL_memcpy(pack->id, header + 40, SDL_PHYSFS_CONTENT_PACK_HASH_SIZE);
+    pack->baseCount = baseCount;
+    pack->blobCount = blobCount;
+    pack->root.directory = true;
+    pack->root.offset = -1;
+    pack->root.name = "";
+    pack->index = (Uint8*)SDL_malloc(indexSize > 0 ? (size_t)indexSize : 1);
+    pack->files = (SDL_PhysFS_ContentNode*)SDL_calloc(entryCount > 0 ? entryCount : 1, sizeof(SDL_PhysFS_ContentNode));
+    if (pack->index == NULL || pack->files == NULL) {
+        SDL_PhysFS_FreeContentPack(pack);
+        PHYSFS_setErrorCode(PHYSFS_ERR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    if (!io->seek(io, indexOffset) || io->read(io, pack->index, indexSize) != (PHYSFS_sint64)indexSize) {
+        SDL_PhysFS_FreeContentPack(pack);
+        PHYSFS_setErrorCode(PHYSFS_ERR_IO);
+        return NULL;
+    }
+    pack->bases = pack->index;
+    pack->blobs = pack->index + basesSize;
+    if (!SDL_PhysFS_ContentPackLoadIndex(pack, indexOffset, entryCount, stringsSize)) {
+        SDL_PhysFS_FreeContentPack(pack);
+        if (PHYSFS_getLastErrorCode() == PHYSFS_ERR_OK) {
+            PHYSFS_setErrorCode(PHYSFS_ERR_CORRUPT);
+        }
+        return NULL;
+    }
+
+    pack->io = io;
+    SDL_LockSpinlock(&SDL_PhysFS_contentPacks.lock);
+    pack->next = SDL_PhysFS_contentPacks.packs;
+    SDL_PhysFS_contentPacks.packs = pack;
+    SDL_UnlockSpinlock(&SDL_PhysFS_contentPacks.lock);
+
+    return pack;
+}
+
+/**
+ * PHYSFS_Archiver callback for content packs: enumerate.
+ *
+ * @internal
+ */
+static PHYSFS_EnumerateCallbackResult SDL_PhysFS_ContentPackEnumerate(void* opaque, const char* dirname, PHYSFS_EnumerateCallback cb, const char* origdir, void* callbackdata) {
+    SDL_PhysFS_ContentNode* directory = SDL_PhysFS_ContentPackFind((SDL_PhysFS_ContentPack*)opaque, dirname);
+    if (directory == NULL || !directory->directory) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_NOT_FOUND);
+        return PHYSFS_ENUM_ERROR;
+    }
+
+    for (SDL_PhysFS_ContentNode* child = directory->children; child != NULL; child = child->next) {
+        PHYSFS_EnumerateCallbackResult result = cb(callbackdata, origdir, child->name);
+        if (result == PHYSFS_ENUM_ERROR) {
+            PHYSFS_setErrorCode(PHYSFS_ERR_APP_CALLBACK);
+            return result;
+        }
+        if (result == PHYSFS_ENUM_STOP) {
+            return result;
+        }
+    }
+
+    return PHYSFS_ENUM_OK;
+}
+
+/**
+ * PHYSFS_Archiver callback for content packs: openRead.
+ *
+ * Each file reads from its own duplicate of the pack's PHYSFS_Io, so files don't share a position.
+ *
+ * @internal
+ */
+static PHYSFS_Io* SDL_PhysFS_ContentPackOpenRead(void* opaque, const char* filename) {
+    SDL_PhysFS_ContentPack* pack = (SDL_PhysFS_ContentPack*)opaque;
+    SDL_PhysFS_ContentNode* node = SDL_PhysFS_ContentPackFind(pack, filename);
+    if (node == NULL) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_NOT_FOUND);
+        return NULL;
+    }
+    if (node->directory) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_NOT_A_FILE);
+        return NULL;
+    }
+
+    if (node->offset >= 0) {
+        PHYSFS_Io* source = pack->io->duplicate(pack->io);
+        return source != NULL ? SDL_PhysFS_CreateBlobIo(source, (Uint64)node->offset, node->size) : NULL;
+    }
+
+    // A delta pack finds the blobs it doesn't have in its bases, if they're mounted.
+    // The base is kept alive by a reference, so its PHYSFS_Io is duplicated outside the lock.
+    SDL_PhysFS_ContentPack* owner = NULL;
+    Sint64 offset = -1;
+    SDL_LockSpinlock(&SDL_PhysFS_contentPacks.lock);
+    for (SDL_PhysFS_ContentPack* other = SDL_PhysFS_contentPacks.packs; owner == NULL && other != NULL; other = other->next) {
+        offset = other != pack && SDL_PhysFS_ContentPackHasBase(pack, other) ? SDL_PhysFS_ContentPackFindBlob(other, node->hash, node->size) : -1;
+        if (offset >= 0) {
+            owner = other;
+            SDL_AtomicIncRef(&owner->refcount);
+        }
+    }
+    SDL_UnlockSpinlock(&SDL_PhysFS_contentPacks.lock);
+
+    if (owner == NULL) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_NOT_FOUND);
+        return NULL;
+    }
+    PHYSFS_Io* source = owner->io->duplicate(owner->io);
+    SDL_PhysFS_ReleaseContentPack(owner);
+    if (source == NULL) {
+        return NULL;
+    }
+
+    return SDL_PhysFS_CreateBlobIo(source, (Uint64)offset, node->size);
+}
+
+/**
+ * PHYSFS_Archiver callback for read-only archives: openWrite and openAppend.
+ *
+ * @internal
+ */
+static PHYSFS_Io* SDL_PhysFS_ReadOnlyOpenWrite(void* opaque, const char* filename) {
+    (void)opaque;
+    (void)filename;
+    PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+    return NULL;
+}
+
+/**
+ * PHYSFS_Archiver callback for read-only archives: remove and mkdir.
+ *
+ * @internal
+ */
+static int SDL_PhysFS_ReadOnlyModify(void* opaque, const char* filename) {
+    (void)opaque;
+    (void)filename;
+    PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+    return 0;
+}
+
+/**
+ * PHYSFS_Archiver callback for content packs: stat.
+ *
+ * @internal
+ */
+static int SDL_PhysFS_ContentPackStat(void* opaque, const char* filename, PHYSFS_Stat* stat) {
+    SDL_PhysFS_ContentNode* node = SDL_PhysFS_ContentPackFind((SDL_PhysFS_ContentPack*)opaque, filename);
+    if (node == NULL) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_NOT_FOUND);
+        return 0;
+    }
+
+    stat->filesize = node->directory ? 0 : (PHYSFS_sint64)node->size;
+    stat->modtime = -1;
+    stat->createtime = -1;
+    stat->accesstime = -1;
+    stat->filetype = node->directory ? PHYSFS_FILETYPE_DIRECTORY : PHYSFS_FILETYPE_REGULAR;
+    stat->readonly = 1;
+    return 1;
+}
+
+/**
+ * PHYSFS_Archiver callback for content packs: closeArchive.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_ContentPackCloseArchive(void* opaque) {
+    SDL_PhysFS_ContentPack* pack = (SDL_PhysFS_ContentPack*)opaque;
+    SDL_LockSpinlock(&SDL_PhysFS_contentPacks.lock);
+    for (SDL_PhysFS_ContentPack** it = &SDL_PhysFS_contentPacks.packs; *it != NULL; it = &(*it)->next) {
+        if (*it == pack) {
+            *it = pack->next;
+            break;
+        }
+    }
+    SDL_UnlockSpinlock(&SDL_PhysFS_contentPacks.lock);
+
+    SDL_PhysFS_ReleaseContentPack(pack);
+}
+
+/**
+ * The archiver for content packs, registered by SDL_PhysFS_Init().
+ *
+ * @internal
+ */
+static const PHYSFS_Archiver SDL_PhysFS_contentPackArchiver = {
+    0,
+    {
+        "cas",
+        "SDL_PhysFS content-addressed pack",
+        "SDL_PhysFS",
+        "https://github.com/RobLoach/SDL_PhysFS",
+        0
+    },
+    SDL_PhysFS_ContentPackOpenArchive,
+    SDL_PhysFS_ContentPackEnumerate,
+    SDL_PhysFS_ContentPackOpenRead,
+    SDL_PhysFS_ReadOnlyOpenWrite,
+    SDL_PhysFS_ReadOnlyOpenWrite,
+    SDL_PhysFS_ReadOnlyModify,
+    SDL_PhysFS_ReadOnlyModify,
+    SDL_PhysFS_ContentPackStat,
+    SDL_PhysFS_ContentPackCloseArchive
+};
+
+// The mount index format, for SDL_PhysFS_WriteMountIndex() and the archiver that reads it.
+#define SDL_PHYSFS_MOUNT_INDEX_MAGIC "SDLPFIDX"
+#define SDL_PHYSFS_MOUNT_INDEX_VERSION 1
+#define SDL_PHYSFS_MOUNT_INDEX_HEADER_SIZE 40
+#define SDL_PHYSFS_MOUNT_INDEX_RECORD_SIZE 24
+#define SDL_PHYSFS_MOUNT_INDEX_TAIL_SIZE 65536
+
+/**
+ * A zip archive mounted through its mount index.
+ *
+ * The index file starts with a 40 byte header: the magic, then the version,
+ * entry count, strings size and the hash of the end of the archive as 32-bit
+ * values, and the archive's size and modification time as 64-bit values, all
+ * little-endian. A record of the data offset and size of each file, with the
+ * offset and length of its path, follows, sorted by path, and then the
+ * null-terminated paths.
+ *
+ * Nothing is built from the index when it's mounted. Paths are found by a
+ * binary search of the records, and the files in a directory are the run of
+ * records whose paths start with it.
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_IndexedArchive {
+    PHYSFS_Io* io;
+    Uint8* index;
+    Uint32 count;
+    const char* strings;
+} SDL_PhysFS_IndexedArchive;
+
+static PHYSFS_Io* SDL_PhysFS_WrapIOStream(SDL_IOStream* src, Sint64 length, bool closeio);
+
+/**
+ * Hashes the end of an archive, where a zip's central directory is, so a mount index can tell when the archive was rewritten.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_HashArchiveTail(SDL_IOStream* io, Uint64 size, Uint32* hash) {
+    size_t length = (size_t)SDL_min(size, (Uint64)SDL_PHYSFS_MOUNT_INDEX_TAIL_SIZE);
+    Uint8* tail = (Uint8*)SDL_malloc(length > 0 ? length : 1);
+    bool result = tail != NULL && SDL_SeekIO(io, (Sint64)(size - length), SDL_IO_SEEK_SET) >= 0 && SDL_ReadIO(io, tail, length) == length;
+    if (result) {
+        *hash = SDL_murmur3_32(tail, length, 0);
+    }
+
+    SDL_free(tail);
+    return result;
+}
+
+/**
+ * Opens the archive a mount index was written for, if it still has the size, modification time and tail hash the index recorded.
+ *
+ * @internal
+ */
+static PHYSFS_Io* SDL_PhysFS_OpenIndexedArchive(const char* path, Uint64 size, Sint64 modifyTime, Uint32 tailHash) {
+    SDL_PathInfo info;
+    if (!SDL_GetPathInfo(path, &info) || info.type != SDL_PATHTYPE_FILE || info.size != size || info.modify_time != modifyTime) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_CORRUPT);
+        return NULL;
+    }
+
+    SDL_IOStream* stream = SDL_IOFromFile(path, "rb");
+    Uint32 hash = 0;
+    if (stream == NULL || !SDL_PhysFS_HashArchiveTail(stream, size, &hash)) {
+        if (stream != NULL) {
+            SDL_CloseIO(stream);
+        }
+        PHYSFS_setErrorCode(PHYSFS_ERR_IO);
+        return NULL;
+    }
+    if (hash != tailHash) {
+        SDL_CloseIO(stream);
+        PHYSFS_setErrorCode(PHYSFS_ERR_CORRUPT);
+        return NULL;
+    }
+
+    PHYSFS_Io* io = SDL_PhysFS_WrapIOStream(stream, (Sint64)size, true);
+    if (io == NULL) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_OUT_OF_MEMORY);
+    }
+
+    return io;
+}
+
+static const Uint8* SDL_PhysFS_IndexedRecord(const SDL_PhysFS_IndexedArchive* archive, Uint32 i) {
+    return archive->index + (size_t)i * SDL_PHYSFS_MOUNT_INDEX_RECORD_SIZE;
+}
+
+static const char* SDL_PhysFS_IndexedName(const SDL_PhysFS_IndexedArchive* archive, Uint32 i) {
+    return archive->strings + SDL_PhysFS_ReadLE32(SDL_PhysFS_IndexedRecord(archive, i) + 16);
+}
+
+/**
+ * Compares an indexed path against the first length characters of path.
+ *
+ * When directory is true, the comparison is against path followed by a slash,
+ * so every path inside the directory compares equal.
+ *
+ * @internal
+ */
+static int SDL_PhysFS_IndexedCompare(const char* name, const char* path, size_t length, bool directory) {
+    int result = SDL_strncmp(name, path, length);
+    if (result != 0) {
+        return result;
+    }
+
+    return (int)(unsigned char)name[length] - (directory ? '/' : 0);
+}
+
+/**
+ * Finds the first record that doesn't compare less than the given path.
+ *
+ * @internal
+ */
+static Uint32 SDL_PhysFS_IndexedLowerBound(const SDL_PhysFS_IndexedArchive* archive, const char* path, size_t length, bool directory) {
+    Uint32 low = 0;
+    Uint32 high = archive->count;
+    while (low < high) {
+        Uint32 middle = low + (high - low) / 2;
+        if (SDL_PhysFS_IndexedCompare(SDL_PhysFS_IndexedName(archive, middle), path, length, directory) < 0) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+/**
+ * Finds a file in a mount index.
+ *
+ * @return The file's record, or -1 if it isn't a file in the archive.
+ *
+ * @internal
+ */
+static Sint64 SDL_PhysFS_IndexedFindFile(const SDL_PhysFS_IndexedArchive* archive, const char* path) {
+    size_t length = SDL_strlen(path);
+    Uint32 i = SDL_PhysFS_IndexedLowerBound(archive, path, length, false);
+    if (i < archive->count && SDL_PhysFS_IndexedCompare(SDL_PhysFS_IndexedName(archive, i), path, length, false) == 0) {
+        return (Sint64)i;
+    }
+
+    return -1;
+}
+
+/**
+ * Finds the first record inside a directory of a mount index. Directories are implied by the paths of the files in them.
+ *
+ * @return The first record in the directory, or -1 if it isn't a directory in the archive.
+ *
+ * @internal
+ */
+static Sint64 SDL_PhysFS_IndexedFindDirectory(const SDL_PhysFS_IndexedArchive* archive, const char* path) {
+    size_t length = SDL_strlen(path);
+    if (length == 0) {
+        return 0;
+    }
+
+    Uint32 i = SDL_PhysFS_IndexedLowerBound(archive, path, length, true);
+    if (i < archive->count && SDL_PhysFS_IndexedCompare(SDL_PhysFS_IndexedName(archive, i), path, length, true) == 0) {
+        return (Sint64)i;
+    }
+
+    return -1;
+}
+
+/**
+ * Checks that every record in a mount index is in bounds, and that the paths are sorted, so they can be searched.
+ *
+ * A path with a null byte inside it would be read as a shorter one, so two
+ * records could resolve to the same path. Those indexes are rejected.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_IndexedValidate(const SDL_PhysFS_IndexedArchive* archive, Uint32 stringsSize, Uint64 archiveSize) {
+    for (Uint32 i = 0; i < archive->count; i++) {
+        const Uint8* record = SDL_PhysFS_IndexedRecord(archive, i);
+        Uint64 offset = SDL_PhysFS_ReadLE64(record);
+        Uint64 size = SDL_PhysFS_ReadLE64(record + 8);
+        Uint64 nameOffset = SDL_PhysFS_ReadLE32(record + 16);
+        Uint64 nameLength = SDL_PhysFS_ReadLE32(record + 20);
+        if (offset > archiveSize || size > archiveSize - offset || nameLength == 0 ||
+            nameOffset + nameLength >= stringsSize || archive->strings[nameOffset + nameLength] != '\0' ||
+            SDL_strlen(archive->strings + nameOffset) != nameLength) {
+            return false;
+        }
+        if (i > 0 && SDL_strcmp(SDL_PhysFS_IndexedName(archive, i - 1), SDL_PhysFS_IndexedName(archive, i)) >= 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * PHYSFS_Archiver callback for mount indexes: openArchive.
+ *
+ * The index is read whole, and its PHYSFS_Io closed, and the archive it
+ * describes is opened by name, which SDL_PhysFS_Mount() gives as the archive's
+ * path.
+ *
+ * @internal
+ */
+static void* SDL_PhysFS_IndexedOpenArchive(PHYSFS_Io* io, const char* name, int forWrite, int* claimed) {
+    Uint8 header[SDL_PHYSFS_MOUNT_INDEX_HEADER_SIZE];
+    if (!io->seek(io, 0) || io->read(io, header, sizeof(header)) != (PHYSFS_sint64)sizeof(header) ||
+        SDL_memcmp(header, SDL_PHYSFS_MOUNT_INDEX_MAGIC, 8) != 0) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_UNSUPPORTED);
+        return NULL;
+    }
+
+    *claimed = 1;
+    if (forWrite) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+        return NULL;
+    }
+    if (SDL_PhysFS_ReadLE32(header + 8) != SDL_PHYSFS_MOUNT_INDEX_VERSION) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_UNSUPPORTED);
+        return NULL;
+    }
+
+    Uint32 count = SDL_PhysFS_ReadLE32(header + 12);
+    Uint32 stringsSize = SDL_PhysFS_ReadLE32(header + 16);
+    Uint32 tailHash = SDL_PhysFS_ReadLE32(header + 20);
+    Uint64 archiveSize = SDL_PhysFS_ReadLE64(header + 24);
+    Sint64 modifyTime = (Sint64)SDL_PhysFS_ReadLE64(header + 32);
+    Uint64 indexSize = (Uint64)count * SDL_PHYSFS_MOUNT_INDEX_RECORD_SIZE + stringsSize;
+    PHYSFS_sint64 length = io->length(io);
+    if (length < 0 || indexSize != (Uint64)length - SDL_PHYSFS_MOUNT_INDEX_HEADER_SIZE || indexSize > SDL_SIZE_MAX) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_CORRUPT);
+        return NULL;
+    }
+
+    SDL_PhysFS_IndexedArchive* archive = (SDL_PhysFS_IndexedArchive*)SDL_calloc(1, sizeof(SDL_PhysFS_IndexedArchive));
+    Uint8* index = (Uint8*)SDL_malloc(indexSize > 0 ? (size_t)indexSize : 1);
+    if (archive == NULL || index == NULL) {
+        SDL_free(archive);
+        SDL_free(index);
+        PHYSFS_setErrorCode(PHYSFS_ERR_OUT_OF_MEMORY);
+        return NULL;
+    }
+    archive->index = index;
+    archive->count = count;
+    archive->strings = (const char*)index + (size_t)count * SDL_PHYSFS_MOUNT_INDEX_RECORD_SIZE;
+
+    if (io->read(io, index, indexSize) != (PHYSFS_sint64)indexSize) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_IO);
+    }
+    else if (!SDL_PhysFS_IndexedValidate(archive, stringsSize, archiveSize)) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_CORRUPT);
+    }
+    else {
+        // The index is only good for the archive it was written for.
+        archive->io = SDL_PhysFS_OpenIndexedArchive(name, archiveSize, modifyTime, tailHash);
+    }
+    if (archive->io == NULL) {
+        SDL_free(index);
+        SDL_free(archive);
+        return NULL;
+    }
+
+    io->destroy(io);
+    return archive;
+}
+
+/**
+ * PHYSFS_Archiver callback for mount indexes: enumerate.
+ *
+ * @internal
+ */
+static PHYSFS_EnumerateCallbackResult SDL_PhysFS_IndexedEnumerate(void* opaque, const char* dirname, PHYSFS_EnumerateCallback cb, const char* origdir, void* callbackdata) {
+    SDL_PhysFS_IndexedArchive* archive = (SDL_PhysFS_IndexedArchive*)opaque;
+    Sint64 first = SDL_PhysFS_IndexedFindDirectory(archive, dirname);
+    if (first < 0) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_NOT_FOUND);
+        return PHYSFS_ENUM_ERROR;
+    }
+
+    size_t length = SDL_strlen(dirname);
+    size_t prefix = length > 0 ? length + 1 : 0;
+    char* directory = NULL;
+    PHYSFS_EnumerateCallbackResult result = PHYSFS_ENUM_OK;
+    for (Uint32 i = (Uint32)first; i < archive->count && result == PHYSFS_ENUM_OK; i++) {
+        const char* name = SDL_PhysFS_IndexedName(archive, i);
+        if (length > 0 && SDL_PhysFS_IndexedCompare(name, dirname, length, true) != 0) {
+            break;
+        }
+
+        // The paths under a subdirectory are all together, so it's reported once, with the first of them.
+        const char* child = name + prefix;
+        const char* slash = SDL_strchr(child, '/');
+        if (slash != NULL) {
+            size_t childLength = (size_t)(slash - child);
+            if (directory != NULL && SDL_strncmp(directory, child, childLength) == 0 && directory[childLength] == '\0') {
+                continue;
+            }
+
+            SDL_free(directory);
+            directory = SDL_strndup(child, childLength);
+            if (directory == NULL) {
+                PHYSFS_setErrorCode(PHYSFS_ERR_OUT_OF_MEMORY);
+                return PHYSFS_ENUM_ERROR;
+            }
+            child = directory;
+        }
+
+        result = cb(callbackdata, origdir, child);
+    }
+    SDL_free(directory);
+
+    if (result == PHYSFS_ENUM_ERROR) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_APP_CALLBACK);
+    }
+
+    return result;
+}
+
+/**
+ * PHYSFS_Archiver callback for mount indexes: openRead.
+ *
+ * Each file reads from its own duplicate of the archive's PHYSFS_Io, so files don't share a position.
+ *
+ * @internal
+ */
+static PHYSFS_Io* SDL_PhysFS_IndexedOpenRead(void* opaque, const char* filename) {
+    SDL_PhysFS_IndexedArchive* archive = (SDL_PhysFS_IndexedArchive*)opaque;
+    Sint64 i = SDL_PhysFS_IndexedFindFile(archive, filename);
+    if (i < 0) {
+        PHYSFS_setErrorCode(SDL_PhysFS_IndexedFindDirectory(archive, filename) >= 0 ? PHYSFS_ERR_NOT_A_FILE : PHYSFS_ERR_NOT_FOUND);
+        return NULL;
+    }
+
+    PHYSFS_Io* source = archive->io->duplicate(archive->io);
+    if (source == NULL) {
+        return NULL;
+    }
+
+    const Uint8* record = SDL_PhysFS_IndexedRecord(archive, (Uint32)i);
+    return SDL_PhysFS_CreateBlobIo(source, SDL_PhysFS_ReadLE64(record), SDL_PhysFS_ReadLE64(record + 8));
+}
+
+/**
+ * PHYSFS_Archiver callback for mount indexes: stat.
+ *
+ * @internal
+ */
+static int SDL_PhysFS_IndexedStat(void* opaque, const char* filename, PHYSFS_Stat* stat) {
+    SDL_PhysFS_IndexedArchive* archive = (SDL_PhysFS_IndexedArchive*)opaque;
+    Sint64 i = SDL_PhysFS_IndexedFindFile(archive, filename);
+    if (i < 0 && SDL_PhysFS_IndexedFindDirectory(archive, filename) < 0) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_NOT_FOUND);
+        return 0;
+    }
+
+    stat->filesize = i >= 0 ? (PHYSFS_sint64)SDL_PhysFS_ReadLE64(SDL_PhysFS_IndexedRecord(archive, (Uint32)i) + 8) : 0;
+    stat->modtime = -1;
+    stat->createtime = -1;
+    stat->accesstime = -1;
+    stat->filetype = i >= 0 ? PHYSFS_FILETYPE_REGULAR : PHYSFS_FILETYPE_DIRECTORY;
+    stat->readonly = 1;
+    return 1;
+}
+
+/**
+ * PHYSFS_Archiver callback for mount indexes: closeArchive.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_IndexedCloseArchive(void* opaque) {
+    SDL_PhysFS_IndexedArchive* archive = (SDL_PhysFS_IndexedArchive*)opaque;
+    archive->io->destroy(archive->io);
+    SDL_free(archive->index);
+    SDL_free(archive);
+}
+
+/**
+ * The archiver for zip archives with a mount index, registered by SDL_PhysFS_Init().
+ *
+ * SDL_PhysFS_Mount() mounts the index under the archive's name, and this archiver claims it by its magic.
+ *
+ * @internal
+ */
+static const PHYSFS_Archiver SDL_PhysFS_mountIndexArchiver = {
+    0,
+    {
+        "sdlidx",
+        "SDL_PhysFS zip mount index",
+        "SDL_PhysFS",
+        "https://github.com/RobLoach/SDL_PhysFS",
+        0
+    },
+    SDL_PhysFS_IndexedOpenArchive,
+    SDL_PhysFS_IndexedEnumerate,
+    SDL_PhysFS_IndexedOpenRead,
+    SDL_PhysFS_ReadOnlyOpenWrite,
+    SDL_PhysFS_ReadOnlyOpenWrite,
+    SDL_PhysFS_ReadOnlyModify,
+    SDL_PhysFS_ReadOnlyModify,
+    SDL_PhysFS_IndexedStat,
+    SDL_PhysFS_IndexedCloseArchive
+};
+
+/**
+ * Get the version of SDL_PhysFS that is linked against your program.
+ *
+ * @return Returns the version of the linked library.
+ */
+int SDL_PhysFS_GetVersion(void) {
+    return SDL_PHYSFS_VERSION;
+}
+
+/**
+ * Initialize the PhysFS virtual file system.
+ *
+ * PhysFS allocates through SDL's memory functions, as they were when this is
+ * called. Define SDL_PHYSFS_POOL_ALLOCATOR before including the implementation
+ * to serve PhysFS's small allocations from pools of reusable blocks instead.
+ *
+ * Content packs, built with the sdl_physfs_cas tool, are mounted with
+ * SDL_PhysFS_Mount() like any other archive.
+ *
+ * @return true on success, false otherwise.
+ *
+ * @see SDL_PhysFS_Quit()
+ */
+bool SDL_PhysFS_Init(const char* argv) {
+    // Set up the memory functions.
+    SDL_PhysFS_RefreshMemoryFunctions();
+    PHYSFS_Allocator allocator;
+    allocator.Init = NULL;
+#ifdef SDL_PHYSFS_POOL_ALLOCATOR
+    allocator.Deinit = SDL_PhysFS_PoolDeinit;
+#else
+    allocator.Deinit = NULL;
+#endif
+    allocator.Malloc = &SDL_PhysFS_AllocatorMalloc;
+    allocator.Realloc = &SDL_PhysFS_AllocatorRealloc;
+    allocator.Free = &SDL_PhysFS_AllocatorFree;
+    PHYSFS_setAllocator(&allocator);
+
+    if (PHYSFS_init(argv) == 0) {
+        SDL_PhysFS_SetError("Failed to initialize PhysFS");
+        return false;
+    }
+
+    // Content packs mount like any archive PhysFS supports.
+    if (PHYSFS_registerArchiver(&SDL_PhysFS_contentPackArchiver) == 0) {
+        SDL_PhysFS_SetError("Failed to register the content pack archiver");
+        PHYSFS_deinit();
+        return false;
+    }
+
+    // Mount indexes are mounted by SDL_PhysFS_Mount() in place of the archive they describe.
+    if (PHYSFS_registerArchiver(&SDL_PhysFS_mountIndexArchiver) == 0) {
+        SDL_PhysFS_SetError("Failed to register the mount index archiver");
+        PHYSFS_deinit();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Initializes the PhysFS virtual file system with access to SDL's preferences directory.
+ *
+ * Mounts the writable preferences directory as "/pref".
+ *
+ * @param org The name of your organization.
+ * @param app The name of your application.
+ *
+ * @return true on success, false otherwise.
+ *
+ * @see SDL_PhysFS_Init()
+ */
+bool SDL_PhysFS_InitEx(const char* argv, const char* org, const char* app) {
+    // Find the preferences path.
+    char* path = SDL_GetPrefPath(org, app);
+    if (path == NULL) {
+        SDL_PhysFS_SetError("Failed to find SDL's pref directory");
+        return false;
+    }
+
+    // Initialize
+    if (SDL_PhysFS_Init(argv) == false) {
+        SDL_free(path);
+        return false;
+    }
+
+    // Set up the write directory as /app
+    if (!SDL_PhysFS_SetWriteDir(path) || !SDL_PhysFS_Mount(path, "pref")) {
+        SDL_free(path);
+        SDL_PhysFS_Quit();
+        return false;
+    }
+    SDL_free(path);
+
+    return true;
+}
+
+static void SDL_PhysFS_FreeZipIndexes(void);
+
+/**
+ * Close the PhysFS virtual file system.
+ *
+ * @return true on success, false otherwise.
+ */
+bool SDL_PhysFS_Quit() {
+    SDL_PhysFS_CancelPrefetch();
+    SDL_PhysFS_SetParallelReads(false);
+    if (PHYSFS_deinit() == 0) {
+        SDL_PhysFS_SetError("Failed to deinitialize PhysFS");
+        return false;
+    }
+    SDL_PhysFS_ClearPathCache();
+    SDL_LockSpinlock(&SDL_PhysFS_pathCache.lock);
+    SDL_PhysFS_HashClear(&SDL_PhysFS_pathCache.dirs);
+    SDL_UnlockSpinlock(&SDL_PhysFS_pathCache.lock);
+    SDL_PhysFS_FreeZipIndexes();
+    SDL_LockSpinlock(&SDL_PhysFS_mountedPaths.lock);
+    SDL_PhysFS_HashClear(&SDL_PhysFS_mountedPaths.table);
+    SDL_UnlockSpinlock(&SDL_PhysFS_mountedPaths.lock);
+#ifdef SDL_PHYSFS_STATS
+    SDL_LockSpinlock(&SDL_PhysFS_stats.lock);
+    SDL_PhysFS_StatsClearTable(&SDL_PhysFS_stats.files);
+    SDL_PhysFS_StatsClearTable(&SDL_PhysFS_stats.mounts);
+    SDL_zero(SDL_PhysFS_stats.total);
+    SDL_UnlockSpinlock(&SDL_PhysFS_stats.lock);
+#endif
+
+    // Remove the SDL allocator.
+    PHYSFS_setAllocator(NULL);
+
+    return true;
+}
+
+SDL_IOStatus SDL_PhysFS_IOStatus(int error) {
+    switch ((PHYSFS_ErrorCode)error) {
+        case PHYSFS_ERR_OK: return SDL_IO_STATUS_READY;
+        case PHYSFS_ERR_OTHER_ERROR: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_OUT_OF_MEMORY: return SDL_IO_STATUS_NOT_READY;
+        case PHYSFS_ERR_NOT_INITIALIZED: return SDL_IO_STATUS_NOT_READY;
+        case PHYSFS_ERR_IS_INITIALIZED: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_ARGV0_IS_NULL: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_UNSUPPORTED: return SDL_IO_STATUS_NOT_READY;
+        case PHYSFS_ERR_PAST_EOF: return SDL_IO_STATUS_EOF;
+        case PHYSFS_ERR_FILES_STILL_OPEN: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_INVALID_ARGUMENT: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_NOT_MOUNTED: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_NOT_FOUND: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_SYMLINK_FORBIDDEN: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_NO_WRITE_DIR: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_OPEN_FOR_READING: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_OPEN_FOR_WRITING: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_NOT_A_FILE: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_READ_ONLY: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_CORRUPT: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_SYMLINK_LOOP: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_IO: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_PERMISSION: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_NO_SPACE: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_BAD_FILENAME: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_BUSY: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_DIR_NOT_EMPTY: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_OS_ERROR: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_DUPLICATE: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_BAD_PASSWORD: return SDL_IO_STATUS_ERROR;
+        case PHYSFS_ERR_APP_CALLBACK: return SDL_IO_STATUS_ERROR;
+    }
+
+    return SDL_IO_STATUS_READY;
+}
+
+/**
+ * Mounts an archive through the mount index beside it, if there is one, so the archive's central directory isn't read.
+ *
+ * @return true if the archive was mounted from its index, false if it should be mounted as usual.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_MountIndexed(const char* newDir, const char* mountPoint) {
+    // PhysFS ignores mounting the same path twice, without taking the PHYSFS_Io.
+    char* indexPath = NULL;
+    if (newDir == NULL || PHYSFS_getMountPoint(newDir) != NULL ||
+        SDL_asprintf(&indexPath, "%s%s", newDir, SDL_PHYSFS_MOUNT_INDEX_EXTENSION) < 0) {
+        return false;
+    }
+
+    SDL_PathInfo info;
+    SDL_IOStream* index = NULL;
+    if (SDL_GetPathInfo(indexPath, &info) && info.type == SDL_PATHTYPE_FILE) {
+        index = SDL_IOFromFile(indexPath, "rb");
+    }
+    SDL_free(indexPath);
+    if (index == NULL) {
+        return false;
+    }
+
+    // The index is mounted under the archive's name, where the mount index archiver finds the archive.
+    PHYSFS_Io* io = SDL_PhysFS_WrapIOStream(index, (Sint64)info.size, true);
+    if (io == NULL) {
+        return false;
+    }
+    if (PHYSFS_mountIo(io, newDir, mountPoint, 1) == 0) {
+        io->destroy(io);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Mounts the given directory, at the given mount point.
+ *
+ * When a zip archive has a mount index beside it, written by
+ * SDL_PhysFS_WriteMountIndex(), and the archive hasn't changed since, the
+ * archive is mounted through the index instead of its central directory.
+ *
+ * @param newDir Directory or archive to add to the path, in platform-dependent notation.
+ * @param mountPoint Location in the interpolated tree that this archive will be "mounted", in platform-independent notation. NULL or "" is equivalent to "/".
+ *
+ * @return true on success, false otherwise.
+ *
+ * @see SDL_PhysFS_Unmount()
+ * @see SDL_PhysFS_WriteMountIndex()
+ */
+bool SDL_PhysFS_Mount(const char* newDir, const char* mountPoint) {
+    if (SDL_PhysFS_MountIndexed(newDir, mountPoint)) {
+        SDL_PhysFS_RememberMountedPath(newDir);
+        SDL_PhysFS_ClearPathCache();
+        return true;
+    }
+
+    if (PHYSFS_mount(newDir, mountPoint, 1) == 0) {
+        SDL_PhysFS_SetError("Failed to mount");
+        return false;
+    }
+    SDL_PhysFS_RememberMountedPath(newDir);
+    SDL_PhysFS_ClearPathCache();
+
+    return true;
+}
+
+/**
+ * Mounts the given file data as a mount point in PhysFS.
+ *
+ * @param fileData The archive data as a file buffer.
+ * @param dataSize The size of the file buffer.
+ * @param newDir Filename that can represent this stream.
+ * @param mountPoint The location in the tree that the archive will be mounted.
+ *
+ * @return true on success, false otherwise.
+ *
+ * @see SDL_PhysFS_Mount()
+ */
+bool SDL_PhysFS_MountFromMemory(const unsigned char *fileData, size_t dataSize, const char* newDir, const char* mountPoint) {
+    if (dataSize == 0) {
+        SDL_SetError("SDL_PhysFS_MountFromMemory: Cannot mount a data size of 0");
+        return false;
+    }
+
+    if (PHYSFS_mountMemory(fileData, (PHYSFS_uint64)dataSize, 0, newDir, mountPoint, 1) == 0) {
+        SDL_PhysFS_SetError("Failed to mount internal memory");
+        return false;
+    }
+    SDL_PhysFS_ClearPathCache();
+
+    return true;
+}
+
+/**
+ * Shared state for every PHYSFS_Io that wraps the same SDL_IOStream.
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_IOSource {
+    SDL_IOStream* io;
+    SDL_Mutex* lock;
+    SDL_AtomicInt refcount;
+    Sint64 length;
+    bool closeio;
+} SDL_PhysFS_IOSource;
+
+/**
+ * A PHYSFS_Io's view of an SDL_PhysFS_IOSource, with its own file position.
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_IOSourceHandle {
+    SDL_PhysFS_IOSource* source;
+    Sint64 position;
+} SDL_PhysFS_IOSourceHandle;
+
+static PHYSFS_Io* SDL_PhysFS_CreateSourceIo(SDL_PhysFS_IOSource* source, Sint64 position);
+
+/**
+ * PHYSFS_Io callback: read.
+ *
+ * @internal
+ */
+static PHYSFS_sint64 SDL_PhysFS_SourceIoRead(PHYSFS_Io* io, void* buf, PHYSFS_uint64 len) {
+    SDL_PhysFS_IOSourceHandle* handle = (SDL_PhysFS_IOSourceHandle*)io->opaque;
+    SDL_PhysFS_IOSource* source = handle->source;
+
+    // Duplicates share the stream, so the seek and read must happen together.
+    SDL_LockMutex(source->lock);
+    if (SDL_SeekIO(source->io, handle->position, SDL_IO_SEEK_SET) < 0) {
+        SDL_UnlockMutex(source->lock);
+        PHYSFS_setErrorCode(PHYSFS_ERR_IO);
+        return -1;
+    }
+    size_t read = SDL_ReadIO(source->io, buf, (size_t)len);
+    SDL_IOStatus status = SDL_GetIOStatus(source->io);
+    SDL_UnlockMutex(source->lock);
+
+    if (read == 0 && status != SDL_IO_STATUS_EOF && len > 0) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_IO);
+        return -1;
+    }
+
+    handle->position += (Sint64)read;
+    return (PHYSFS_sint64)read;
+}
+
+/**
+ * PHYSFS_Io callback: write. Mounted streams are read-only.
+ *
+ * @internal
+ */
+static PHYSFS_sint64 SDL_PhysFS_SourceIoWrite(PHYSFS_Io* io, const void* buffer, PHYSFS_uint64 len) {
+    (void)io;
+    (void)buffer;
+    (void)len;
+    PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+    return -1;
+}
+
+/**
+ * PHYSFS_Io callback: seek.
+ *
+ * @internal
+ */
+static int SDL_PhysFS_SourceIoSeek(PHYSFS_Io* io, PHYSFS_uint64 offset) {
+    SDL_PhysFS_IOSourceHandle* handle = (SDL_PhysFS_IOSourceHandle*)io->opaque;
+    if (offset > (PHYSFS_uint64)handle->source->length) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_PAST_EOF);
+        return 0;
+    }
+
+    handle->position = (Sint64)offset;
+    return 1;
+}
+
+/**
+ * PHYSFS_Io callback: tell.
+ *
+ * @internal
+ */
+static PHYSFS_sint64 SDL_PhysFS_SourceIoTell(PHYSFS_Io* io) {
+    return (PHYSFS_sint64)((SDL_PhysFS_IOSourceHandle*)io->opaque)->position;
+}
+
+/**
+ * PHYSFS_Io callback: length.
+ *
+ * @internal
+ */
+static PHYSFS_sint64 SDL_PhysFS_SourceIoLength(PHYSFS_Io* io) {
+    return (PHYSFS_sint64)((SDL_PhysFS_IOSourceHandle*)io->opaque)->source->length;
+}
+
+/**
+ * PHYSFS_Io callback: duplicate. The new PHYSFS_Io shares the SDL_IOStream, starting at position 0.
+ *
+ * @internal
+ */
+static PHYSFS_Io* SDL_PhysFS_SourceIoDuplicate(PHYSFS_Io* io) {
+    SDL_PhysFS_IOSourceHandle* handle = (SDL_PhysFS_IOSourceHandle*)io->opaque;
+    PHYSFS_Io* duplicate = SDL_PhysFS_CreateSourceIo(handle->source, 0);
+    if (duplicate == NULL) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_OUT_OF_MEMORY);
+    }
+
+    return duplicate;
+}
+
+/**
+ * PHYSFS_Io callback: flush.
+ *
+ * @internal
+ */
+static int SDL_PhysFS_SourceIoFlush(PHYSFS_Io* io) {
+    (void)io;
+    return 1;
+}
+
+/**
+ * PHYSFS_Io callback: destroy. The SDL_IOStream is closed along with the last PHYSFS_Io that uses it.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_SourceIoDestroy(PHYSFS_Io* io) {
+    SDL_PhysFS_IOSourceHandle* handle = (SDL_PhysFS_IOSourceHandle*)io->opaque;
+    SDL_PhysFS_IOSource* source = handle->source;
+
+    if (SDL_AtomicDecRef(&source->refcount)) {
+        if (source->closeio) {
+            SDL_CloseIO(source->io);
+        }
+        SDL_DestroyMutex(source->lock);
+        SDL_free(source);
+    }
+
+    SDL_free(handle);
+    SDL_free(io);
+}
+
+/**
+ * Creates a new PHYSFS_Io that reads from the given source, taking a reference to it.
+ *
+ * @internal
+ */
+static PHYSFS_Io* SDL_PhysFS_CreateSourceIo(SDL_PhysFS_IOSource* source, Sint64 position) {
+    PHYSFS_Io* io = (PHYSFS_Io*)SDL_malloc(sizeof(PHYSFS_Io));
+    SDL_PhysFS_IOSourceHandle* handle = (SDL_PhysFS_IOSourceHandle*)SDL_malloc(sizeof(SDL_PhysFS_IOSourceHandle));
+    if (io == NULL || handle == NULL) {
+        SDL_free(io);
+        SDL_free(handle);
+        return NULL;
+    }
+
+    handle->source = source;
+    handle->position = position;
+    SDL_AtomicIncRef(&source->refcount);
+
+    io->version = 0;
+    io->opaque = handle;
+    io->read = SDL_PhysFS_SourceIoRead;
+    io->write = SDL_PhysFS_SourceIoWrite;
+    io->seek = SDL_PhysFS_SourceIoSeek;
+    io->tell = SDL_PhysFS_SourceIoTell;
+    io->length = SDL_PhysFS_SourceIoLength;
+    io->duplicate = SDL_PhysFS_SourceIoDuplicate;
+    io->flush = SDL_PhysFS_SourceIoFlush;
+    io->destroy = SDL_PhysFS_SourceIoDestroy;
+    return io;
+}
+
+/**
+ * Creates a PHYSFS_Io that reads the given stream on demand.
+ *
+ * When closeio is true, the stream is closed along with the last PHYSFS_Io that uses it, or before returning NULL.
+ *
+ * @internal
+ */
+static PHYSFS_Io* SDL_PhysFS_WrapIOStream(SDL_IOStream* src, Sint64 length, bool closeio) {
+    SDL_PhysFS_IOSource* source = (SDL_PhysFS_IOSource*)SDL_calloc(1, sizeof(SDL_PhysFS_IOSource));
+    if (source == NULL) {
+        if (closeio) {
+            SDL_CloseIO(src);
+        }
+        return NULL;
+    }
+
+    source->io = src;
+    source->length = length;
+    source->closeio = closeio;
+    source->lock = SDL_CreateMutex();
+    PHYSFS_Io* io = source->lock != NULL ? SDL_PhysFS_CreateSourceIo(source, 0) : NULL;
+    if (io == NULL) {
+        if (source->lock != NULL) {
+            SDL_DestroyMutex(source->lock);
+        }
+        SDL_free(source);
+        if (closeio) {
+            SDL_CloseIO(src);
+        }
+        return NULL;
+    }
+
+    return io;
+}
+
+/**
+ * PhysFS memory deletion callback for buffers allocated by SDL.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_FreeMountedMemory(void* mem) {
+    SDL_free(mem);
+}
+
+/**
+ * Mounts the given IOStream as a mount point in PhysFS.
+ *
+ * Seekable streams are read on demand as PhysFS needs them, rather than being
+ * loaded into memory. Streams that cannot report their size are loaded into
+ * memory first, which is released on unmount.
+ *
+ * When closeio is false, src must remain valid until the archive is unmounted
+ * and every file opened from it is closed.
+ *
+ * @param src The IOStream to mount.
+ * @param newDir Filename that can represent this stream.
+ * @param mountPoint The location in the tree that the archive will be mounted.
+ * @param closeio if true, calls SDL_CloseIO() on src once it is unmounted, or before returning in the case of an error.
+ *
+ * @return true on success, false otherwise.
+ *
+ * @see SDL_PhysFS_Mount()
+ * @see SDL_PhysFS_Unmount()
+ */
+SDL_PHYSFS_DEF bool SDL_PhysFS_MountFromIO(SDL_IOStream* src, const char* newDir, const char* mountPoint, bool closeio) {
+    if (src == NULL || newDir == NULL) {
+        if (src != NULL && closeio) {
+            SDL_CloseIO(src);
+        }
+        return SDL_InvalidParamError("src or newDir");
+    }
+
+    // Streams without a known size can't be seeked through, so load them into memory.
+    Sint64 length = SDL_GetIOSize(src);
+    if (length < 0) {
+        size_t dataSize = 0;
+        void* fileData = SDL_LoadFile_IO(src, &dataSize, closeio);
+        if (fileData == NULL) {
+            return false;
+        }
+
+        if (dataSize == 0 || PHYSFS_mountMemory(fileData, (PHYSFS_uint64)dataSize, SDL_PhysFS_FreeMountedMemory, newDir, mountPoint, 1) == 0) {
+            SDL_PhysFS_SetError("Failed to mount stream from memory");
+            SDL_free(fileData);
+            return false;
+        }
+        SDL_PhysFS_ClearPathCache();
+
+        return true;
+    }
+
+    PHYSFS_Io* io = SDL_PhysFS_WrapIOStream(src, length, closeio);
+    if (io == NULL) {
+        return false;
+    }
+
+    // PhysFS takes ownership of io on success, and leaves it to us on failure.
+    if (PHYSFS_mountIo(io, newDir, mountPoint, 1) == 0) {
+        SDL_PhysFS_SetError("Failed to mount stream");
+        io->destroy(io);
+        return false;
+    }
+    SDL_PhysFS_ClearPathCache();
+
+    return true;
+}
+
+/**
+ * Unmounts the given directory or archive.
+ *
+ * @param oldDir The directory that was supplied to MountPhysFS's newDir.
+ *
+ * @return true on success, false otherwise.
+ *
+ * @see SDL_PhysFS_Mount()
+ */
+bool SDL_PhysFS_Unmount(const char* oldDir) {
+    if (PHYSFS_unmount(oldDir) == 0) {
+        SDL_PhysFS_SetError("Failed to unmount old directory");
+        return false;
+    }
+    SDL_LockSpinlock(&SDL_PhysFS_mountedPaths.lock);
+    SDL_PhysFS_HashRemove(&SDL_PhysFS_mountedPaths.table, oldDir, SDL_PhysFS_Hash(oldDir));
+    SDL_UnlockSpinlock(&SDL_PhysFS_mountedPaths.lock);
+    SDL_PhysFS_ClearPathCache();
+
+    return true;
+}
+
+// Stream properties for finding SDL_PhysFS's state behind a SDL_IOStream.
+#define SDL_PHYSFS_PROP_IOSTREAM_STATE "SDL_PhysFS.state"
+#define SDL_PHYSFS_PROP_IOSTREAM_CACHED_FILE "SDL_PhysFS.cachedFile"
+
+/**
+ * The state of a SDL_IOStream created by SDL_PhysFS_OpenIO().
+ *
+ * The position and length are tracked here, so SDL_TellIO() and SDL_GetIOSize() don't reach the archiver.
+ *
+ * With a rewind window, the most recently read bytes are kept in a ring
+ * buffer indexed by file offset. The stream's position can then trail the
+ * handle's position, with reads served from the ring until they catch up.
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_IOState {
+    PHYSFS_File* handle;
+    Sint64 position;
+    Sint64 handlePosition;
+    Sint64 length;
+    bool skipForward;
+    Uint8* history;
+    size_t historySize;
+    size_t historyFilled;
+} SDL_PhysFS_IOState;
+
+/**
+ * Sets up the state for a stream, with the length left unknown until it's needed.
+ *
+ * @param skipForward Whether short forward seeks are read through. Only for files opened for reading.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_InitIOState(SDL_PhysFS_IOState* state, PHYSFS_File* handle, bool skipForward) {
+    PHYSFS_sint64 position = PHYSFS_tell(handle);
+    state->handle = handle;
+    state->position = position > 0 ? (Sint64)position : 0;
+    state->handlePosition = state->position;
+    state->length = -1;
+    state->skipForward = skipForward;
+    state->history = NULL;
+    state->historySize = 0;
+    state->historyFilled = 0;
+}
+
+/**
+ * Copies bytes read from the handle into the rewind window, before the handle's position is advanced past them.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_AppendHistory(SDL_PhysFS_IOState* state, const Uint8* data, size_t size) {
+    if (state->history == NULL || size == 0) {
+        return;
+    }
+
+    // Only the last historySize bytes can be kept.
+    Uint64 offset = (Uint64)state->handlePosition;
+    if (size > state->historySize) {
+        offset += size - state->historySize;
+        data += size - state->historySize;
+        size = state->historySize;
+    }
+
+    size_t index = (size_t)(offset % state->historySize);
+    size_t first = SDL_min(size, state->historySize - index);
+    SDL_memcpy(state->history + index, data, first);
+    SDL_memcpy(state->history, data + first, size - first);
+
+    state->historyFilled = SDL_min(state->historyFilled + size, state->historySize);
+}
+
+/**
+ * Reads from the rewind window while the stream's position trails the handle's.
+ *
+ * @return The number of bytes copied. Fewer than size only once the position has caught up with the handle.
+ *
+ * @internal
+ */
+static size_t SDL_PhysFS_ReadHistory(SDL_PhysFS_IOState* state, Uint8* ptr, size_t size) {
+    if (state->position >= state->handlePosition) {
+        return 0;
+    }
+
+    size_t count = SDL_min(size, (size_t)(state->handlePosition - state->position));
+    size_t index = (size_t)((Uint64)state->position % state->historySize);
+    size_t first = SDL_min(count, state->historySize - index);
+    SDL_memcpy(ptr, state->history + index, first);
+    SDL_memcpy(ptr + first, state->history, count - first);
+    state->position += (Sint64)count;
+
+    return count;
+}
+
+/**
+ * Moves the handle to the stream's position, if a rewind left it behind. The rewind window is kept.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_SyncHandlePosition(SDL_PhysFS_IOState* state) {
+    if (state->handlePosition == state->position) {
+        return true;
+    }
+
+    if (!PHYSFS_seek(state->handle, (PHYSFS_uint64)state->position)) {
+        return false;
+    }
+    state->handlePosition = state->position;
+    state->historyFilled = 0;
+
+    return true;
+}
+
+/**
+ * SDL_IOStream callback: size.
+ *
+ * @internal
+ */
+Sint64 SDLCALL SDL_PhysFS_GetIOSize(void *userdata) {
+    SDL_PhysFS_IOState* state = (SDL_PhysFS_IOState*)userdata;
+    if (state == NULL) {
+        return 0;
+    }
+
+    if (state->length < 0) {
+        state->length = (Sint64) PHYSFS_fileLength(state->handle);
+    }
+
+    return state->length;
+}
+
+/**
+ * SDL_IOStream callback: seek.
+ *
+ * @internal
+ */
+Sint64 SDLCALL SDL_PhysFS_SeekIO(void *userdata, Sint64 offset, SDL_IOWhence whence) {
+    SDL_PhysFS_IOState* state = (SDL_PhysFS_IOState*)userdata;
+    Sint64 pos = 0;
+
+    if (whence == SDL_IO_SEEK_SET) {
+        pos = offset;
+    }
+    else if (whence == SDL_IO_SEEK_CUR) {
+        if (offset == 0) {
+            return state->position;
+        }
+
+        pos = state->position + offset;
+    }
+    else if (whence == SDL_IO_SEEK_END) {
+        const Sint64 len = SDL_PhysFS_GetIOSize(state);
+        if (len == -1) {
+            SDL_PhysFS_SetError("Cannot find end of file");
+            return -1;
+        }
+
+        pos = len + offset;
+    }
+    else {
+        SDL_PhysFS_SetError("Invalid 'whence' parameter");
+        return -1;
+    }
+
+    if (pos < 0) {
+        SDL_PhysFS_SetError("Attempt to seek past start of file");
+        return -1;
+    }
+
+    if (pos == state->position) {
+        return pos;
+    }
+
+    // Seeks within the rewind window don't touch the handle.
+    if (pos <= state->handlePosition && state->handlePosition - pos <= (Sint64)state->historyFilled) {
+        state->position = pos;
+        return pos;
+    }
+
+    // Short forward seeks, like decoders skipping chunks, are read through
+    // PhysFS's read buffer, instead of discarding it and seeking the archiver.
+    if (state->skipForward && pos > state->handlePosition && pos - state->handlePosition <= SDL_PHYSFS_SEEK_SKIP_LIMIT) {
+        Uint8 skipped[SDL_PHYSFS_SEEK_SKIP_LIMIT];
+        PHYSFS_sint64 rc = PHYSFS_readBytes(state->handle, skipped, (PHYSFS_uint64)(pos - state->handlePosition));
+        if (rc > 0) {
+            SDL_PhysFS_AppendHistory(state, skipped, (size_t)rc);
+            state->handlePosition += (Sint64)rc;
+        }
+        state->position = state->handlePosition;
+        if (state->position == pos) {
+            return pos;
+        }
+    }
+
+    if (!PHYSFS_seek(state->handle, (PHYSFS_uint64)pos)) {
+        SDL_PhysFS_SetError("Failed to seek in file");
+        return -1;
+    }
+    state->position = pos;
+    state->handlePosition = pos;
+    state->historyFilled = 0;
+
+    return pos;
+}
+
+/**
+ * SDL_IOStream callback: read.
+ *
+ * @internal
+ */
+size_t SDLCALL SDL_PhysFS_ReadIO(void *userdata, void *ptr, size_t size, SDL_IOStatus *status) {
+    SDL_PhysFS_IOState* state = (SDL_PhysFS_IOState*)userdata;
+    size_t copied = 0;
+    if (state->history != NULL) {
+        copied = SDL_PhysFS_ReadHistory(state, (Uint8*)ptr, size);
+        if (copied == size) {
+            return copied;
+        }
+    }
+
+    PHYSFS_sint64 rc = PHYSFS_readBytes(state->handle, (Uint8*)ptr + copied, (PHYSFS_uint64)(size - copied));
+    if (rc <= 0) {
+        if (copied == 0) {
+            *status = SDL_PhysFS_IOStatus(PHYSFS_getLastErrorCode());
+        }
+        rc = 0;
+    }
+    SDL_PhysFS_AppendHistory(state, (Uint8*)ptr + copied, (size_t)rc);
+    state->position += (Sint64)rc;
+    state->handlePosition = state->position;
+
+    return copied + (size_t)rc;
+}
+
+/**
+ * SDL_IOStream callback: write.
+ *
+ * @internal
+ */
+size_t SDLCALL SDL_PhysFS_WriteIO(void *userdata, const void *ptr, size_t size, SDL_IOStatus *status) {
+    SDL_PhysFS_IOState* state = (SDL_PhysFS_IOState*)userdata;
+    PHYSFS_sint64 wc;
+
+    if (state == NULL) {
+        return 0;
+    }
+
+    // Writing replaces what the rewind window holds, so it starts over.
+    if (!SDL_PhysFS_SyncHandlePosition(state)) {
+        SDL_PhysFS_SetError("Failed to seek in file");
+        if (status) {
+            *status = SDL_IO_STATUS_ERROR;
+        }
+        return 0;
+    }
+    state->historyFilled = 0;
+
+    wc = PHYSFS_writeBytes(state->handle, ptr, (PHYSFS_uint64)size);
+    if (wc < 0) {
+        SDL_PhysFS_SetError("Failed to write file");
+        if (status) {
+            *status = SDL_PhysFS_IOStatus(PHYSFS_getLastErrorCode());
+        }
+        wc = 0;
+    }
+
+    state->position += (Sint64)wc;
+    state->handlePosition = state->position;
+    if (state->length >= 0 && state->position > state->length) {
+        state->length = state->position;
+    }
+
+    return (size_t)wc;
+}
+
+/**
+ * SDL_IOStream callback: flush.
+ *
+ * @internal
+ */
+bool SDLCALL SDL_PhysFS_FlushIO(void *userdata, SDL_IOStatus *status) {
+    SDL_PhysFS_IOState* state = (SDL_PhysFS_IOState*)userdata;
+    if (state == NULL) {
+        return false;
+    }
+
+    if (PHYSFS_flush(state->handle) != 0) {
+        return true;
+    }
+
+    if (status != NULL) {
+        *status = SDL_PhysFS_IOStatus(PHYSFS_getLastErrorCode());
+    }
+
+    return false;
+}
+
+/**
+ * Closes the file behind a stream's state, without freeing the state.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_CloseIOState(SDL_PhysFS_IOState* state) {
+    if (state == NULL || state->handle == NULL) {
+        return false;
+    }
+
+    SDL_free(state->history);
+    state->history = NULL;
+
+    if (!PHYSFS_close(state->handle)) {
+        SDL_PhysFS_SetError("Failed to close file");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * SDL_IOStream callback: close.
+ *
+ * @internal
+ */
+bool SDLCALL SDL_PhysFS_CloseIO(void *userdata) {
+    SDL_PhysFS_IOState* state = (SDL_PhysFS_IOState*)userdata;
+    bool result = SDL_PhysFS_CloseIOState(state);
+    SDL_free(state);
+
+    return result;
+}
+
+/**
+ * Creates a SDL_IOStream with its own state for the given PHYSFS_File. The handle isn't closed on failure.
+ *
+ * @internal
+ */
+static SDL_IOStream* SDL_PhysFS_OpenStateIO(PHYSFS_File* handle, bool skipForward) {
+    SDL_PhysFS_IOState* state = (SDL_PhysFS_IOState*)SDL_malloc(sizeof(SDL_PhysFS_IOState));
+    if (state == NULL) {
+        return NULL;
+    }
+    SDL_PhysFS_InitIOState(state, handle, skipForward);
+
+    SDL_IOStreamInterface iface;
+    SDL_INIT_INTERFACE(&iface);
+    iface.size = SDL_PhysFS_GetIOSize;
+    iface.seek  = SDL_PhysFS_SeekIO;
+    iface.read  = SDL_PhysFS_ReadIO;
+    iface.write = SDL_PhysFS_WriteIO;
+    iface.flush = SDL_PhysFS_FlushIO;
+    iface.close = SDL_PhysFS_CloseIO;
+    SDL_IOStream* io = SDL_OpenIO(&iface, state);
+    if (io == NULL) {
+        SDL_free(state);
+        return NULL;
+    }
+    SDL_SetPointerProperty(SDL_GetIOProperties(io), SDL_PHYSFS_PROP_IOSTREAM_STATE, state);
+
+    return io;
+}
+
+/**
+ * Creates a SDL_IOStream based on the given PHYSFS_File.
+ *
+ * The stream keeps track of its position and length, so SDL_TellIO() and
+ * SDL_GetIOSize() are answered without calling into PhysFS. Don't use the
+ * handle directly while the stream is open.
+ */
+SDL_IOStream *SDL_PhysFS_OpenIO(PHYSFS_File *handle) {
+    if (handle == NULL) {
+        SDL_InvalidParamError("handle");
+        return NULL;
+    }
+
+    return SDL_PhysFS_OpenStateIO(handle, false);
+}
+
+#ifdef SDL_PHYSFS_STATS
+/**
+ * A stream whose reads and seeks are counted, wrapping the plain SDL_IOStream callbacks.
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_TracedFile {
+    SDL_PhysFS_IOState state;
+    SDL_PhysFS_Counters* file;
+    SDL_PhysFS_Counters* mount;
+    char* filename;
+} SDL_PhysFS_TracedFile;
+
+static Sint64 SDLCALL SDL_PhysFS_TracedGetIOSize(void* userdata) {
+    return SDL_PhysFS_GetIOSize(&((SDL_PhysFS_TracedFile*)userdata)->state);
+}
+
+static Sint64 SDLCALL SDL_PhysFS_TracedSeekIO(void* userdata, Sint64 offset, SDL_IOWhence whence) {
+    SDL_PhysFS_TracedFile* traced = (SDL_PhysFS_TracedFile*)userdata;
+    Uint64 start = SDL_GetTicksNS();
+    Sint64 result = SDL_PhysFS_SeekIO(&traced->state, offset, whence);
+
+    // SDL_TellIO() seeks by nothing, which isn't worth counting.
+    if (whence != SDL_IO_SEEK_CUR || offset != 0) {
+        SDL_PhysFS_StatsRecord(traced->file, traced->mount, SDL_PHYSFS_TRACE_SEEK, traced->filename, start, result);
+    }
+
+    return result;
+}
+
+static size_t SDLCALL SDL_PhysFS_TracedReadIO(void* userdata, void* ptr, size_t size, SDL_IOStatus* status) {
+    SDL_PhysFS_TracedFile* traced = (SDL_PhysFS_TracedFile*)userdata;
+    Uint64 start = SDL_GetTicksNS();
+    size_t result = SDL_PhysFS_ReadIO(&traced->state, ptr, size, status);
+    SDL_PhysFS_StatsRecord(traced->file, traced->mount, SDL_PHYSFS_TRACE_READ, traced->filename, start, (Sint64)result);
+
+    return result;
+}
+
+static size_t SDLCALL SDL_PhysFS_TracedWriteIO(void* userdata, const void* ptr, size_t size, SDL_IOStatus* status) {
+    return SDL_PhysFS_WriteIO(&((SDL_PhysFS_TracedFile*)userdata)->state, ptr, size, status);
+}
+
+static bool SDLCALL SDL_PhysFS_TracedFlushIO(void* userdata, SDL_IOStatus* status) {
+    return SDL_PhysFS_FlushIO(&((SDL_PhysFS_TracedFile*)userdata)->state, status);
+}
+
+static bool SDLCALL SDL_PhysFS_TracedCloseIO(void* userdata) {
+    SDL_PhysFS_TracedFile* traced = (SDL_PhysFS_TracedFile*)userdata;
+    Uint64 start = SDL_GetTicksNS();
+    bool result = SDL_PhysFS_CloseIOState(&traced->state);
+    SDL_PhysFS_StatsRecord(traced->file, traced->mount, SDL_PHYSFS_TRACE_CLOSE, traced->filename, start, 0);
+    SDL_free(traced->filename);
+    SDL_free(traced);
+
+    return result;
+}
+
+/**
+ * Creates a SDL_IOStream for the given PHYSFS_File, counting its I/O against the file and its mount.
+ *
+ * @param start When opening the file started, from SDL_GetTicksNS().
+ *
+ * @internal
+ */
+static SDL_IOStream* SDL_PhysFS_OpenTracedIO(PHYSFS_File* handle, const char* filename, Uint64 start) {
+    SDL_PhysFS_TracedFile* traced = (SDL_PhysFS_TracedFile*)SDL_calloc(1, sizeof(SDL_PhysFS_TracedFile));
+    if (traced == NULL || (traced->filename = SDL_strdup(filename)) == NULL) {
+        SDL_free(traced);
+        PHYSFS_close(handle);
+        return NULL;
+    }
+    SDL_PhysFS_InitIOState(&traced->state, handle, true);
+    SDL_PhysFS_StatsLookup(filename, SDL_PhysFS_GetRealDir(filename), &traced->file, &traced->mount);
+
+    SDL_IOStreamInterface iface;
+    SDL_INIT_INTERFACE(&iface);
+    iface.size = SDL_PhysFS_TracedGetIOSize;
+    iface.seek = SDL_PhysFS_TracedSeekIO;
+    iface.read = SDL_PhysFS_TracedReadIO;
+    iface.write = SDL_PhysFS_TracedWriteIO;
+    iface.flush = SDL_PhysFS_TracedFlushIO;
+    iface.close = SDL_PhysFS_TracedCloseIO;
+    SDL_IOStream* io = SDL_OpenIO(&iface, traced);
+    if (io == NULL) {
+        SDL_free(traced->filename);
+        SDL_free(traced);
+        PHYSFS_close(handle);
+        return NULL;
+    }
+
+    SDL_SetPointerProperty(SDL_GetIOProperties(io), SDL_PHYSFS_PROP_IOSTREAM_STATE, &traced->state);
+    SDL_PhysFS_StatsRecord(traced->file, traced->mount, SDL_PHYSFS_TRACE_OPEN, filename, start, 0);
+    return io;
+}
+#endif
+
+/**
+ * The files opened while recording, in the order they were first opened.
+ *
+ * @internal
+ */
+static struct {
+    SDL_SpinLock lock;
+    SDL_AtomicInt recording;
+    SDL_PhysFS_HashTable seen;
+    const char** paths;
+    int count;
+    int capacity;
+} SDL_PhysFS_accessLog = { 0, { 0 }, { NULL, 0, 0 }, NULL, 0, 0 };
+
+/**
+ * Adds a file to the access manifest being recorded, the first time it's opened.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_RecordAccess(const char* filename) {
+    if (SDL_GetAtomicInt(&SDL_PhysFS_accessLog.recording) == 0) {
+        return;
+    }
+
+    Uint32 hash = SDL_PhysFS_Hash(filename);
+    SDL_LockSpinlock(&SDL_PhysFS_accessLog.lock);
+    if (SDL_GetAtomicInt(&SDL_PhysFS_accessLog.recording) != 0 && SDL_PhysFS_HashFind(&SDL_PhysFS_accessLog.seen, filename, hash) == NULL) {
+        if (SDL_PhysFS_accessLog.count == SDL_PhysFS_accessLog.capacity) {
+            int capacity = SDL_PhysFS_accessLog.capacity > 0 ? SDL_PhysFS_accessLog.capacity * 2 : 64;
+            const char** paths = (const char**)SDL_realloc((void*)SDL_PhysFS_accessLog.paths, sizeof(const char*) * (size_t)capacity);
+            if (paths != NULL) {
+                SDL_PhysFS_accessLog.paths = paths;
+                SDL_PhysFS_accessLog.capacity = capacity;
+            }
+        }
+
+        // The path is kept as the key of its entry in the table.
+        SDL_PhysFS_HashEntry* entry = SDL_PhysFS_accessLog.count < SDL_PhysFS_accessLog.capacity ?
+            SDL_PhysFS_HashInsert(&SDL_PhysFS_accessLog.seen, filename, hash, NULL) : NULL;
+        if (entry != NULL) {
+            SDL_PhysFS_accessLog.paths[SDL_PhysFS_accessLog.count++] = entry->key;
+        }
+    }
+    SDL_UnlockSpinlock(&SDL_PhysFS_accessLog.lock);
+}
+
+/**
+ * Starts recording the files that are opened, for SDL_PhysFS_Prefetch() to warm up on a later run.
+ *
+ * Each file opened with SDL_PhysFS_IOFromFile(), SDL_PhysFS_LoadFile(),
+ * SDL_PhysFS_AcquireFile(), or the functions built on them, is recorded the
+ * first time it's opened. Any previous recording is discarded.
+ *
+ * @see SDL_PhysFS_StopAccessRecording()
+ */
+void SDL_PhysFS_StartAccessRecording(void) {
+    SDL_LockSpinlock(&SDL_PhysFS_accessLog.lock);
+    SDL_PhysFS_HashClear(&SDL_PhysFS_accessLog.seen);
+    SDL_PhysFS_accessLog.count = 0;
+    SDL_SetAtomicInt(&SDL_PhysFS_accessLog.recording, 1);
+    SDL_UnlockSpinlock(&SDL_PhysFS_accessLog.lock);
+}
+
+/**
+ * Stops recording the files that are opened, and writes them to a manifest.
+ *
+ * The manifest is a text file with one path per line, in the order the files
+ * were first opened.
+ *
+ * @param manifest The filename to write the manifest to in the write directory, or NULL to discard the recording.
+ *
+ * @return true on success, false otherwise. Use SDL_GetError() for details.
+ *
+ * @see SDL_PhysFS_StartAccessRecording()
+ * @see SDL_PhysFS_Prefetch()
+ */
+bool SDL_PhysFS_StopAccessRecording(const char* manifest) {
+    // The recording is detached under the lock, so a concurrent start or open can't change it while it's written.
+    SDL_LockSpinlock(&SDL_PhysFS_accessLog.lock);
+    SDL_SetAtomicInt(&SDL_PhysFS_accessLog.recording, 0);
+    SDL_PhysFS_HashTable seen = SDL_PhysFS_accessLog.seen;
+    const char** paths = SDL_PhysFS_accessLog.paths;
+    int count = SDL_PhysFS_accessLog.count;
+    SDL_zero(SDL_PhysFS_accessLog.seen);
+    SDL_PhysFS_accessLog.paths = NULL;
+    SDL_PhysFS_accessLog.count = 0;
+    SDL_PhysFS_accessLog.capacity = 0;
+    SDL_UnlockSpinlock(&SDL_PhysFS_accessLog.lock);
+
+    bool result = true;
+    if (manifest != NULL) {
+        size_t size = 0;
+        for (int i = 0; i < count; i++) {
+            size += SDL_strlen(paths[i]) + 1;
+        }
+
+        char* text = (char*)SDL_malloc(size + 1);
+        result = text != NULL;
+        if (result) {
+            char* position = text;
+            for (int i = 0; i < count; i++) {
+                size_t length = SDL_strlen(paths[i]);
+                SDL_memcpy(position, paths[i], length);
+                position[length] = '\n';
+                position += length + 1;
+            }
+
+            // An empty recording still writes an empty manifest.
+            *position = '\n';
+            result = SDL_PhysFS_WriteFile(manifest, text, size > 0 ? size : 1) > 0;
+            SDL_free(text);
+        }
+    }
+
+    SDL_PhysFS_HashClear(&seen);
+    SDL_free((void*)paths);
+
+    return result;
+}
+
+/**
+ * A whole file's contents, shared between the content cache and everyone using it.
+ *
+ * The data follows the header, with a null terminator after it.
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_CachedFile {
+    SDL_AtomicInt refcount;
+    size_t size;
+    const char* key;
+    Uint32 hash;
+    struct SDL_PhysFS_CachedFile* newer;
+    struct SDL_PhysFS_CachedFile* older;
+} SDL_PhysFS_CachedFile;
+
+// Keeps the data after the header aligned for any type.
+#define SDL_PHYSFS_CACHED_FILE_HEADER ((sizeof(SDL_PhysFS_CachedFile) + 15) & ~(size_t)15)
+
+/**
+ * Recently loaded files by virtual path, with the most recently used first, up to a byte budget.
+ *
+ * The budget is only read under the lock. Loads check enabled, which is set
+ * along with it, to skip the lock when the cache is disabled.
+ *
+ * @internal
+ */
+static struct {
+    SDL_SpinLock lock;
+    SDL_AtomicInt enabled;
+    size_t budget;
+    size_t used;
+    SDL_PhysFS_HashTable table;
+    SDL_PhysFS_CachedFile* newest;
+    SDL_PhysFS_CachedFile* oldest;
+    Uint32 generation;
+} SDL_PhysFS_contentCache = { 0, { 0 }, 0, 0, { NULL, 0, 0 }, NULL, NULL, 0 };
+
+/**
+ * Checks whether the content cache has a budget, without taking its lock.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_ContentCacheEnabled(void) {
+    return SDL_GetAtomicInt(&SDL_PhysFS_contentCache.enabled) != 0;
+}
+
+static void* SDL_PhysFS_CachedFileData(SDL_PhysFS_CachedFile* cached) {
+    return (Uint8*)cached + SDL_PHYSFS_CACHED_FILE_HEADER;
+}
+
+static void SDL_PhysFS_ReleaseCachedFile(SDL_PhysFS_CachedFile* cached) {
+    if (SDL_AtomicDecRef(&cached->refcount)) {
+        SDL_free(cached);
+    }
+}
+
+/**
+ * Property cleanup for streams that read from a cached file.
+ *
+ * @internal
+ */
+static void SDLCALL SDL_PhysFS_CachedFileCleanup(void* userdata, void* value) {
+    (void)userdata;
+    SDL_PhysFS_ReleaseCachedFile((SDL_PhysFS_CachedFile*)value);
+}
+
+/**
+ * Takes a file out of the content cache's recently used list. The content cache lock must be held.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_ContentCacheDetach(SDL_PhysFS_CachedFile* cached) {
+    if (cached->newer != NULL) {
+        cached->newer->older = cached->older;
+    }
+    else {
+        SDL_PhysFS_contentCache.newest = cached->older;
+    }
+    if (cached->older != NULL) {
+        cached->older->newer = cached->newer;
+    }
+    else {
+        SDL_PhysFS_contentCache.oldest = cached->newer;
+    }
+}
+
+/**
+ * Removes a file from the content cache, dropping the cache's reference. The content cache lock must be held.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_ContentCacheUnlink(SDL_PhysFS_CachedFile* cached) {
+    SDL_PhysFS_ContentCacheDetach(cached);
+    SDL_PhysFS_HashRemove(&SDL_PhysFS_contentCache.table, cached->key, cached->hash);
+    cached->key = NULL;
+    SDL_PhysFS_contentCache.used -= cached->size;
+    SDL_PhysFS_ReleaseCachedFile(cached);
+}
+
+/**
+ * Makes a file the most recently used. The content cache lock must be held.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_ContentCacheLinkNewest(SDL_PhysFS_CachedFile* cached) {
+    cached->newer = NULL;
+    cached->older = SDL_PhysFS_contentCache.newest;
+    if (SDL_PhysFS_contentCache.newest != NULL) {
+        SDL_PhysFS_contentCache.newest->newer = cached;
+    }
+    else {
+        SDL_PhysFS_contentCache.oldest = cached;
+    }
+    SDL_PhysFS_contentCache.newest = cached;
+}
+
+/**
+ * Evicts the least recently used files until the cache is within its budget. The content cache lock must be held.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_ContentCacheTrim(void) {
+    while (SDL_PhysFS_contentCache.used > SDL_PhysFS_contentCache.budget && SDL_PhysFS_contentCache.oldest != NULL) {
+        SDL_PhysFS_ContentCacheUnlink(SDL_PhysFS_contentCache.oldest);
+    }
+}
+
+/**
+ * Sets up a newly loaded SDL_PhysFS_CachedFile, with a single reference and not yet in the cache.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_InitCachedFile(SDL_PhysFS_CachedFile* cached, size_t size) {
+    SDL_SetAtomicInt(&cached->refcount, 1);
+    cached->size = size;
+    cached->key = NULL;
+    cached->hash = 0;
+    cached->newer = NULL;
+    cached->older = NULL;
+}
+
+static void* SDL_PhysFS_ParallelLoadFile(const char* filename, size_t header, size_t maxSize, size_t* datasize);
+
+/**
+ * Reads and closes an open file into a new, uncached, SDL_PhysFS_CachedFile.
+ *
+ * @return The file with a single reference, or NULL on failure.
+ *
+ * @internal
+ */
+static SDL_PhysFS_CachedFile* SDL_PhysFS_ReadCachedFile(PHYSFS_File* handle) {
+    PHYSFS_sint64 length = PHYSFS_fileLength(handle);
+    SDL_PhysFS_CachedFile* cached = length < 0 ? NULL : (SDL_PhysFS_CachedFile*)SDL_malloc(SDL_PHYSFS_CACHED_FILE_HEADER + (size_t)length + 1);
+    if (cached == NULL) {
+        PHYSFS_close(handle);
+        return NULL;
+    }
+
+    Uint8* data = (Uint8*)SDL_PhysFS_CachedFileData(cached);
+    if (PHYSFS_readBytes(handle, data, (PHYSFS_uint64)length) != length) {
+        SDL_free(cached);
+        PHYSFS_close(handle);
+        return NULL;
+    }
+    PHYSFS_close(handle);
+
+    data[length] = '\0';
+    SDL_PhysFS_InitCachedFile(cached, (size_t)length);
+    return cached;
+}
+
+/**
+ * Finds a file in the content cache, or loads it and adds it to the cache.
+ *
+ * Files larger than a quarter of the budget aren't cached. For those, the
+ * opened file is passed back through handle for the caller to read itself.
+ *
+ * @return A reference to the cached file, to release with SDL_PhysFS_ReleaseCachedFile(), or NULL if it isn't cached or fails to load.
+ *
+ * @internal
+ */
+static SDL_PhysFS_CachedFile* SDL_PhysFS_ContentCacheLoad(const char* filename, PHYSFS_File** handle) {
+    *handle = NULL;
+    Uint32 hash = SDL_PhysFS_Hash(filename);
+    SDL_LockSpinlock(&SDL_PhysFS_contentCache.lock);
+    SDL_PhysFS_HashEntry* entry = SDL_PhysFS_HashFind(&SDL_PhysFS_contentCache.table, filename, hash);
+    if (entry != NULL) {
+        SDL_PhysFS_CachedFile* cached = (SDL_PhysFS_CachedFile*)entry->value;
+        SDL_AtomicIncRef(&cached->refcount);
+        if (SDL_PhysFS_contentCache.newest != cached) {
+            SDL_PhysFS_ContentCacheDetach(cached);
+            SDL_PhysFS_ContentCacheLinkNewest(cached);
+        }
+        SDL_UnlockSpinlock(&SDL_PhysFS_contentCache.lock);
+#ifdef SDL_PHYSFS_STATS
+        SDL_PhysFS_StatsContentCacheHit(filename, SDL_PhysFS_GetRealDir(filename));
+#endif
+        return cached;
+    }
+    Uint32 generation = SDL_PhysFS_contentCache.generation;
+    size_t limit = SDL_PhysFS_contentCache.budget / 4;
+    SDL_UnlockSpinlock(&SDL_PhysFS_contentCache.lock);
+
+    // Load the file outside of the lock, in parallel when it can be.
+    size_t size;
+    SDL_PhysFS_CachedFile* cached = (SDL_PhysFS_CachedFile*)SDL_PhysFS_ParallelLoadFile(filename, SDL_PHYSFS_CACHED_FILE_HEADER, limit, &size);
+    if (cached != NULL) {
+        SDL_PhysFS_InitCachedFile(cached, size);
+    }
+    else {
+        PHYSFS_File* file = SDL_PhysFS_IsKnownMissing(filename) ? NULL : PHYSFS_openRead(filename);
+        if (file == NULL) {
+            return NULL;
+        }
+        PHYSFS_sint64 length = PHYSFS_fileLength(file);
+        if (length < 0 || (PHYSFS_uint64)length > limit) {
+            *handle = file;
+            return NULL;
+        }
+        cached = SDL_PhysFS_ReadCachedFile(file);
+        if (cached == NULL) {
+            return NULL;
+        }
+    }
+
+    // Skip caching if the search path or files changed while it was loading.
+    SDL_LockSpinlock(&SDL_PhysFS_contentCache.lock);
+    if (generation == SDL_PhysFS_contentCache.generation && cached->size <= SDL_PhysFS_contentCache.budget / 4 &&
+        SDL_PhysFS_HashFind(&SDL_PhysFS_contentCache.table, filename, hash) == NULL) {
+        entry = SDL_PhysFS_HashInsert(&SDL_PhysFS_contentCache.table, filename, hash, cached);
+        if (entry != NULL) {
+            SDL_AtomicIncRef(&cached->refcount);
+            cached->key = entry->key;
+            cached->hash = hash;
+            SDL_PhysFS_ContentCacheLinkNewest(cached);
+            SDL_PhysFS_contentCache.used += cached->size;
+            SDL_PhysFS_ContentCacheTrim();
+        }
+    }
+    SDL_UnlockSpinlock(&SDL_PhysFS_contentCache.lock);
+
+    return cached;
+}
+
+/**
+ * Sets the byte budget of the content cache.
+ *
+ * Assets that are loaded over and over, such as UI atlases, fonts and sound
+ * effects, pay the full cost of decompressing them from an archive each time.
+ * The content cache keeps recently loaded files in memory, so the next
+ * SDL_PhysFS_LoadFile() copies them from memory, and SDL_PhysFS_IOFromFile()
+ * and SDL_PhysFS_AcquireFile() read them in place. When it's full, the least
+ * recently used files are evicted.
+ *
+ * Files larger than a quarter of the budget aren't cached. The cache is
+ * emptied whenever something is mounted, unmounted or written.
+ *
+ * The cache is disabled by default.
+ *
+ * @param maxBytes The most file data to keep in memory, or 0 to disable the cache.
+ *
+ * @see SDL_PhysFS_ClearContentCache()
+ * @see SDL_PhysFS_AcquireFile()
+ */
+void SDL_PhysFS_SetContentCacheSize(size_t maxBytes) {
+    SDL_LockSpinlock(&SDL_PhysFS_contentCache.lock);
+    SDL_PhysFS_contentCache.budget = maxBytes;
+    SDL_SetAtomicInt(&SDL_PhysFS_contentCache.enabled, maxBytes > 0 ? 1 : 0);
+    SDL_PhysFS_ContentCacheTrim();
+    SDL_UnlockSpinlock(&SDL_PhysFS_contentCache.lock);
+}
+
+/**
+ * Evicts every file from the content cache.
+ *
+ * Files that are still in use remain valid until they're released or closed.
+ *
+ * @see SDL_PhysFS_SetContentCacheSize()
+ */
+void SDL_PhysFS_ClearContentCache(void) {
+    SDL_LockSpinlock(&SDL_PhysFS_contentCache.lock);
+    while (SDL_PhysFS_contentCache.oldest != NULL) {
+        SDL_PhysFS_ContentCacheUnlink(SDL_PhysFS_contentCache.oldest);
+    }
+    SDL_PhysFS_HashClear(&SDL_PhysFS_contentCache.table);
+    SDL_PhysFS_contentCache.generation++;
+    SDL_UnlockSpinlock(&SDL_PhysFS_contentCache.lock);
+}
+
+/**
+ * Loads all the file data from a given filename, sharing it with the content cache.
+ *
+ * When the file is in the content cache, the cached copy is returned without
+ * reading or copying anything. The data is null terminated, and must not be
+ * modified.
+ *
+ * @param filename The name of the file to load.
+ * @param datasize Where to put the resulting size of the file.
+ *
+ * @return The file data, which must be released with SDL_PhysFS_ReleaseFile(). NULL on failure, use SDL_GetError() for details.
+ *
+ * @see SDL_PhysFS_ReleaseFile()
+ * @see SDL_PhysFS_SetContentCacheSize()
+ */
+const void* SDL_PhysFS_AcquireFile(const char* filename, size_t* datasize) {
+    if (datasize != NULL) {
+        *datasize = 0;
+    }
+    if (filename == NULL) {
+        SDL_InvalidParamError("filename");
+        return NULL;
+    }
+
+    PHYSFS_File* handle = NULL;
+    SDL_PhysFS_CachedFile* cached = NULL;
+    if (SDL_PhysFS_ContentCacheEnabled()) {
+        cached = SDL_PhysFS_ContentCacheLoad(filename, &handle);
+    }
+    else {
+        handle = SDL_PhysFS_IsKnownMissing(filename) ? NULL : PHYSFS_openRead(filename);
+    }
+    if (cached == NULL && handle != NULL) {
+        cached = SDL_PhysFS_ReadCachedFile(handle);
+    }
+    if (cached == NULL) {
+        SDL_PhysFS_SetError("Failed to load file");
+        return NULL;
+    }
+    SDL_PhysFS_RecordAccess(filename);
+
+    if (datasize != NULL) {
+        *datasize = cached->size;
+    }
+    return SDL_PhysFS_CachedFileData(cached);
+}
+
+/**
+ * Releases file data from SDL_PhysFS_AcquireFile().
+ *
+ * @param data The file data to release.
+ *
+ * @see SDL_PhysFS_AcquireFile()
+ */
+void SDL_PhysFS_ReleaseFile(const void* data) {
+    if (data != NULL) {
+        SDL_PhysFS_ReleaseCachedFile((SDL_PhysFS_CachedFile*)((const Uint8*)data - SDL_PHYSFS_CACHED_FILE_HEADER));
+    }
+}
+
+/**
+ * Finds the default read buffer size for an open file, based on whether it lives in a directory or an archive.
+ *
+ * This is only done once the file has been opened, and isn't needed for files from the content cache.
+ *
+ * @internal
+ */
+static size_t SDL_PhysFS_DefaultBufferSize(const char* filename) {
+    const char* realDir = SDL_PhysFS_GetRealDir(filename);
+    if (realDir != NULL && SDL_PhysFS_GetMountedPathType(realDir) == SDL_PATHTYPE_DIRECTORY) {
+        return SDL_PHYSFS_DIRECTORY_BUFFER_SIZE;
+    }
+
+    return SDL_PHYSFS_ARCHIVE_BUFFER_SIZE;
+}
+
+/**
+ * Opens a file for SDL_PhysFS_IOFromFile() and SDL_PhysFS_IOFromFileEx(), choosing the default buffer size once it's open if asked to.
+ *
+ * @internal
+ */
+static SDL_IOStream* SDL_PhysFS_OpenBufferedIO(const char* filename, size_t bufferSize, bool defaultBufferSize) {
+#ifdef SDL_PHYSFS_STATS
+    Uint64 start = SDL_GetTicksNS();
+#endif
+    // Serve cached files from memory.
+    PHYSFS_File* handle = NULL;
+    if (filename != NULL && SDL_PhysFS_ContentCacheEnabled()) {
+        SDL_PhysFS_CachedFile* cached = SDL_PhysFS_ContentCacheLoad(filename, &handle);
+        if (cached != NULL) {
+            SDL_IOStream* io = SDL_IOFromConstMem(SDL_PhysFS_CachedFileData(cached), cached->size);
+            if (io == NULL) {
+                SDL_PhysFS_ReleaseCachedFile(cached);
+                return NULL;
+            }
+            if (!SDL_SetPointerPropertyWithCleanup(SDL_GetIOProperties(io), SDL_PHYSFS_PROP_IOSTREAM_CACHED_FILE, cached, SDL_PhysFS_CachedFileCleanup, NULL)) {
+                SDL_CloseIO(io);
+                return NULL;
+            }
+            SDL_PhysFS_RecordAccess(filename);
+            return io;
+        }
+        if (handle == NULL) {
+            SDL_PhysFS_SetError("Failed to open file for reading");
+            return NULL;
+        }
+    }
+
+    if (handle == NULL) {
+        handle = SDL_PhysFS_IsKnownMissing(filename) ? NULL : PHYSFS_openRead(filename);
+    }
+    if (handle == NULL) {
+        SDL_PhysFS_SetError("Failed to open file for reading");
+        return NULL;
+    }
+    SDL_PhysFS_RecordAccess(filename);
+
+    if (defaultBufferSize) {
+        bufferSize = SDL_PhysFS_DefaultBufferSize(filename);
+    }
+    if (bufferSize > 0 && PHYSFS_setBuffer(handle, (PHYSFS_uint64)bufferSize) == 0) {
+        SDL_PhysFS_SetError("Failed to set file buffer");
+        PHYSFS_close(handle);
+        return NULL;
+    }
+
+#ifdef SDL_PHYSFS_STATS
+    return SDL_PhysFS_OpenTracedIO(handle, filename, start);
+#else
+    SDL_IOStream* io = SDL_PhysFS_OpenStateIO(handle, true);
+    if (io == NULL) {
+        PHYSFS_close(handle);
+    }
+    return io;
+#endif
+}
+
+/**
+ * Loads a SDL_IOStream from the given filename in PhysFS.
+ *
+ * Reads are buffered with a default size depending on whether the file is in
+ * a directory or an archive. Use SDL_PhysFS_IOFromFileEx() to choose the size.
+ *
+ * @param filename The filename to load from PhysFS.
+ *
+ * @return The resulting SDL_IOStream*, which must be freed with SDL_CloseIO() afterwards. NULL on failure, use SDL_GetError() to see details.
+ *
+ * @see SDL_PhysFS_IOFromFileEx()
+ */
+SDL_IOStream* SDL_PhysFS_IOFromFile(const char* filename) {
+    if (filename == NULL) {
+        SDL_InvalidParamError("filename");
+        return NULL;
+    }
+
+    return SDL_PhysFS_OpenBufferedIO(filename, 0, true);
+}
+
+/**
+ * Loads a SDL_IOStream from the given filename in PhysFS, with the given read buffer size.
+ *
+ * Buffering lets the many small reads made by image and audio decoders be served from memory, rather than each reaching the archiver.
+ *
+ * @param filename The filename to load from PhysFS.
+ * @param bufferSize The size of the read buffer in bytes, or 0 to read unbuffered.
+ *
+ * @return The resulting SDL_IOStream*, which must be freed with SDL_CloseIO() afterwards. NULL on failure, use SDL_GetError() to see details.
+ *
+ * @see SDL_PhysFS_IOFromFile()
+ */
+SDL_IOStream* SDL_PhysFS_IOFromFileEx(const char* filename, size_t bufferSize) {
+    return SDL_PhysFS_OpenBufferedIO(filename, bufferSize, false);
+}
+
+/**
+ * Sets how many of the most recently read bytes a stream keeps, so seeking back over them is free.
+ *
+ * Seeking backwards in a compressed archive entry makes PhysFS decompress the
+ * entry again from its start. Audio scrubbing, and decoders that look back a
+ * little, pay that cost on every backward seek. With a rewind window, seeks
+ * back within the last size bytes read are served from memory instead.
+ * Longer backward seeks still restart decompression.
+ *
+ * Streams served from the content cache are already in memory, and succeed without keeping anything.
+ *
+ * @param io A stream from SDL_PhysFS_IOFromFile() or SDL_PhysFS_OpenIO().
+ * @param size The number of bytes to keep, or 0 to keep none. This is the memory cost.
+ *
+ * @return true on success, false otherwise. Use SDL_GetError() for details.
+ *
+ * @see SDL_PhysFS_IOFromFile()
+ */
+bool SDL_PhysFS_SetIORewindSize(SDL_IOStream* io, size_t size) {
+    if (io == NULL) {
+        return SDL_InvalidParamError("io");
+    }
+
+    SDL_PropertiesID props = SDL_GetIOProperties(io);
+    if (SDL_GetPointerProperty(props, SDL_PHYSFS_PROP_IOSTREAM_CACHED_FILE, NULL) != NULL) {
+        return true;
+    }
+
+    SDL_PhysFS_IOState* state = (SDL_PhysFS_IOState*)SDL_GetPointerProperty(props, SDL_PHYSFS_PROP_IOSTREAM_STATE, NULL);
+    if (state == NULL) {
+        return SDL_SetError("Stream was not created by SDL_PhysFS");
+    }
+
+    if (!SDL_PhysFS_SyncHandlePosition(state)) {
+        SDL_PhysFS_SetError("Failed to seek in file");
+        return false;
+    }
+
+    Uint8* history = NULL;
+    if (size > 0) {
+        history = (Uint8*)SDL_malloc(size);
+        if (history == NULL) {
+            return false;
+        }
+    }
+
+    SDL_free(state->history);
+    state->history = history;
+    state->historySize = size;
+    state->historyFilled = 0;
+
+    return true;
+}
+
+/**
+ * Loads a bitmap file from PhysFS into an SDL_Surface.
+ *
+ * @param filename The filename to load.
+ *
+ * @return The SDL_Surface, or NULL on failure, use SDL_GetError() for details.
+ */
+SDL_Surface* SDL_PhysFS_LoadBMP(const char* filename) {
+    SDL_IOStream* io = SDL_PhysFS_IOFromFile(filename);
+    if (io == NULL) {
+        return NULL;
+    }
+
+    return SDL_LoadBMP_IO(io, 1);
+}
+
+/**
+ * Loads a JPG file from PhysFS.
+ *
+ * @param filename The filename of the JPG file to load.
+ *
+ * @return The SDL_Surface, or NULL on failure, use SDL_GetError() for details.
+ */
+SDL_Surface* SDL_PhysFS_LoadJPG(const char* filename) {
+#if SDL_VERSION_ATLEAST(3, 6, 0)
+    SDL_IOStream* io = SDL_PhysFS_IOFromFile(filename);
+    if (io == NULL) {
+        return NULL;
+    }
+
+    return SDL_LoadJPG_IO(io, true);
+#else
+    (void)filename;
+    SDL_PhysFS_SetError("SDL_PhysFS_LoadJPG requires SDL 3.6.0 or newer");
+    return NULL;
+#endif
+}
+
+/**
+ * Loads a PNG file from PhysFS.
+ *
+ * @param filename The filename of the PNG file to load.
+ *
+ * @return The SDL_Surface, or NULL on failure, use SDL_GetError() for details.
+ */
+SDL_Surface* SDL_PhysFS_LoadPNG(const char* filename) {
+    SDL_IOStream* io = SDL_PhysFS_IOFromFile(filename);
+    if (io == NULL) {
+        return NULL;
+    }
+
+    return SDL_LoadPNG_IO(io, 1);
+}
+
+/**
+ * Loads a surface from any supported image format through PhysFS.
+ *
+ * @param filename The filename of the image file to load.
+ *
+ * @return The SDL_Surface, or NULL on failure, use SDL_GetError() for details.
+ */
+SDL_Surface* SDL_PhysFS_LoadSurface(const char* filename) {
+    SDL_IOStream* io = SDL_PhysFS_IOFromFile(filename);
+    if (io == NULL) {
+        return NULL;
+    }
+
+    return SDL_LoadSurface_IO(io, true);
+}
+
+// Surface property holding the decoded surface whose pixels a converted surface borrows.
+#define SDL_PHYSFS_PROP_SURFACE_SOURCE "SDL_PhysFS.source"
+
+/**
+ * SDL_CleanupPropertyCallback destroying the surface that was converted in place.
+ *
+ * @internal
+ */
+static void SDLCALL SDL_PhysFS_SurfaceSourceCleanup(void* userdata, void* value) {
+    (void)userdata;
+    SDL_DestroySurface((SDL_Surface*)value);
+}
+
+/**
+ * Converts a surface's pixels over themselves, into a format with no more bytes per pixel.
+ *
+ * SDL_ConvertPixels() isn't documented to support the same source and
+ * destination, so each row is converted into a separate scratch row, and
+ * copied back. The new row fits in the start of the old one, so rows that
+ * are still to be converted are never written over.
+ *
+ * @param surface The surface, which must not need locking.
+ * @param format The new pixel format.
+ * @param row The scratch row, with room for a row of the new format.
+ * @param modified Set to whether any pixels were written over, even on failure.
+ *
+ * @return true on success, false otherwise.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_ConvertRowsInPlace(SDL_Surface* surface, SDL_PixelFormat format, void* row, bool* modified) {
+    *modified = false;
+    size_t rowSize = (size_t)surface->w * (size_t)SDL_BYTESPERPIXEL(format);
+    for (int y = 0; y < surface->h; y++) {
+        Uint8* pixels = (Uint8*)surface->pixels + (size_t)y * (size_t)surface->pitch;
+        if (!SDL_ConvertPixels(surface->w, 1, surface->format, pixels, surface->pitch, format, row, (int)rowSize)) {
+            return false;
+        }
+        SDL_memcpy(pixels, row, rowSize);
+        *modified = true;
+    }
+
+    return true;
+}
+
+/**
+ * Copies the blend mode and the color and alpha modulation of a surface to its converted copy, as SDL_ConvertSurface() does.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_CopySurfaceAttributes(SDL_Surface* source, SDL_Surface* converted) {
+    SDL_BlendMode blendMode;
+    Uint8 r, g, b, alpha;
+    if (SDL_GetSurfaceBlendMode(source, &blendMode)) {
+        // A surface gaining an alpha channel blends it, like any new surface with one.
+        if (blendMode == SDL_BLENDMODE_NONE && !SDL_ISPIXELFORMAT_ALPHA(source->format) && SDL_ISPIXELFORMAT_ALPHA(converted->format)) {
+            blendMode = SDL_BLENDMODE_BLEND;
+        }
+        SDL_SetSurfaceBlendMode(converted, blendMode);
+    }
+    if (SDL_GetSurfaceColorMod(source, &r, &g, &b)) {
+        SDL_SetSurfaceColorMod(converted, r, g, b);
+    }
+    if (SDL_GetSurfaceAlphaMod(source, &alpha)) {
+        SDL_SetSurfaceAlphaMod(converted, alpha);
+    }
+    SDL_SetSurfaceColorspace(converted, SDL_GetSurfaceColorspace(source));
+}
+
+/**
+ * Converts a decoded surface into another format, taking ownership of it.
+ *
+ * When the new format's pixels are no larger than the old one's, they're
+ * converted over the decoded pixels a row at a time, and the returned surface
+ * borrows them, with the decoded surface's blend mode, modulation and
+ * colorspace. Surfaces with a color key, or a colorspace other than sRGB, are
+ * left to SDL_ConvertSurface(), as is any conversion that fails before a pixel
+ * has been written over. Otherwise the surface is converted into a new one,
+ * and the decoded one is destroyed straight away.
+ *
+ * @internal
+ */
+static SDL_Surface* SDL_PhysFS_ConvertSurfaceInPlace(SDL_Surface* surface, SDL_PixelFormat format) {
+    if (surface == NULL || surface->format == format) {
+        return surface;
+    }
+
+    if (!SDL_ISPIXELFORMAT_INDEXED(surface->format) && !SDL_ISPIXELFORMAT_FOURCC(surface->format) &&
+        !SDL_ISPIXELFORMAT_INDEXED(format) && !SDL_ISPIXELFORMAT_FOURCC(format) &&
+        SDL_BYTESPERPIXEL(format) <= SDL_BYTESPERPIXEL(surface->format) && !SDL_MUSTLOCK(surface) &&
+        !SDL_SurfaceHasColorKey(surface) && SDL_GetSurfaceColorspace(surface) == SDL_COLORSPACE_SRGB) {
+        void* row = SDL_malloc((size_t)surface->w * (size_t)SDL_BYTESPERPIXEL(format) + 1);
+        bool modified = false;
+        bool converted = row != NULL && SDL_PhysFS_ConvertRowsInPlace(surface, format, row, &modified);
+        SDL_free(row);
+
+        // Pixels that were partly written over can't be converted again.
+        if (!converted && modified) {
+            SDL_DestroySurface(surface);
+            return NULL;
+        }
+        if (converted) {
+            SDL_Surface* result = SDL_CreateSurfaceFrom(surface->w, surface->h, format, surface->pixels, surface->pitch);
+            if (result == NULL) {
+                SDL_DestroySurface(surface);
+                return NULL;
+            }
+            SDL_PhysFS_CopySurfaceAttributes(surface, result);
+
+            // The cleanup has already destroyed the decoded surface, if setting the property failed.
+            if (!SDL_SetPointerPropertyWithCleanup(SDL_GetSurfaceProperties(result), SDL_PHYSFS_PROP_SURFACE_SOURCE, surface, SDL_PhysFS_SurfaceSourceCleanup, NULL)) {
+                SDL_DestroySurface(result);
+                return NULL;
+            }
+            return result;
+        }
+    }
+
+    SDL_Surface* converted = SDL_ConvertSurface(surface, format);
+    SDL_DestroySurface(surface);
+
+    return converted;
+}
+
+/**
+ * Loads a surface from any supported image format through PhysFS, in the given pixel format.
+ *
+ * Converting the result of SDL_PhysFS_LoadSurface() with SDL_ConvertSurface()
+ * holds both copies of the pixels at once. When the format's pixels are no
+ * larger than the decoded ones, such as RGBA to ARGB, this converts them in
+ * place instead, a row at a time. Otherwise the decoded surface is
+ * freed as soon as it's converted.
+ *
+ * @param filename The filename of the image file to load.
+ * @param format The pixel format of the returned surface, such as a texture format of the renderer.
+ *
+ * @return The SDL_Surface, or NULL on failure, use SDL_GetError() for details.
+ *
+ * @see SDL_PhysFS_LoadSurfacesFormat()
+ */
+SDL_Surface* SDL_PhysFS_LoadSurfaceFormat(const char* filename, SDL_PixelFormat format) {
+    if (format == SDL_PIXELFORMAT_UNKNOWN) {
+        SDL_InvalidParamError("format");
+        return NULL;
+    }
+
+    return SDL_PhysFS_ConvertSurfaceInPlace(SDL_PhysFS_LoadSurface(filename), format);
+}
+
+/**
+ * The surfaces being loaded by SDL_PhysFS_LoadSurfacesFormat().
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_SurfaceBatch {
+    const char** filenames;
+    SDL_Surface** surfaces;
+    int count;
+    SDL_PixelFormat format;
+    SDL_AtomicInt next;
+    SDL_AtomicInt failed;
+} SDL_PhysFS_SurfaceBatch;
+
+/**
+ * Decode thread: loads surfaces from the batch until there are none left. SDL_PIXELFORMAT_UNKNOWN keeps the decoded format.
+ *
+ * @internal
+ */
+static int SDLCALL SDL_PhysFS_SurfaceBatchWorker(void* data) {
+    SDL_PhysFS_SurfaceBatch* batch = (SDL_PhysFS_SurfaceBatch*)data;
+    for (;;) {
+        int index = SDL_AddAtomicInt(&batch->next, 1);
+        if (index >= batch->count) {
+            break;
+        }
+        if (batch->format == SDL_PIXELFORMAT_UNKNOWN) {
+            batch->surfaces[index] = SDL_PhysFS_LoadSurface(batch->filenames[index]);
+        }
+        else {
+            batch->surfaces[index] = SDL_PhysFS_LoadSurfaceFormat(batch->filenames[index], batch->format);
+        }
+        if (batch->surfaces[index] == NULL) {
+            SDL_AddAtomicInt(&batch->failed, 1);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Decodes surfaces on up to SDL_PHYSFS_DECODE_THREADS threads, including the calling one.
+ *
+ * @return The number of surfaces that couldn't be loaded.
+ *
+ * @internal
+ */
+static int SDL_PhysFS_DecodeSurfaces(const char** filenames, int count, SDL_PixelFormat format, SDL_Surface** surfaces) {
+    SDL_PhysFS_SurfaceBatch batch;
+    batch.filenames = filenames;
+    batch.surfaces = surfaces;
+    batch.count = count;
+    batch.format = format;
+    SDL_SetAtomicInt(&batch.next, 0);
+    SDL_SetAtomicInt(&batch.failed, 0);
+
+    SDL_Thread* threads[SDL_PHYSFS_DECODE_THREADS];
+    int numThreads = SDL_min(SDL_min(SDL_GetNumLogicalCPUCores(), SDL_PHYSFS_DECODE_THREADS), count) - 1;
+    for (int i = 0; i < numThreads; i++) {
+        threads[i] = SDL_CreateThread(SDL_PhysFS_SurfaceBatchWorker, "SDL_PhysFS_Decode", &batch);
+    }
+    SDL_PhysFS_SurfaceBatchWorker(&batch);
+    for (int i = 0; i < numThreads; i++) {
+        if (threads[i] != NULL) {
+            SDL_WaitThread(threads[i], NULL);
+        }
+    }
+
+    return SDL_GetAtomicInt(&batch.failed);
+}
+
+/**
+ * Loads many surfaces at once in the given pixel format, decoding them in parallel.
+ *
+ * Each surface is loaded as SDL_PhysFS_LoadSurfaceFormat() does, on up to
+ * SDL_PHYSFS_DECODE_THREADS threads, including the calling one.
+ *
+ * @param filenames The names of the image files to load.
+ * @param count The number of files in filenames.
+ * @param format The pixel format of the returned surfaces.
+ * @param surfaces Where to put each surface, in the same order as filenames. Files that couldn't be loaded get NULL.
+ *
+ * @return true if every surface was loaded, false otherwise. Use SDL_GetError() for details.
+ *
+ * @see SDL_PhysFS_LoadSurfaceFormat()
+ */
+bool SDL_PhysFS_LoadSurfacesFormat(const char** filenames, int count, SDL_PixelFormat format, SDL_Surface** surfaces) {
+    if (filenames == NULL || count <= 0 || surfaces == NULL) {
+        return SDL_InvalidParamError("filenames, count or surfaces");
+    }
+    if (format == SDL_PIXELFORMAT_UNKNOWN) {
+        return SDL_InvalidParamError("format");
+    }
+
+    int failed = SDL_PhysFS_DecodeSurfaces(filenames, count, format, surfaces);
+    if (failed > 0) {
+        return SDL_SetError("Failed to load %d of %d surfaces", failed, count);
+    }
+
+    return true;
+}
+
+/**
+ * Conversion space shared by the textures uploaded by SDL_PhysFS_LoadTextures().
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_TextureScratch {
+    void* pixels;
+    size_t size;
+} SDL_PhysFS_TextureScratch;
+
+/**
+ * Picks the texture format to upload a surface as, the way SDL_CreateTextureFromSurface() does.
+ *
+ * The surface's own format is used when the renderer supports it. Otherwise,
+ * it's the renderer's first format with 8 bits per channel and matching
+ * alpha, so the pixels are never squeezed into a packed, 10-bit or float
+ * format. Surfaces that are 10-bit or float themselves, and surfaces with no
+ * such format available, get SDL_PIXELFORMAT_UNKNOWN, for
+ * SDL_CreateTextureFromSurface() to handle.
+ *
+ * @internal
+ */
+static SDL_PixelFormat SDL_PhysFS_ChooseTextureFormat(SDL_Renderer* renderer, SDL_Surface* surface) {
+    const SDL_PixelFormat* formats = (const SDL_PixelFormat*)SDL_GetPointerProperty(SDL_GetRendererProperties(renderer), SDL_PROP_RENDERER_TEXTURE_FORMATS_POINTER, NULL);
+    if (formats == NULL) {
+        return SDL_PIXELFORMAT_UNKNOWN;
+    }
+    for (const SDL_PixelFormat* format = formats; *format != SDL_PIXELFORMAT_UNKNOWN; format++) {
+        if (*format == surface->format) {
+            return *format;
+        }
+    }
+    if (SDL_ISPIXELFORMAT_10BIT(surface->format) || SDL_ISPIXELFORMAT_FLOAT(surface->format)) {
+        return SDL_PIXELFORMAT_UNKNOWN;
+    }
+
+    static const SDL_PixelFormat alphaFormats[] = {
+        SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ABGR8888, SDL_PIXELFORMAT_RGBA8888, SDL_PIXELFORMAT_BGRA8888
+    };
+    static const SDL_PixelFormat opaqueFormats[] = {
+        SDL_PIXELFORMAT_XRGB8888, SDL_PIXELFORMAT_XBGR8888, SDL_PIXELFORMAT_RGBX8888, SDL_PIXELFORMAT_BGRX8888,
+        SDL_PIXELFORMAT_RGB24, SDL_PIXELFORMAT_BGR24
+    };
+    bool alpha = SDL_ISPIXELFORMAT_ALPHA(surface->format);
+    const SDL_PixelFormat* candidates = alpha ? alphaFormats : opaqueFormats;
+    size_t numCandidates = alpha ? SDL_arraysize(alphaFormats) : SDL_arraysize(opaqueFormats);
+    for (const SDL_PixelFormat* format = formats; *format != SDL_PIXELFORMAT_UNKNOWN; format++) {
+        for (size_t i = 0; i < numCandidates; i++) {
+            if (*format == candidates[i]) {
+                return *format;
+            }
+        }
+    }
+
+    return SDL_PIXELFORMAT_UNKNOWN;
+}
+
+/**
+ * Creates a texture from a decoded surface, and destroys the surface.
+ *
+ * The pixels are uploaded as they are when the renderer supports their
+ * format. Otherwise they're converted into the scratch buffer, which is grown
+ * as needed and kept for the next texture. The texture gets the surface's
+ * blend mode and color and alpha mods. Surfaces with a palette, a color key
+ * or a colorspace other than sRGB go through SDL_CreateTextureFromSurface().
+ *
+ * @internal
+ */
+static SDL_Texture* SDL_PhysFS_UploadSurface(SDL_Renderer* renderer, SDL_Surface* surface, SDL_PhysFS_TextureScratch* scratch) {
+    if (surface == NULL) {
+        return NULL;
+    }
+
+    SDL_PixelFormat format = SDL_PIXELFORMAT_UNKNOWN;
+    if (!SDL_ISPIXELFORMAT_INDEXED(surface->format) && !SDL_ISPIXELFORMAT_FOURCC(surface->format) &&
+        !SDL_SurfaceHasColorKey(surface) && SDL_GetSurfaceColorspace(surface) == SDL_COLORSPACE_SRGB) {
+        format = SDL_PhysFS_ChooseTextureFormat(renderer, surface);
+    }
+    if (format == SDL_PIXELFORMAT_UNKNOWN) {
+        SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+        SDL_DestroySurface(surface);
+        return texture;
+    }
+
+    const void* pixels = surface->pixels;
+    int pitch = surface->pitch;
+    bool converted = true;
+    if (format != surface->format) {
+        pitch = surface->w * SDL_BYTESPERPIXEL(format);
+        size_t size = (size_t)pitch * (size_t)surface->h;
+        if (size > scratch->size) {
+            void* grown = SDL_realloc(scratch->pixels, size);
+            if (grown == NULL) {
+                SDL_DestroySurface(surface);
+                return NULL;
+            }
+            scratch->pixels = grown;
+            scratch->size = size;
+        }
+        pixels = scratch->pixels;
+        converted = SDL_ConvertPixels(surface->w, surface->h, surface->format, surface->pixels, surface->pitch, format, scratch->pixels, pitch);
+    }
+
+    SDL_Texture* texture = NULL;
+    if (converted) {
+        texture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_STATIC, surface->w, surface->h);
+    }
+    if (texture != NULL) {
+        if (!SDL_UpdateTexture(texture, NULL, pixels, pitch)) {
+            SDL_DestroyTexture(texture);
+            texture = NULL;
+        }
+        else {
+            // The same attributes SDL_CreateTextureFromSurface() carries over.
+            SDL_BlendMode blendMode;
+            Uint8 r, g, b, a;
+            if (SDL_GetSurfaceBlendMode(surface, &blendMode)) {
+                SDL_SetTextureBlendMode(texture, blendMode);
+            }
+            if (SDL_GetSurfaceColorMod(surface, &r, &g, &b)) {
+                SDL_SetTextureColorMod(texture, r, g, b);
+            }
+            if (SDL_GetSurfaceAlphaMod(surface, &a)) {
+                SDL_SetTextureAlphaMod(texture, a);
+            }
+        }
+    }
+
+    SDL_DestroySurface(surface);
+    return texture;
+}
+
+/**
+ * Loads an image through PhysFS into a texture.
+ *
+ * This is like SDL_CreateTextureFromSurface() on the result of
+ * SDL_PhysFS_LoadSurface(), without keeping a converted copy of the surface
+ * along the way. It works with any renderer, including the software renderer.
+ *
+ * @param renderer The renderer to create the texture with.
+ * @param filename The filename of the image file to load.
+ *
+ * @return The SDL_Texture, or NULL on failure, use SDL_GetError() for details.
+ *
+ * @see SDL_PhysFS_LoadTextures()
+ */
+SDL_Texture* SDL_PhysFS_LoadTexture(SDL_Renderer* renderer, const char* filename) {
+    if (renderer == NULL) {
+        SDL_InvalidParamError("renderer");
+        return NULL;
+    }
+
+    SDL_PhysFS_TextureScratch scratch = { NULL, 0 };
+    SDL_Texture* texture = SDL_PhysFS_UploadSurface(renderer, SDL_PhysFS_LoadSurface(filename), &scratch);
+    SDL_free(scratch.pixels);
+
+    return texture;
+}
+
+/**
+ * Loads many images through PhysFS into textures.
+ *
+ * Images are decoded in parallel a few at a time, and uploaded on the
+ * calling thread, as renderers require. Images that need converting for the
+ * renderer share a single scratch buffer, rather than allocating for each.
+ *
+ * @param renderer The renderer to create the textures with.
+ * @param filenames The names of the image files to load.
+ * @param count The number of files in filenames.
+ * @param textures Where to put each texture, in the same order as filenames. Files that couldn't be loaded get NULL.
+ *
+ * @return true if every texture was loaded, false otherwise. Use SDL_GetError() for details.
+ *
+ * @see SDL_PhysFS_LoadTexture()
+ */
+bool SDL_PhysFS_LoadTextures(SDL_Renderer* renderer, const char** filenames, int count, SDL_Texture** textures) {
+    if (renderer == NULL || filenames == NULL || count <= 0 || textures == NULL) {
+        return SDL_InvalidParamError("renderer, filenames, count or textures");
+    }
+
+    // Only a few decoded surfaces are held at once.
+    SDL_Surface* surfaces[SDL_PHYSFS_DECODE_THREADS * 4];
+    SDL_PhysFS_TextureScratch scratch = { NULL, 0 };
+    int failed = 0;
+    for (int start = 0; start < count; start += (int)SDL_arraysize(surfaces)) {
+        int chunk = SDL_min(count - start, (int)SDL_arraysize(surfaces));
+        SDL_PhysFS_DecodeSurfaces(filenames + start, chunk, SDL_PIXELFORMAT_UNKNOWN, surfaces);
+        for (int i = 0; i < chunk; i++) {
+            textures[start + i] = SDL_PhysFS_UploadSurface(renderer, surfaces[i], &scratch);
+            if (textures[start + i] == NULL) {
+                failed++;
+            }
+        }
+    }
+    SDL_free(scratch.pixels);
+
+    if (failed > 0) {
+        return SDL_SetError("Failed to load %d of %d textures", failed, count);
+    }
+
+    return true;
+}
+
+/**
+ * Loads a wav file from PhysFS.
+ *
+ * @param filename The filename of the wav file to load.
+ *
+ * @return True or false depending on if loading was successful. Use SDL_GetError() for details of the failure.
+ */
+bool SDL_PhysFS_LoadWAV(const char* filename, SDL_AudioSpec * spec, Uint8 ** audio_buf, Uint32 * audio_len) {
+    SDL_IOStream* io = SDL_PhysFS_IOFromFile(filename);
+    if (io == NULL) {
+        return false;
+    }
+
+    return SDL_LoadWAV_IO(io, 1, spec, audio_buf, audio_len);
+}
+
+// Audio stream property holding the SDL_PhysFS_AudioSource feeding it.
+#define SDL_PHYSFS_PROP_AUDIOSTREAM_SOURCE "SDL_PhysFS.audioSource"
+
+/**
+ * A WAV file being streamed into an SDL_AudioStream by SDL_PhysFS_OpenAudioStream().
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_AudioSource {
+    SDL_IOStream* io;
+    Uint64 remaining;
+    int frameSize;
+    bool flushed;
+    Uint8 buffer[SDL_PHYSFS_AUDIO_BUFFER_SIZE];
+} SDL_PhysFS_AudioSource;
+
+/**
+ * SDL_CleanupPropertyCallback closing the file when its audio stream is destroyed.
+ *
+ * @internal
+ */
+static void SDLCALL SDL_PhysFS_AudioSourceCleanup(void* userdata, void* value) {
+    SDL_PhysFS_AudioSource* source = (SDL_PhysFS_AudioSource*)value;
+    (void)userdata;
+    SDL_CloseIO(source->io);
+    SDL_free(source);
+}
+
+/**
+ * SDL_AudioStreamCallback reading as much of the file as the stream asks for, a buffer at a time.
+ *
+ * @internal
+ */
+static void SDLCALL SDL_PhysFS_AudioSourceCallback(void* userdata, SDL_AudioStream* stream, int additional_amount, int total_amount) {
+    SDL_PhysFS_AudioSource* source = (SDL_PhysFS_AudioSource*)userdata;
+    (void)total_amount;
+
+    // Reads never go past the data chunk, so the chunks after it aren't played.
+    Uint64 wanted = (Uint64)SDL_max(additional_amount, 0);
+    while (wanted > 0 && source->remaining >= (Uint64)source->frameSize) {
+        size_t chunk = (size_t)SDL_min(SDL_min(wanted, source->remaining), (Uint64)sizeof(source->buffer));
+        chunk -= chunk % (size_t)source->frameSize;
+        if (chunk == 0) {
+            chunk = (size_t)source->frameSize;
+        }
+
+        size_t read = SDL_ReadIO(source->io, source->buffer, chunk);
+        read -= read % (size_t)source->frameSize;
+        if (read == 0) {
+            source->remaining = 0;
+            break;
+        }
+        SDL_PutAudioStreamData(stream, source->buffer, (int)read);
+        source->remaining -= read;
+        wanted -= SDL_min(wanted, (Uint64)read);
+    }
+
+    // A partial frame at the end of the data can't be played.
+    if (source->remaining < (Uint64)source->frameSize) {
+        source->remaining = 0;
+    }
+
+    // Let the last of the audio through the resampler.
+    if (source->remaining == 0 && !source->flushed) {
+        source->flushed = true;
+        SDL_FlushAudioStream(stream);
+    }
+}
+
+/**
+ * Reads a WAV file's format, and finds its audio data.
+ *
+ * Uncompressed PCM and IEEE float data are supported, including
+ * WAVE_FORMAT_EXTENSIBLE files holding them.
+ *
+ * @return true with the io positioned at the start of the audio data, false otherwise.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_ReadWAVHeader(SDL_IOStream* io, SDL_AudioSpec* spec, Uint64* dataSize) {
+    Uint32 riff, riffSize, wave;
+    if (!SDL_ReadU32LE(io, &riff) || !SDL_ReadU32LE(io, &riffSize) || !SDL_ReadU32LE(io, &wave) ||
+        riff != 0x46464952 || wave != 0x45564157) {
+        return SDL_SetError("Not a WAV file");
+    }
+
+    bool hasFormat = false;
+    Uint16 encoding = 0, channels = 0, bits = 0;
+    Uint32 frequency = 0;
+    for (;;) {
+        Uint32 id, size;
+        if (!SDL_ReadU32LE(io, &id) || !SDL_ReadU32LE(io, &size)) {
+            return SDL_SetError("WAV file has no audio data");
+        }
+        Sint64 start = SDL_TellIO(io);
+
+        // "fmt "
+        if (id == 0x20746D66 && size >= 16) {
+            Uint32 byteRate;
+            Uint16 blockAlign;
+            if (!SDL_ReadU16LE(io, &encoding) || !SDL_ReadU16LE(io, &channels) || !SDL_ReadU32LE(io, &frequency) ||
+                !SDL_ReadU32LE(io, &byteRate) || !SDL_ReadU16LE(io, &blockAlign) || !SDL_ReadU16LE(io, &bits)) {
+                return SDL_SetError("Corrupt WAV format chunk");
+            }
+
+            // WAVE_FORMAT_EXTENSIBLE keeps the encoding at the start of its subformat GUID.
+            Uint16 extraSize, validBits;
+            Uint32 channelMask;
+            if (encoding == 0xFFFE && size >= 40 &&
+                (!SDL_ReadU16LE(io, &extraSize) || !SDL_ReadU16LE(io, &validBits) ||
+                 !SDL_ReadU32LE(io, &channelMask) || !SDL_ReadU16LE(io, &encoding))) {
+                return SDL_SetError("Corrupt WAV format chunk");
+            }
+            hasFormat = true;
+        }
+        // "data"
+        else if (id == 0x61746164) {
+            if (!hasFormat) {
+                return SDL_SetError("WAV file has no format chunk");
+            }
+
+            // Streamed WAV files may not know their data's size.
+            Sint64 available = SDL_GetIOSize(io) - start;
+            *dataSize = available >= 0 ? SDL_min((Uint64)size, (Uint64)available) : (Uint64)size;
+            break;
+        }
+
+        if (SDL_SeekIO(io, start + (Sint64)size + (Sint64)(size & 1), SDL_IO_SEEK_SET) < 0) {
+            return false;
+        }
+    }
+
+    if (encoding == 1 && bits == 8) {
+        spec->format = SDL_AUDIO_U8;
+    }
+    else if (encoding == 1 && bits == 16) {
+        spec->format = SDL_AUDIO_S16LE;
+    }
+    else if (encoding == 1 && bits == 32) {
+        spec->format = SDL_AUDIO_S32LE;
+    }
+    else if (encoding == 3 && bits == 32) {
+        spec->format = SDL_AUDIO_F32LE;
+    }
+    else {
+        return SDL_SetError("Unsupported WAV encoding %u with %u bits per sample, use SDL_PhysFS_LoadWAV()", (unsigned)encoding, (unsigned)bits);
+    }
+    if (channels == 0 || frequency == 0 || frequency > SDL_MAX_SINT32) {
+        return SDL_SetError("Corrupt WAV format chunk");
+    }
+    spec->channels = channels;
+    spec->freq = (int)frequency;
+
+    return true;
+}
+
+/**
+ * Opens a WAV file from PhysFS as an audio stream, which reads the file as it's played.
+ *
+ * SDL_PhysFS_LoadWAV() decodes the whole file into memory. This keeps the
+ * file open instead, and reads it in pieces of SDL_PHYSFS_AUDIO_BUFFER_SIZE
+ * bytes whenever the stream needs more, so long music tracks use very little
+ * memory. Bind the stream to an audio device, or get its data directly.
+ *
+ * Uncompressed PCM and float WAV files are supported. Destroying the stream closes the file.
+ *
+ * @code
+ * SDL_AudioStream* music = SDL_PhysFS_OpenAudioStream("music/theme.wav", NULL);
+ * SDL_BindAudioStream(device, music);
+ * // ...
+ * SDL_DestroyAudioStream(music);
+ * @endcode
+ *
+ * @param filename The filename of the WAV file to stream.
+ * @param dst_spec The format to convert the audio to, or NULL to keep the file's format. Binding the stream to a device sets this.
+ *
+ * @return The SDL_AudioStream, or NULL on failure, use SDL_GetError() for details.
+ *
+ * @see SDL_PhysFS_LoadWAV()
+ */
+SDL_AudioStream* SDL_PhysFS_OpenAudioStream(const char* filename, const SDL_AudioSpec* dst_spec) {
+    SDL_PhysFS_AudioSource* source = (SDL_PhysFS_AudioSource*)SDL_calloc(1, sizeof(SDL_PhysFS_AudioSource));
+    if (source == NULL) {
+        return NULL;
+    }
+
+    SDL_AudioSpec spec;
+    source->io = SDL_PhysFS_IOFromFile(filename);
+    if (source->io == NULL || !SDL_PhysFS_ReadWAVHeader(source->io, &spec, &source->remaining)) {
+        if (source->io != NULL) {
+            SDL_CloseIO(source->io);
+        }
+        SDL_free(source);
+        return NULL;
+    }
+    source->frameSize = SDL_AUDIO_FRAMESIZE(spec);
+    if ((size_t)source->frameSize > sizeof(source->buffer)) {
+        SDL_SetError("WAV file has too many channels to stream");
+        SDL_PhysFS_AudioSourceCleanup(NULL, source);
+        return NULL;
+    }
+
+    SDL_AudioStream* stream = SDL_CreateAudioStream(&spec, dst_spec != NULL ? dst_spec : &spec);
+    if (stream == NULL) {
+        SDL_PhysFS_AudioSourceCleanup(NULL, source);
+        return NULL;
+    }
+
+    // The source lives as long as the stream does.
+    if (!SDL_SetPointerPropertyWithCleanup(SDL_GetAudioStreamProperties(stream), SDL_PHYSFS_PROP_AUDIOSTREAM_SOURCE, source, SDL_PhysFS_AudioSourceCleanup, NULL) ||
+        !SDL_SetAudioStreamGetCallback(stream, SDL_PhysFS_AudioSourceCallback, source)) {
+        SDL_DestroyAudioStream(stream);
+        return NULL;
+    }
+
+    return stream;
+}
+
+/**
+ * Loads all the file data from a given filename.
+ *
+ * @param filename The name of the file to load.
+ * @param datasize Where to put the resulting size of the file.
+ *
+ * @return A new memory buffer containing all the data from the file. NULL on failure, use SDL_GetError() for details.
+ */
+void* SDL_PhysFS_LoadFile(const char* filename, size_t *datasize) {
+    if (filename == NULL) {
+        SDL_InvalidParamError("filename");
+        return NULL;
+    }
+
+#ifdef SDL_PHYSFS_STATS
+    Uint64 start = SDL_GetTicksNS();
+#endif
+    // Copy cached files from memory.
+    PHYSFS_File* handle = NULL;
+    if (SDL_PhysFS_ContentCacheEnabled()) {
+        SDL_PhysFS_CachedFile* cached = SDL_PhysFS_ContentCacheLoad(filename, &handle);
+        if (cached != NULL) {
+            void* copy = SDL_malloc(cached->size + 1);
+            if (copy != NULL) {
+                SDL_memcpy(copy, SDL_PhysFS_CachedFileData(cached), cached->size + 1);
+            }
+            if (datasize != NULL) {
+                *datasize = copy != NULL ? cached->size : 0;
+            }
+            SDL_PhysFS_ReleaseCachedFile(cached);
+            SDL_PhysFS_RecordAccess(filename);
+            return copy;
+        }
+    }
+    else {
+        void* data = SDL_PhysFS_ParallelLoadFile(filename, 0, SIZE_MAX, datasize);
+        if (data != NULL) {
+            SDL_PhysFS_RecordAccess(filename);
+            return data;
+        }
+        handle = SDL_PhysFS_IsKnownMissing(filename) ? NULL : PHYSFS_openRead(filename);
+    }
+    if (handle == NULL) {
         SDL_PhysFS_SetError("Failed to load file");
         if (datasize != NULL) {
             *datasize = 0;
         }
         return NULL;
     }
+    SDL_PhysFS_RecordAccess(filename);
+#ifdef SDL_PHYSFS_STATS
+    SDL_PhysFS_Counters* fileCounters;
+    SDL_PhysFS_Counters* mountCounters;
+    SDL_PhysFS_StatsLookup(filename, SDL_PhysFS_GetRealDir(filename), &fileCounters, &mountCounters);
+    SDL_PhysFS_StatsRecord(fileCounters, mountCounters, SDL_PHYSFS_TRACE_OPEN, filename, start, 0);
+#endif
+
+    // Check to see how large the file is.
+    PHYSFS_sint64 size = PHYSFS_fileLength(handle);
+    if (size < 0) {
+        SDL_PhysFS_SetError("Cannot determine file size");
+        if (datasize != NULL) {
+            *datasize = 0;
+        }
+        PHYSFS_close(handle);
+        return NULL;
+    }
+
+    // Existing empty files get an empty null-terminated buffer.
+    if (size == 0) {
+        PHYSFS_close(handle);
+        void* empty = SDL_malloc(1);
+        ((char*)empty)[0] = '\0';
+        if (datasize != NULL) {
+            *datasize = 0;
+        }
+        return empty;
+    }
+
+    // Read the file, with an extra byte for null termination.
+    void* buffer = SDL_malloc((size_t)size + 1);
+#ifdef SDL_PHYSFS_STATS
+    start = SDL_GetTicksNS();
+#endif
+    PHYSFS_sint64 read = PHYSFS_readBytes(handle, buffer, (PHYSFS_uint64)size);
+#ifdef SDL_PHYSFS_STATS
+    SDL_PhysFS_StatsRecord(fileCounters, mountCounters, SDL_PHYSFS_TRACE_READ, filename, start, read);
+#endif
+    if (read < 0) {
+        if (datasize != NULL) {
+            *datasize = 0;
+        }
+        SDL_free(buffer);
+        SDL_PhysFS_SetError("Failed to read bytes from file");
+        PHYSFS_close(handle);
+        return NULL;
+    }
+    ((char*)buffer)[read] = '\0';
+
+    // Close the file handle, and return the bytes read and the buffer.
+#ifdef SDL_PHYSFS_STATS
+    start = SDL_GetTicksNS();
+#endif
+    PHYSFS_close(handle);
+#ifdef SDL_PHYSFS_STATS
+    SDL_PhysFS_StatsRecord(fileCounters, mountCounters, SDL_PHYSFS_TRACE_CLOSE, filename, start, 0);
+#endif
+    if (datasize != NULL) {
+        *datasize = (size_t)read;
+    }
+
+    return buffer;
+}
+
+/**
+ * Starts a quiet probe: SDL_PhysFS_SetError() leaves SDL's error alone on this thread until it ends.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_BeginQuietProbe(void) {
+    PHYSFS_getLastErrorCode();
+    SDL_AddAtomicInt(&SDL_PhysFS_quietProbes, 1);
+    SDL_SetTLS(&SDL_PhysFS_quietErrors, &SDL_PhysFS_quietErrors, NULL);
+}
+
+/**
+ * Ends a quiet probe.
+ *
+ * @return The PhysFS error code the probe failed with, PHYSFS_ERR_OTHER_ERROR if it didn't set one, or PHYSFS_ERR_OK if it succeeded.
+ *
+ * @internal
+ */
+static PHYSFS_ErrorCode SDL_PhysFS_EndQuietProbe(bool succeeded) {
+    SDL_SetTLS(&SDL_PhysFS_quietErrors, NULL, NULL);
+    SDL_AddAtomicInt(&SDL_PhysFS_quietProbes, -1);
+    PHYSFS_ErrorCode code = PHYSFS_getLastErrorCode();
+    if (succeeded) {
+        return PHYSFS_ERR_OK;
+    }
+
+    return code != PHYSFS_ERR_OK ? code : PHYSFS_ERR_OTHER_ERROR;
+}
+
+/**
+ * Opens a file for reading, if it exists, without reporting an error when it doesn't.
+ *
+ * SDL_PhysFS_IOFromFile() formats an error message for SDL_GetError() on
+ * every failure. Code that probes for files that usually aren't there, such
+ * as a resolver trying several extensions, spends more time on those
+ * messages than on the lookups. This returns PhysFS's error code instead,
+ * and formats nothing. Other functions still format their messages when they
+ * fail. Use PHYSFS_getErrorByCode() for a message, if one is
+ * needed. Enable the path cache with SDL_PhysFS_SetPathCacheEnabled() to
+ * make repeated misses cheaper still.
+ *
+ * @code
+ * SDL_IOStream* io;
+ * if (SDL_PhysFS_TryOpen("mods/override.png", &io) == PHYSFS_ERR_OK) {
+ *     // ...
+ * }
+ * @endcode
+ *
+ * @param filename The filename to open.
+ * @param io Where to put the stream, which is closed with SDL_CloseIO(). Set to NULL on failure.
+ *
+ * @return A PHYSFS_ErrorCode: PHYSFS_ERR_OK on success, PHYSFS_ERR_NOT_FOUND if the file doesn't exist, or another PhysFS error.
+ *
+ * @see SDL_PhysFS_IOFromFile()
+ * @see SDL_PhysFS_TryLoadFile()
+ */
+int SDL_PhysFS_TryOpen(const char* filename, SDL_IOStream** io) {
+    if (filename == NULL || io == NULL) {
+        return (int)PHYSFS_ERR_INVALID_ARGUMENT;
+    }
+
+    SDL_PhysFS_BeginQuietProbe();
+    *io = SDL_PhysFS_IOFromFile(filename);
+    return (int)SDL_PhysFS_EndQuietProbe(*io != NULL);
+}
+
+/**
+ * Loads all the data from a file, if it exists, without reporting an error when it doesn't.
+ *
+ * This is SDL_PhysFS_LoadFile() for files that may well not exist. See SDL_PhysFS_TryOpen().
+ *
+ * @param filename The name of the file to load.
+ * @param data Where to put the null-terminated data, which is freed with SDL_free(). Set to NULL on failure.
+ * @param datasize Where to put the size of the file. Can be NULL.
+ *
+ * @return A PHYSFS_ErrorCode: PHYSFS_ERR_OK on success, PHYSFS_ERR_NOT_FOUND if the file doesn't exist, or another PhysFS error.
+ *
+ * @see SDL_PhysFS_LoadFile()
+ * @see SDL_PhysFS_TryOpen()
+ */
+int SDL_PhysFS_TryLoadFile(const char* filename, void** data, size_t* datasize) {
+    if (filename == NULL || data == NULL) {
+        return (int)PHYSFS_ERR_INVALID_ARGUMENT;
+    }
+
+    SDL_PhysFS_BeginQuietProbe();
+    *data = SDL_PhysFS_LoadFile(filename, datasize);
+    return (int)SDL_PhysFS_EndQuietProbe(*data != NULL);
+}
+
+/**
+ * A buffer returned by SDL_PhysFS_MapFile(), either a view of the backing file or a copy of its contents.
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_Mapping {
+    const void* data;
+    void* base;
+    size_t length;
+    struct SDL_PhysFS_Mapping* next;
+} SDL_PhysFS_Mapping;
+
+static SDL_PhysFS_Mapping* SDL_PhysFS_mappings = NULL;
+static SDL_SpinLock SDL_PhysFS_mappingsLock = 0;
+
+/**
+ * Finds the path relative to its mount point of a file within the search path.
+ *
+ * @return A pointer into filename, or NULL if the file isn't in realDir's mount point.
+ *
+ * @internal
+ */
+static const char* SDL_PhysFS_GetMountRelativePath(const char* filename, const char* realDir) {
+    const char* mountPoint = PHYSFS_getMountPoint(realDir);
+    if (mountPoint == NULL) {
+        return NULL;
+    }
+
+    while (*filename == '/') {
+        filename++;
+    }
+    while (*mountPoint == '/') {
+        mountPoint++;
+    }
+
+    size_t length = SDL_strlen(mountPoint);
+    if (SDL_strncmp(filename, mountPoint, length) != 0) {
+        return NULL;
+    }
+
+    return filename + length;
+}
+
+/**
+ * An entry from a zip archive's central directory.
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_ZipEntry {
+    const char* name;
+    size_t nameLength;
+    Uint16 flags;
+    Uint16 method;
+    Uint32 compressedSize;
+    Uint32 uncompressedSize;
+    Uint32 localOffset;
+} SDL_PhysFS_ZipEntry;
+
+/**
+ * Called for each entry in a zip archive's central directory. Return false to stop.
+ *
+ * @internal
+ */
+typedef bool (*SDL_PhysFS_ZipEntryCallback)(void* userdata, const SDL_PhysFS_ZipEntry* entry);
+
+/**
+ * Reads the central directory of a zip archive, calling back for each entry.
+ *
+ * The zip64 end of central directory record is read, for archives with more
+ * than 65535 entries, but entries that need zip64 sizes or offsets aren't
+ * supported, and report false.
+ *
+ * @return true if the central directory was read, false otherwise.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_EnumerateZipEntries(SDL_IOStream* io, SDL_PhysFS_ZipEntryCallback callback, void* userdata) {
+    // Find the end of central directory record, which may be followed by a comment.
+    bool found = false;
+    Sint64 length = SDL_GetIOSize(io);
+    Sint64 tailLength = SDL_min(length, (Sint64)(22 + 65535));
+    Uint8* tail = tailLength >= 22 ? (Uint8*)SDL_malloc((size_t)tailLength) : NULL;
+    Uint64 directoryOffset = 0;
+    Uint64 entries = 0;
+    Sint64 zip64Offset = -1;
+    if (tail != NULL && SDL_SeekIO(io, length - tailLength, SDL_IO_SEEK_SET) >= 0 && SDL_ReadIO(io, tail, (size_t)tailLength) == (size_t)tailLength) {
+        for (Sint64 i = tailLength - 22; i >= 0; i--) {
+            const Uint8* record = tail + i;
+            if (record[0] == 0x50 && record[1] == 0x4b && record[2] == 0x05 && record[3] == 0x06) {
+                entries = (Uint16)(record[10] | (record[11] << 8));
+                directoryOffset = (Uint32)record[16] | ((Uint32)record[17] << 8) | ((Uint32)record[18] << 16) | ((Uint32)record[19] << 24);
+                found = true;
+
+                // Counts that don't fit are in the zip64 record, found through the locator just before this one.
+                if ((entries == 0xFFFF || directoryOffset == 0xFFFFFFFF) && i >= 20 && SDL_PhysFS_ReadLE32(record - 20) == 0x07064b50) {
+                    zip64Offset = (Sint64)SDL_PhysFS_ReadLE64(record - 12);
+                }
+                break;
+            }
+        }
+    }
+    SDL_free(tail);
+
+    if (found && zip64Offset >= 0) {
+        Uint8 record[56];
+        if (SDL_SeekIO(io, zip64Offset, SDL_IO_SEEK_SET) < 0 || SDL_ReadIO(io, record, sizeof(record)) != sizeof(record) ||
+            SDL_PhysFS_ReadLE32(record) != 0x06064b50) {
+            return false;
+        }
+        entries = SDL_PhysFS_ReadLE64(record + 32);
+        directoryOffset = SDL_PhysFS_ReadLE64(record + 48);
+    }
+
+    if (!found || directoryOffset >= 0xFFFFFFFF || entries > 0xFFFFFFFF || SDL_SeekIO(io, (Sint64)directoryOffset, SDL_IO_SEEK_SET) < 0) {
+        return false;
+    }
+
+    // Zip names are at most 65535 bytes, so one buffer holds any of them.
+    char* name = (char*)SDL_malloc(0x10000);
+    if (name == NULL) {
+        return false;
+    }
+
+    bool result = true;
+    for (Uint32 i = 0; i < (Uint32)entries && result; i++) {
+        Uint32 signature, crc, skip32;
+        Uint16 version, needed, time, date, extraLength, commentLength, skip16, nameLength;
+        SDL_PhysFS_ZipEntry entry;
+        if (!SDL_ReadU32LE(io, &signature) || signature != 0x02014b50 ||
+            !SDL_ReadU16LE(io, &version) || !SDL_ReadU16LE(io, &needed) ||
+            !SDL_ReadU16LE(io, &entry.flags) || !SDL_ReadU16LE(io, &entry.method) ||
+            !SDL_ReadU16LE(io, &time) || !SDL_ReadU16LE(io, &date) ||
+            !SDL_ReadU32LE(io, &crc) || !SDL_ReadU32LE(io, &entry.compressedSize) || !SDL_ReadU32LE(io, &entry.uncompressedSize) ||
+            !SDL_ReadU16LE(io, &nameLength) || !SDL_ReadU16LE(io, &extraLength) || !SDL_ReadU16LE(io, &commentLength) ||
+            !SDL_ReadU16LE(io, &skip16) || !SDL_ReadU16LE(io, &skip16) || !SDL_ReadU32LE(io, &skip32) ||
+            !SDL_ReadU32LE(io, &entry.localOffset) ||
+            entry.compressedSize == 0xFFFFFFFF || entry.uncompressedSize == 0xFFFFFFFF || entry.localOffset == 0xFFFFFFFF ||
+            SDL_ReadIO(io, name, nameLength) != nameLength) {
+            result = false;
+            break;
+        }
+        name[nameLength] = '\0';
+        entry.name = name;
+        entry.nameLength = nameLength;
+
+        // The callback may use the stream, so remember where the next entry is.
+        Sint64 next = SDL_TellIO(io) + (Sint64)extraLength + commentLength;
+        if (!callback(userdata, &entry)) {
+            break;
+        }
+        result = SDL_SeekIO(io, next, SDL_IO_SEEK_SET) >= 0;
+    }
+    SDL_free(name);
+
+    return result;
+}
+
+/**
+ * Finds the offset of a zip entry's data within the archive, from its local header.
+ *
+ * @return true if there is a valid local header at localOffset, false otherwise.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_GetZipDataOffset(SDL_IOStream* io, Uint32 localOffset, Uint64* offset) {
+    // The local header's extra field can differ from the central directory's.
+    Uint8 header[30];
+    if (SDL_SeekIO(io, (Sint64)localOffset, SDL_IO_SEEK_SET) < 0 || SDL_ReadIO(io, header, sizeof(header)) != sizeof(header) ||
+        SDL_PhysFS_ReadLE32(header) != 0x04034b50) {
+        return false;
+    }
+    Uint16 nameLength = (Uint16)(header[26] | (header[27] << 8));
+    Uint16 extraLength = (Uint16)(header[28] | (header[29] << 8));
+
+    *offset = (Uint64)localOffset + 30 + nameLength + extraLength;
+    return true;
+}
+
+/**
+ * A file for a mount index, collected from a zip archive's central directory.
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_MountIndexEntry {
+    char* name;
+    Uint64 offset;
+    Uint64 size;
+} SDL_PhysFS_MountIndexEntry;
+
+/**
+ * The files collected for a mount index, by SDL_PhysFS_WriteMountIndex().
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_MountIndexBuilder {
+    SDL_IOStream* io;
+    SDL_PhysFS_MountIndexEntry* entries;
+    Uint32 count;
+    Uint32 capacity;
+    Uint64 stringsSize;
+    bool failed;
+} SDL_PhysFS_MountIndexBuilder;
+
+/**
+ * Zip entry callback for SDL_PhysFS_WriteMountIndex().
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_MountIndexCallback(void* userdata, const SDL_PhysFS_ZipEntry* entry) {
+    SDL_PhysFS_MountIndexBuilder* builder = (SDL_PhysFS_MountIndexBuilder*)userdata;
+
+    // Directories are implied by the paths of the files in them.
+    if (entry->nameLength == 0 || entry->name[entry->nameLength - 1] == '/') {
+        return true;
+    }
+
+    // Files are read straight from the archive, so they can't be compressed or encrypted.
+    if (entry->method != 0 || (entry->flags & 0x1) != 0 || entry->compressedSize != entry->uncompressedSize) {
+        SDL_SetError("%s is compressed or encrypted, so it can't be read through a mount index", entry->name);
+        builder->failed = true;
+        return false;
+    }
+    if (builder->count == builder->capacity) {
+        Uint32 capacity = builder->capacity > 0 ? builder->capacity * 2 : 256;
+        SDL_PhysFS_MountIndexEntry* entries = (SDL_PhysFS_MountIndexEntry*)SDL_realloc(builder->entries, sizeof(SDL_PhysFS_MountIndexEntry) * capacity);
+        if (entries == NULL) {
+            builder->failed = true;
+            return false;
+        }
+        builder->entries = entries;
+        builder->capacity = capacity;
+    }
+
+    SDL_PhysFS_MountIndexEntry* file = &builder->entries[builder->count];
+    if (!SDL_PhysFS_GetZipDataOffset(builder->io, entry->localOffset, &file->offset)) {
+        SDL_SetError("%s has no local header", entry->name);
+        builder->failed = true;
+        return false;
+    }
+    file->size = entry->uncompressedSize;
+    file->name = SDL_strdup(entry->name);
+    if (file->name == NULL) {
+        builder->failed = true;
+        return false;
+    }
+
+    builder->count++;
+    builder->stringsSize += entry->nameLength + 1;
+    return true;
+}
+
+static int SDLCALL SDL_PhysFS_CompareMountIndexEntries(const void* a, const void* b) {
+    return SDL_strcmp(((const SDL_PhysFS_MountIndexEntry*)a)->name, ((const SDL_PhysFS_MountIndexEntry*)b)->name);
+}
+
+/**
+ * Writes a mount index beside a zip archive, so SDL_PhysFS_Mount() can mount the archive without reading its central directory.
+ *
+ * The index holds the archive's paths as a sorted table, with the offset and
+ * size of each file's data, laid out to be searched as it's read, so mounting
+ * doesn't build anything. It's written to the archive's path with
+ * SDL_PHYSFS_MOUNT_INDEX_EXTENSION appended, and records the archive's size,
+ * modification time and a hash of its end, so SDL_PhysFS_Mount() ignores it
+ * once the archive changes.
+ *
+ * Files are read straight from the archive, so every entry must be stored
+ * rather than compressed.
+ *
+ * @param archive The zip archive, in platform-dependent notation.
+ *
+ * @return true on success, false otherwise.
+ *
+ * @see SDL_PhysFS_Mount()
+ */
+bool SDL_PhysFS_WriteMountIndex(const char* archive) {
+    SDL_PathInfo info;
+    if (archive == NULL) {
+        return SDL_InvalidParamError("archive");
+    }
+    if (!SDL_GetPathInfo(archive, &info)) {
+        return false;
+    }
+    SDL_IOStream* io = SDL_IOFromFile(archive, "rb");
+    if (io == NULL) {
+        return false;
+    }
+
+    SDL_PhysFS_MountIndexBuilder builder;
+    SDL_zero(builder);
+    builder.io = io;
+    Uint32 tailHash = 0;
+    bool result = SDL_PhysFS_EnumerateZipEntries(io, SDL_PhysFS_MountIndexCallback, &builder) && !builder.failed;
+    if (!result && !builder.failed) {
+        SDL_SetError("%s isn't a zip archive that can be indexed", archive);
+    }
+    if (result && !SDL_PhysFS_HashArchiveTail(io, info.size, &tailHash)) {
+        result = SDL_SetError("Failed to read the end of %s", archive);
+    }
+    SDL_CloseIO(io);
+
+    // Paths are found by a binary search, so each must be there once.
+    if (result) {
+        SDL_qsort(builder.entries, builder.count, sizeof(SDL_PhysFS_MountIndexEntry), SDL_PhysFS_CompareMountIndexEntries);
+        for (Uint32 i = 1; i < builder.count && result; i++) {
+            if (SDL_strcmp(builder.entries[i - 1].name, builder.entries[i].name) == 0) {
+                result = SDL_SetError("%s is in the archive more than once", builder.entries[i].name);
+            }
+        }
+    }
+    if (result && builder.stringsSize > 0xFFFFFFFF) {
+        result = SDL_SetError("%s has too many paths to index", archive);
+    }
+
+    // The index is built in memory and written at once.
+    Uint64 indexSize = SDL_PHYSFS_MOUNT_INDEX_HEADER_SIZE + (Uint64)builder.count * SDL_PHYSFS_MOUNT_INDEX_RECORD_SIZE + builder.stringsSize;
+    Uint8* index = result && indexSize <= SDL_SIZE_MAX ? (Uint8*)SDL_malloc((size_t)indexSize) : NULL;
+    SDL_IOStream* out = index != NULL ? SDL_IOFromMem(index, (size_t)indexSize) : NULL;
+    if (out != NULL) {
+        SDL_WriteIO(out, SDL_PHYSFS_MOUNT_INDEX_MAGIC, 8);
+        SDL_WriteU32LE(out, SDL_PHYSFS_MOUNT_INDEX_VERSION);
+        SDL_WriteU32LE(out, builder.count);
+        SDL_WriteU32LE(out, (Uint32)builder.stringsSize);
+        SDL_WriteU32LE(out, tailHash);
+        SDL_WriteU64LE(out, info.size);
+        SDL_WriteU64LE(out, (Uint64)info.modify_time);
+        Uint32 nameOffset = 0;
+        for (Uint32 i = 0; i < builder.count; i++) {
+            Uint32 nameLength = (Uint32)SDL_strlen(builder.entries[i].name);
+            SDL_WriteU64LE(out, builder.entries[i].offset);
+            SDL_WriteU64LE(out, builder.entries[i].size);
+            SDL_WriteU32LE(out, nameOffset);
+            SDL_WriteU32LE(out, nameLength);
+            nameOffset += nameLength + 1;
+        }
+        for (Uint32 i = 0; i < builder.count; i++) {
+            SDL_WriteIO(out, builder.entries[i].name, SDL_strlen(builder.entries[i].name) + 1);
+        }
+        result = SDL_TellIO(out) == (Sint64)indexSize;
+        SDL_CloseIO(out);
+    }
+    else {
+        result = false;
+    }
+
+    for (Uint32 i = 0; i < builder.count; i++) {
+        SDL_free(builder.entries[i].name);
+    }
+    SDL_free(builder.entries);
+
+    // Write beside the archive, then move it into place, so a mount never finds part of an index.
+    char* path = NULL;
+    char* temp = NULL;
+    if (result) {
+        result = SDL_asprintf(&path, "%s%s", archive, SDL_PHYSFS_MOUNT_INDEX_EXTENSION) > 0 &&
+            SDL_asprintf(&temp, "%s.tmp", path) > 0 &&
+            SDL_SaveFile(temp, index, (size_t)indexSize);
+        if (result && !SDL_RenamePath(temp, path)) {
+            SDL_RemovePath(temp);
+            result = false;
+        }
+    }
+    SDL_free(temp);
+    SDL_free(path);
+    SDL_free(index);
+
+    return result;
+}
+
+/**
+ * An entry of a zip archive on disk, from its central directory.
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_ZipIndexEntry {
+    Uint32 localOffset;
+    Uint32 size;
+    Uint64 dataOffset;
+    bool stored;
+} SDL_PhysFS_ZipIndexEntry;
+
+/**
+ * The files in a zip archive on disk, by name. The value of each name is its entry's index, plus one so that it's never NULL.
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_ZipIndex {
+    SDL_PhysFS_ZipIndexEntry* entries;
+    int count;
+    int capacity;
+    SDL_PhysFS_HashTable names;
+} SDL_PhysFS_ZipIndex;
+
+/**
+ * A thread's own handles on the archives it has read from in parallel.
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_ParallelReader {
+    SDL_SpinLock lock;
+    Uint32 generation;
+    char** archives;
+    SDL_IOStream** handles;
+    int count;
+    struct SDL_PhysFS_ParallelReader* next;
+} SDL_PhysFS_ParallelReader;
+
+/**
+ * The zip archives on disk that have been indexed, keyed by their real path.
+ * Directories and archives that can't be read directly are kept with a NULL value.
+ *
+ * The indexes are rebuilt whenever the path cache is cleared, which mounting and unmounting do.
+ *
+ * @internal
+ */
+static struct {
+    SDL_SpinLock lock;
+    Uint32 generation;
+    SDL_PhysFS_HashTable archives;
+} SDL_PhysFS_zipIndexes = { 0, 0, { NULL, 0, 0 } };
+
+/**
+ * The state of SDL_PhysFS_SetParallelReads(), with every thread's reader, so they can all be closed.
+ *
+ * @internal
+ */
+static struct {
+    SDL_SpinLock lock;
+    SDL_AtomicInt enabled;
+    SDL_TLSID readers;
+    SDL_PhysFS_ParallelReader* all;
+} SDL_PhysFS_parallelReads = { 0, { 0 }, { 0 }, NULL };
+
+static void SDL_PhysFS_FreeZipIndex(SDL_PhysFS_ZipIndex* index) {
+    if (index == NULL) {
+        return;
+    }
+
+    SDL_PhysFS_HashClear(&index->names);
+    SDL_free(index->entries);
+    SDL_free(index);
+}
+
+/**
+ * Frees every zip archive index. The caller holds the lock.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_ClearZipIndexes(void) {
+    SDL_PhysFS_HashTable* table = &SDL_PhysFS_zipIndexes.archives;
+    for (Uint32 i = 0; i < table->numBuckets; i++) {
+        for (SDL_PhysFS_HashEntry* entry = table->buckets[i]; entry != NULL; entry = entry->next) {
+            SDL_PhysFS_FreeZipIndex((SDL_PhysFS_ZipIndex*)entry->value);
+        }
+    }
+    SDL_PhysFS_HashClear(table);
+}
+
+/**
+ * Frees every zip archive index, for SDL_PhysFS_Quit().
+ *
+ * @internal
+ */
+static void SDL_PhysFS_FreeZipIndexes(void) {
+    SDL_LockSpinlock(&SDL_PhysFS_zipIndexes.lock);
+    SDL_PhysFS_ClearZipIndexes();
+    SDL_UnlockSpinlock(&SDL_PhysFS_zipIndexes.lock);
+}
+
+/**
+ * SDL_PhysFS_ZipEntryCallback that indexes each file.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_ZipIndexCallback(void* userdata, const SDL_PhysFS_ZipEntry* entry) {
+    SDL_PhysFS_ZipIndex* index = (SDL_PhysFS_ZipIndex*)userdata;
+    if (entry->nameLength == 0 || entry->name[entry->nameLength - 1] == '/') {
+        return true;
+    }
+
+    if (index->count == index->capacity) {
+        int capacity = index->capacity > 0 ? index->capacity * 2 : 64;
+        SDL_PhysFS_ZipIndexEntry* entries = (SDL_PhysFS_ZipIndexEntry*)SDL_realloc(index->entries, sizeof(SDL_PhysFS_ZipIndexEntry) * (size_t)capacity);
+        if (entries == NULL) {
+            return false;
+        }
+        index->entries = entries;
+        index->capacity = capacity;
+    }
+
+    if (SDL_PhysFS_HashInsert(&index->names, entry->name, SDL_PhysFS_Hash(entry->name), (const void*)(uintptr_t)(index->count + 1)) == NULL) {
+        return false;
+    }
+
+    // Only stored entries that aren't encrypted can be read without PhysFS.
+    SDL_PhysFS_ZipIndexEntry* indexEntry = &index->entries[index->count++];
+    indexEntry->localOffset = entry->localOffset;
+    indexEntry->size = entry->uncompressedSize;
+    indexEntry->dataOffset = 0;
+    indexEntry->stored = entry->method == 0 && (entry->flags & 0x1) == 0 && entry->compressedSize == entry->uncompressedSize;
+
+    return true;
+}
+
+/**
+ * Indexes a zip archive on disk.
+ *
+ * @return The index, or NULL if it's not a zip archive mounted from disk by SDL_PhysFS_Mount().
+ *
+ * @internal
+ */
+static SDL_PhysFS_ZipIndex* SDL_PhysFS_BuildZipIndex(const char* realDir) {
+    if (SDL_PhysFS_GetMountedPathType(realDir) != SDL_PATHTYPE_FILE) {
+        return NULL;
+    }
+
+    SDL_IOStream* io = SDL_IOFromFile(realDir, "rb");
+    SDL_PhysFS_ZipIndex* index = (SDL_PhysFS_ZipIndex*)SDL_calloc(1, sizeof(SDL_PhysFS_ZipIndex));
+    if (io == NULL || index == NULL) {
+        if (io != NULL) {
+            SDL_CloseIO(io);
+        }
+        SDL_free(index);
+        return NULL;
+    }
+
+    bool result = SDL_PhysFS_EnumerateZipEntries(io, SDL_PhysFS_ZipIndexCallback, index);
+    SDL_CloseIO(io);
+    if (!result) {
+        SDL_PhysFS_FreeZipIndex(index);
+        return NULL;
+    }
+
+    return index;
+}
+
+/**
+ * Gets the path cache's generation, which changes whenever the search path does.
+ *
+ * @internal
+ */
+static Uint32 SDL_PhysFS_GetPathCacheGeneration(void) {
+    SDL_LockSpinlock(&SDL_PhysFS_pathCache.lock);
+    Uint32 generation = SDL_PhysFS_pathCache.generation;
+    SDL_UnlockSpinlock(&SDL_PhysFS_pathCache.lock);
+    return generation;
+}
+
+/**
+ * Looks up a file in the index of the zip archive on disk that provides it, indexing the archive if it's new.
+ *
+ * @param realDir The directory or archive that provides the file, from SDL_PhysFS_GetRealDir().
+ * @param relative The file's path within it.
+ * @param generation The path cache's generation when realDir was resolved.
+ * @param result Where to copy the file's entry.
+ *
+ * @return true if realDir is a zip archive on disk with that file in it, false otherwise.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_FindZipIndexEntry(const char* realDir, const char* relative, Uint32 generation, SDL_PhysFS_ZipIndexEntry* result) {
+    Uint32 hash = SDL_PhysFS_Hash(realDir);
+    SDL_LockSpinlock(&SDL_PhysFS_zipIndexes.lock);
+    if (SDL_PhysFS_zipIndexes.generation != generation) {
+        SDL_PhysFS_ClearZipIndexes();
+        SDL_PhysFS_zipIndexes.generation = generation;
+    }
+    bool indexed = SDL_PhysFS_HashFind(&SDL_PhysFS_zipIndexes.archives, realDir, hash) != NULL;
+    SDL_UnlockSpinlock(&SDL_PhysFS_zipIndexes.lock);
+
+    // Index the archive outside of the lock, as it reads the whole central directory.
+    if (!indexed) {
+        SDL_PhysFS_ZipIndex* index = SDL_PhysFS_BuildZipIndex(realDir);
+        SDL_LockSpinlock(&SDL_PhysFS_zipIndexes.lock);
+        if (SDL_PhysFS_zipIndexes.generation != generation ||
+            SDL_PhysFS_HashFind(&SDL_PhysFS_zipIndexes.archives, realDir, hash) != NULL ||
+            SDL_PhysFS_HashInsert(&SDL_PhysFS_zipIndexes.archives, realDir, hash, index) == NULL) {
+            SDL_PhysFS_FreeZipIndex(index);
+        }
+        SDL_UnlockSpinlock(&SDL_PhysFS_zipIndexes.lock);
+    }
+
+    bool found = false;
+    SDL_LockSpinlock(&SDL_PhysFS_zipIndexes.lock);
+    SDL_PhysFS_HashEntry* entry = SDL_PhysFS_zipIndexes.generation == generation ? SDL_PhysFS_HashFind(&SDL_PhysFS_zipIndexes.archives, realDir, hash) : NULL;
+    SDL_PhysFS_ZipIndex* index = entry != NULL ? (SDL_PhysFS_ZipIndex*)entry->value : NULL;
+    SDL_PhysFS_HashEntry* name = index != NULL ? SDL_PhysFS_HashFind(&index->names, relative, SDL_PhysFS_Hash(relative)) : NULL;
+    if (name != NULL) {
+        *result = index->entries[(uintptr_t)name->value - 1];
+        found = true;
+    }
+    SDL_UnlockSpinlock(&SDL_PhysFS_zipIndexes.lock);
+
+    return found;
+}
+
+/**
+ * Finds where a zip entry's data starts, from its local header, remembering it in the archive's index.
+ *
+ * @return true if the entry's local header is valid, false otherwise.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_ResolveZipDataOffset(SDL_IOStream* io, const char* realDir, const char* relative, Uint32 generation, SDL_PhysFS_ZipIndexEntry* entry) {
+    if (entry->dataOffset != 0) {
+        return true;
+    }
+    if (!SDL_PhysFS_GetZipDataOffset(io, entry->localOffset, &entry->dataOffset)) {
+        return false;
+    }
+
+    SDL_LockSpinlock(&SDL_PhysFS_zipIndexes.lock);
+    SDL_PhysFS_HashEntry* archive = SDL_PhysFS_zipIndexes.generation == generation ? SDL_PhysFS_HashFind(&SDL_PhysFS_zipIndexes.archives, realDir, SDL_PhysFS_Hash(realDir)) : NULL;
+    SDL_PhysFS_ZipIndex* index = archive != NULL ? (SDL_PhysFS_ZipIndex*)archive->value : NULL;
+    SDL_PhysFS_HashEntry* name = index != NULL ? SDL_PhysFS_HashFind(&index->names, relative, SDL_PhysFS_Hash(relative)) : NULL;
+    if (name != NULL) {
+        index->entries[(uintptr_t)name->value - 1].dataOffset = entry->dataOffset;
+    }
+    SDL_UnlockSpinlock(&SDL_PhysFS_zipIndexes.lock);
+
+    return true;
+}
+
+/**
+ * Closes a reader's archive handles. The reader's lock must be held.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_CloseParallelHandles(SDL_PhysFS_ParallelReader* reader) {
+    for (int i = 0; i < reader->count; i++) {
+        SDL_CloseIO(reader->handles[i]);
+        SDL_free(reader->archives[i]);
+    }
+    reader->count = 0;
+}
+
+/**
+ * SDL_TLSDestructorCallback closing a thread's archive handles when it exits.
+ *
+ * @internal
+ */
+static void SDLCALL SDL_PhysFS_FreeParallelReader(void* value) {
+    SDL_PhysFS_ParallelReader* reader = (SDL_PhysFS_ParallelReader*)value;
+    SDL_LockSpinlock(&SDL_PhysFS_parallelReads.lock);
+    SDL_PhysFS_ParallelReader** link = &SDL_PhysFS_parallelReads.all;
+    while (*link != reader) {
+        link = &(*link)->next;
+    }
+    *link = reader->next;
+    SDL_UnlockSpinlock(&SDL_PhysFS_parallelReads.lock);
+
+    SDL_PhysFS_CloseParallelHandles(reader);
+    SDL_free(reader->archives);
+    SDL_free(reader->handles);
+    SDL_free(reader);
+}
+
+/**
+ * Gets the calling thread's reader, creating it the first time.
+ *
+ * @internal
+ */
+static SDL_PhysFS_ParallelReader* SDL_PhysFS_GetParallelReader(void) {
+    SDL_PhysFS_ParallelReader* reader = (SDL_PhysFS_ParallelReader*)SDL_GetTLS(&SDL_PhysFS_parallelReads.readers);
+    if (reader != NULL) {
+        return reader;
+    }
+
+    reader = (SDL_PhysFS_ParallelReader*)SDL_calloc(1, sizeof(SDL_PhysFS_ParallelReader));
+    if (reader == NULL) {
+        return NULL;
+    }
+    SDL_LockSpinlock(&SDL_PhysFS_parallelReads.lock);
+    reader->next = SDL_PhysFS_parallelReads.all;
+    SDL_PhysFS_parallelReads.all = reader;
+    SDL_UnlockSpinlock(&SDL_PhysFS_parallelReads.lock);
+    if (!SDL_SetTLS(&SDL_PhysFS_parallelReads.readers, reader, SDL_PhysFS_FreeParallelReader)) {
+        SDL_PhysFS_FreeParallelReader(reader);
+        return NULL;
+    }
+
+    return reader;
+}
+
+/**
+ * Finds a reader's handle on an archive, opening it if needed. The reader's lock must be held.
+ *
+ * @internal
+ */
+static SDL_IOStream* SDL_PhysFS_GetParallelHandle(SDL_PhysFS_ParallelReader* reader, const char* archive, Uint32 generation) {
+    // The archives may have changed since the handles were opened.
+    if (reader->generation != generation) {
+        SDL_PhysFS_CloseParallelHandles(reader);
+        reader->generation = generation;
+    }
+
+    for (int i = 0; i < reader->count; i++) {
+        if (SDL_strcmp(reader->archives[i], archive) == 0) {
+            return reader->handles[i];
+        }
+    }
+
+    char** archives = (char**)SDL_realloc(reader->archives, sizeof(char*) * (size_t)(reader->count + 1));
+    if (archives == NULL) {
+        return NULL;
+    }
+    reader->archives = archives;
+    SDL_IOStream** handles = (SDL_IOStream**)SDL_realloc(reader->handles, sizeof(SDL_IOStream*) * (size_t)(reader->count + 1));
+    if (handles == NULL) {
+        return NULL;
+    }
+    reader->handles = handles;
+
+    SDL_IOStream* io = SDL_IOFromFile(archive, "rb");
+    char* name = SDL_strdup(archive);
+    if (io == NULL || name == NULL) {
+        if (io != NULL) {
+            SDL_CloseIO(io);
+        }
+        SDL_free(name);
+        return NULL;
+    }
+    reader->archives[reader->count] = name;
+    reader->handles[reader->count] = io;
+    reader->count++;
+
+    return io;
+}
+
+/**
+ * Loads a stored zip entry through the calling thread's own handle on the archive, without taking PhysFS's lock.
+ *
+ * The data is null-terminated, and placed after header bytes left for the caller.
+ *
+ * @return The block holding the file's data, or NULL if parallel reads are disabled, the file is larger than maxSize or it can't be read this way. No error is set.
+ *
+ * @internal
+ */
+static void* SDL_PhysFS_ParallelLoadFile(const char* filename, size_t header, size_t maxSize, size_t* datasize) {
+    if (SDL_GetAtomicInt(&SDL_PhysFS_parallelReads.enabled) == 0) {
+        return NULL;
+    }
+
+    Uint32 generation = SDL_PhysFS_GetPathCacheGeneration();
+    const char* realDir = SDL_PhysFS_GetRealDir(filename);
+    const char* relative = realDir != NULL ? SDL_PhysFS_GetMountRelativePath(filename, realDir) : NULL;
+    if (relative == NULL) {
+        return NULL;
+    }
+    while (*relative == '/') {
+        relative++;
+    }
+
+    SDL_PhysFS_ZipIndexEntry entry;
+    if (!SDL_PhysFS_FindZipIndexEntry(realDir, relative, generation, &entry) || !entry.stored || entry.size > maxSize) {
+        return NULL;
+    }
+    SDL_PhysFS_ParallelReader* reader = SDL_PhysFS_GetParallelReader();
+    if (reader == NULL) {
+        return NULL;
+    }
+    Uint8* block = (Uint8*)SDL_malloc(header + (size_t)entry.size + 1);
+    if (block == NULL) {
+        return NULL;
+    }
+
+    // Parallel reads are checked again under the reader's lock, so no handle is opened after they're disabled.
+    SDL_LockSpinlock(&reader->lock);
+    SDL_IOStream* io = SDL_GetAtomicInt(&SDL_PhysFS_parallelReads.enabled) != 0 ? SDL_PhysFS_GetParallelHandle(reader, realDir, generation) : NULL;
+    bool loaded = io != NULL && SDL_PhysFS_ResolveZipDataOffset(io, realDir, relative, generation, &entry) &&
+        SDL_SeekIO(io, (Sint64)entry.dataOffset, SDL_IO_SEEK_SET) >= 0 && SDL_ReadIO(io, block + header, entry.size) == entry.size;
+    SDL_UnlockSpinlock(&reader->lock);
+    if (!loaded) {
+        SDL_free(block);
+        return NULL;
+    }
+    block[header + entry.size] = '\0';
+
+    if (datasize != NULL) {
+        *datasize = entry.size;
+    }
+    return block;
+}
+
+/**
+ * Enables or disables parallel reads from zip archives.
+ *
+ * Opening a file through PhysFS holds its global lock, so threads loading
+ * many small files from the same archive mostly wait on each other. With
+ * parallel reads, SDL_PhysFS_LoadFile() reads stored entries of zip archives
+ * on disk through a handle on the archive that each thread opens for itself,
+ * with no PhysFS lock held. Archives are indexed the first time they're read
+ * from. Compressed entries, and files in directories, are still loaded
+ * through PhysFS, which gives each open file its own decompression state.
+ *
+ * Archives built with sdl_physfs_pack store formats that are already compressed, which makes them a good fit.
+ *
+ * With the content cache enabled, files are read in parallel when they miss
+ * the cache and are small enough for it; larger files are read through
+ * PhysFS. Disabling parallel reads closes the archive handles of every
+ * thread.
+ *
+ * Parallel reads are disabled by default.
+ *
+ * @param enabled Whether to read stored zip entries in parallel.
+ *
+ * @see SDL_PhysFS_LoadFile()
+ */
+void SDL_PhysFS_SetParallelReads(bool enabled) {
+    SDL_LockSpinlock(&SDL_PhysFS_parallelReads.lock);
+    SDL_SetAtomicInt(&SDL_PhysFS_parallelReads.enabled, enabled ? 1 : 0);
+
+    // Every thread's handles are closed now. The readers themselves are freed as their threads exit.
+    if (!enabled) {
+        for (SDL_PhysFS_ParallelReader* reader = SDL_PhysFS_parallelReads.all; reader != NULL; reader = reader->next) {
+            SDL_LockSpinlock(&reader->lock);
+            SDL_PhysFS_CloseParallelHandles(reader);
+            SDL_UnlockSpinlock(&reader->lock);
+        }
+    }
+    SDL_UnlockSpinlock(&SDL_PhysFS_parallelReads.lock);
+}
+
+#ifdef SDL_PHYSFS_MMAP
+/**
+ * Maps a range of a file on disk into memory as read-only.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_MapRange(const char* path, Uint64 offset, Uint64 size, SDL_PhysFS_Mapping* mapping) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    // Touching a page past the end of the file raises SIGBUS, so the range has to be within it.
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < 0 || offset > (Uint64)info.st_size || size > (Uint64)info.st_size - offset) {
+        close(fd);
+        return false;
+    }
+
+    // The mapping has to start on a page boundary.
+    Uint64 pageSize = (Uint64)sysconf(_SC_PAGESIZE);
+    Uint64 start = offset - (offset % pageSize);
+    size_t length = (size_t)(size + (offset - start));
+    void* base = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, (off_t)start);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+
+    mapping->base = base;
+    mapping->length = length;
+    mapping->data = (const Uint8*)base + (offset - start);
+    return true;
+}
+
+/**
+ * Attempts to map a file from the search path directly from its backing directory or archive.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_MapFromDisk(const char* filename, SDL_PhysFS_Mapping* mapping, size_t* datasize) {
+    Uint32 generation = SDL_PhysFS_GetPathCacheGeneration();
+    const char* realDir = SDL_PhysFS_GetRealDir(filename);
+    if (realDir == NULL) {
+        return false;
+    }
+
+    const char* relative = SDL_PhysFS_GetMountRelativePath(filename, realDir);
+    if (relative == NULL) {
+        return false;
+    }
+
+    while (*relative == '/') {
+        relative++;
+    }
+
+    // A file in a mounted directory is mapped whole.
+    if (SDL_PhysFS_GetMountedPathType(realDir) == SDL_PATHTYPE_DIRECTORY) {
+        char* path = NULL;
+        size_t realDirLength = SDL_strlen(realDir);
+        bool hasSeparator = realDirLength > 0 && realDir[realDirLength - 1] == '/';
+        if (SDL_asprintf(&path, "%s%s%s", realDir, hasSeparator ? "" : "/", relative) < 0) {
+            return false;
+        }
+
+        SDL_PathInfo fileInfo;
+        bool result = SDL_GetPathInfo(path, &fileInfo) && fileInfo.type == SDL_PATHTYPE_FILE && fileInfo.size > 0 &&
+            SDL_PhysFS_MapRange(path, 0, fileInfo.size, mapping);
+        SDL_free(path);
+        if (result) {
+            *datasize = (size_t)fileInfo.size;
+        }
+        return result;
+    }
+
+    // A stored zip entry is mapped from its offset in the archive, found through the archive's index.
+    SDL_PhysFS_ZipIndexEntry entry;
+    if (!SDL_PhysFS_FindZipIndexEntry(realDir, relative, generation, &entry) || !entry.stored || entry.size == 0) {
+        return false;
+    }
+    if (entry.dataOffset == 0) {
+        SDL_IOStream* io = SDL_IOFromFile(realDir, "rb");
+        bool resolved = io != NULL && SDL_PhysFS_ResolveZipDataOffset(io, realDir, relative, generation, &entry);
+        if (io != NULL) {
+            SDL_CloseIO(io);
+        }
+        if (!resolved) {
+            return false;
+        }
+    }
+    if (!SDL_PhysFS_MapRange(realDir, entry.dataOffset, entry.size, mapping)) {
+        return false;
+    }
+
+    *datasize = entry.size;
+    return true;
+}
+#endif
+
+/**
+ * Maps a file from PhysFS into read-only memory.
+ *
+ * Files in mounted directories and uncompressed entries in zip archives on
+ * disk are memory mapped, so they are read from the page cache without a heap
+ * copy. Anything else, such as compressed entries, is loaded with
+ * SDL_PhysFS_LoadFile(). Either way, the data must be released with
+ * SDL_PhysFS_UnmapFile().
+ *
+ * @param filename The name of the file to map.
+ * @param datasize Where to put the resulting size of the file.
+ *
+ * @return A read-only view of the file's data. NULL on failure, use SDL_GetError() for details.
+ *
+ * @see SDL_PhysFS_UnmapFile()
+ * @see SDL_PhysFS_LoadFile()
+ */
+const void* SDL_PhysFS_MapFile(const char* filename, size_t *datasize) {
+    if (filename == NULL) {
+        SDL_InvalidParamError("filename");
+        return NULL;
+    }
+
+    SDL_PhysFS_Mapping* mapping = (SDL_PhysFS_Mapping*)SDL_calloc(1, sizeof(SDL_PhysFS_Mapping));
+    if (mapping == NULL) {
+        return NULL;
+    }
+
+    size_t size = 0;
+#ifdef SDL_PHYSFS_MMAP
+    bool mapped = SDL_PhysFS_MapFromDisk(filename, mapping, &size);
+#else
+    bool mapped = false;
+#endif
+    if (!mapped) {
+        mapping->data = SDL_PhysFS_LoadFile(filename, &size);
+        if (mapping->data == NULL) {
+            SDL_free(mapping);
+            if (datasize != NULL) {
+                *datasize = 0;
+            }
+            return NULL;
+        }
+    }
+
+    SDL_LockSpinlock(&SDL_PhysFS_mappingsLock);
+    mapping->next = SDL_PhysFS_mappings;
+    SDL_PhysFS_mappings = mapping;
+    SDL_UnlockSpinlock(&SDL_PhysFS_mappingsLock);
+
+    if (datasize != NULL) {
+        *datasize = size;
+    }
+
+    return mapping->data;
+}
+
+/**
+ * Releases data returned by SDL_PhysFS_MapFile().
+ *
+ * @param data The data returned by SDL_PhysFS_MapFile().
+ *
+ * @see SDL_PhysFS_MapFile()
+ */
+void SDL_PhysFS_UnmapFile(const void* data) {
+    if (data == NULL) {
+        return;
+    }
+
+    SDL_PhysFS_Mapping* mapping = NULL;
+    SDL_LockSpinlock(&SDL_PhysFS_mappingsLock);
+    for (SDL_PhysFS_Mapping** it = &SDL_PhysFS_mappings; *it != NULL; it = &(*it)->next) {
+        if ((*it)->data == data) {
+            mapping = *it;
+            *it = mapping->next;
+            break;
+        }
+    }
+    SDL_UnlockSpinlock(&SDL_PhysFS_mappingsLock);
+
+    if (mapping == NULL) {
+        SDL_InvalidParamError("data");
+        return;
+    }
+
+#ifdef SDL_PHYSFS_MMAP
+    if (mapping->base != NULL) {
+        munmap(mapping->base, mapping->length);
+    }
+    else
+#endif
+    {
+        SDL_free((void*)mapping->data);
+    }
+
+    SDL_free(mapping);
+}
+
+/**
+ * A file requested from SDL_PhysFS_LoadFiles().
+ *
+ * Files found in the index of a zip archive on disk have its offset, and
+ * stored ones are read straight from the archive. Files in the content cache
+ * hold a reference to it, and are copied from memory.
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_BatchItem {
+    int index;
+    int group;
+    const char* relative;
+    Uint64 offset;
+    PHYSFS_sint64 size;
+    SDL_PhysFS_ZipIndexEntry entry;
+    SDL_PhysFS_CachedFile* cached;
+    bool indexed;
+} SDL_PhysFS_BatchItem;
+
+/**
+ * Releases the cached files held by batch items, and frees them.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_FreeBatchItems(SDL_PhysFS_BatchItem* items, int count) {
+    for (int i = 0; i < count; i++) {
+        if (items[i].cached != NULL) {
+            SDL_PhysFS_ReleaseCachedFile(items[i].cached);
+        }
+    }
+
+    SDL_free(items);
+}
+
+/**
+ * Orders batch items by their backing directory or archive, and then their location within it.
+ *
+ * @internal
+ */
+static int SDLCALL SDL_PhysFS_CompareBatchItems(const void* a, const void* b) {
+    const SDL_PhysFS_BatchItem* itemA = (const SDL_PhysFS_BatchItem*)a;
+    const SDL_PhysFS_BatchItem* itemB = (const SDL_PhysFS_BatchItem*)b;
+    if (itemA->group != itemB->group) {
+        return itemA->group < itemB->group ? -1 : 1;
+    }
+    if (itemA->offset != itemB->offset) {
+        return itemA->offset < itemB->offset ? -1 : 1;
+    }
+    if (itemA->relative != NULL && itemB->relative != NULL) {
+        return SDL_strcmp(itemA->relative, itemB->relative);
+    }
+
+    return itemA->index - itemB->index;
+}
+
+/**
+ * Reads a stored zip entry for SDL_PhysFS_LoadFiles(), straight from the archive.
+ *
+ * @return The number of bytes read, or -1 if the entry has to be read through PhysFS.
+ *
+ * @internal
+ */
+static PHYSFS_sint64 SDL_PhysFS_ReadBatchEntry(SDL_IOStream* archive, const char* realDir, SDL_PhysFS_BatchItem* item, Uint32 generation, char* buffer) {
+    if (archive == NULL || !SDL_PhysFS_ResolveZipDataOffset(archive, realDir, item->relative, generation, &item->entry) ||
+        SDL_SeekIO(archive, (Sint64)item->entry.dataOffset, SDL_IO_SEEK_SET) < 0 ||
+        SDL_ReadIO(archive, buffer, item->entry.size) != item->entry.size) {
+        return -1;
+    }
+
+    return item->entry.size;
+}
+
+/**
+ * Loads the data from many files at once, into a single allocation.
+ *
+ * All the files are resolved first, then read grouped by the directory or
+ * archive they live in, and in the order they're stored within zip archives,
+ * so the backing storage is swept forwards rather than read at random. Zip
+ * archives on disk are indexed the first time they're loaded from, and the
+ * index is kept until the search path changes, so files in them are sized
+ * without asking PhysFS. Their stored entries are read straight from the
+ * archive.
+ *
+ * Like SDL_PhysFS_LoadFile(), files in the content cache are copied from
+ * memory, loads are counted in the stats and access recording, and each
+ * buffer is null-terminated. Files that couldn't be loaded get a NULL buffer
+ * and a size of 0.
+ *
+ * @code
+ * const char* names[] = { "res/a.txt", "res/b.txt" };
+ * void* buffers[2];
+ * size_t sizes[2];
+ * void* block = SDL_PhysFS_LoadFiles(names, 2, buffers, sizes);
+ * // ...
+ * SDL_free(block);
+ * @endcode
+ *
+ * @param filenames The names of the files to load.
+ * @param count The number of files in filenames.
+ * @param buffers Where to put a pointer to each file's data, in the same order as filenames.
+ * @param sizes Where to put each file's size. Can be NULL.
+ *
+ * @return The single allocation holding every buffer, which must be freed with SDL_free(). NULL on failure, use SDL_GetError() for details.
+ *
+ * @see SDL_PhysFS_LoadFile()
+ */
+void* SDL_PhysFS_LoadFiles(const char** filenames, int count, void** buffers, size_t* sizes) {
+    if (filenames == NULL || count <= 0 || buffers == NULL) {
+        SDL_InvalidParamError("filenames, count or buffers");
+        return NULL;
+    }
+
+    SDL_PhysFS_BatchItem* items = (SDL_PhysFS_BatchItem*)SDL_calloc((size_t)count, sizeof(SDL_PhysFS_BatchItem));
+    const char** groups = (const char**)SDL_malloc(sizeof(const char*) * (size_t)count);
+    if (items == NULL || groups == NULL) {
+        SDL_free(items);
+        SDL_free(groups);
+        return NULL;
+    }
+
+    // Resolve where each file lives, and how large it is, from the archive's index when there is one.
+    Uint32 generation = SDL_PhysFS_GetPathCacheGeneration();
+    int numGroups = 0;
+    size_t total = 0;
+    for (int i = 0; i < count; i++) {
+        SDL_PhysFS_BatchItem* item = &items[i];
+        const char* realDir = filenames[i] != NULL ? SDL_PhysFS_GetRealDir(filenames[i]) : NULL;
+        item->index = i;
+        item->size = -1;
+        buffers[i] = NULL;
+        if (sizes != NULL) {
+            sizes[i] = 0;
+        }
+        item->relative = realDir != NULL ? SDL_PhysFS_GetMountRelativePath(filenames[i], realDir) : NULL;
+        while (item->relative != NULL && *item->relative == '/') {
+            item->relative++;
+        }
+
+        // Cached files are copied from memory, and misses are added to it, like SDL_PhysFS_LoadFile().
+        if (realDir != NULL && SDL_PhysFS_ContentCacheEnabled()) {
+            PHYSFS_File* handle;
+            item->cached = SDL_PhysFS_ContentCacheLoad(filenames[i], &handle);
+            if (handle != NULL) {
+                PHYSFS_close(handle);
+            }
+        }
+
+        PHYSFS_Stat stat;
+        if (item->cached != NULL) {
+            item->size = (PHYSFS_sint64)item->cached->size;
+        }
+        else if (item->relative != NULL && SDL_PhysFS_FindZipIndexEntry(realDir, item->relative, generation, &item->entry)) {
+            item->indexed = true;
+            item->offset = item->entry.localOffset;
+            item->size = item->entry.size;
+        }
+        else if (realDir != NULL && PHYSFS_stat(filenames[i], &stat) != 0 && stat.filetype == PHYSFS_FILETYPE_REGULAR && stat.filesize >= 0) {
+            item->size = stat.filesize;
+        }
+        if (item->size < 0) {
+            item->group = count;
+            continue;
+        }
+        if ((PHYSFS_uint64)item->size >= (PHYSFS_uint64)(SIZE_MAX - total)) {
+            SDL_PhysFS_FreeBatchItems(items, count);
+            SDL_free(groups);
+            SDL_SetError("Files are too large to load at once");
+            return NULL;
+        }
+        total += (size_t)item->size + 1;
+
+        item->group = 0;
+        while (item->group < numGroups && SDL_strcmp(groups[item->group], realDir) != 0) {
+            item->group++;
+        }
+        if (item->group == numGroups) {
+            groups[numGroups++] = realDir;
+        }
+    }
+
+    // Read files in the order they're stored in each archive.
+    SDL_qsort(items, (size_t)count, sizeof(SDL_PhysFS_BatchItem), SDL_PhysFS_CompareBatchItems);
+
+    char* block = (char*)SDL_malloc(total > 0 ? total : 1);
+    if (block == NULL) {
+        SDL_PhysFS_FreeBatchItems(items, count);
+        SDL_free(groups);
+        return NULL;
+    }
+
+    size_t position = 0;
+    SDL_IOStream* archive = NULL;
+    int archiveGroup = -1;
+    for (int i = 0; i < count; i++) {
+        SDL_PhysFS_BatchItem* item = &items[i];
+        if (item->size < 0) {
+            continue;
+        }
+
+        // Stored entries are read through one handle on their archive, swept front to back.
+        char* buffer = block + position;
+        PHYSFS_sint64 read = -1;
+        if (item->cached != NULL) {
+            SDL_memcpy(buffer, SDL_PhysFS_CachedFileData(item->cached), item->cached->size);
+            read = item->size;
+        }
+        else if (item->indexed && item->entry.stored) {
+            if (archiveGroup != item->group) {
+                if (archive != NULL) {
+                    SDL_CloseIO(archive);
+                }
+                archive = SDL_IOFromFile(groups[item->group], "rb");
+                archiveGroup = item->group;
+            }
+#ifdef SDL_PHYSFS_STATS
+            Uint64 start = SDL_GetTicksNS();
+#endif
+            read = SDL_PhysFS_ReadBatchEntry(archive, groups[item->group], item, generation, buffer);
+#ifdef SDL_PHYSFS_STATS
+            // Each entry read from the shared archive handle counts as an open and a read of its file.
+            if (read >= 0) {
+                SDL_PhysFS_Counters* fileCounters;
+                SDL_PhysFS_Counters* mountCounters;
+                SDL_PhysFS_StatsLookup(filenames[item->index], groups[item->group], &fileCounters, &mountCounters);
+                SDL_PhysFS_StatsRecord(fileCounters, mountCounters, SDL_PHYSFS_TRACE_OPEN, filenames[item->index], SDL_GetTicksNS(), 0);
+                SDL_PhysFS_StatsRecord(fileCounters, mountCounters, SDL_PHYSFS_TRACE_READ, filenames[item->index], start, read);
+            }
+#endif
+        }
+        if (read < 0) {
+            const char* filename = filenames[item->index];
+#ifdef SDL_PHYSFS_STATS
+            Uint64 start = SDL_GetTicksNS();
+#endif
+            PHYSFS_File* handle = PHYSFS_openRead(filename);
+            if (handle == NULL) {
+                continue;
+            }
+#ifdef SDL_PHYSFS_STATS
+            SDL_PhysFS_Counters* fileCounters;
+            SDL_PhysFS_Counters* mountCounters;
+            SDL_PhysFS_StatsLookup(filename, groups[item->group], &fileCounters, &mountCounters);
+            SDL_PhysFS_StatsRecord(fileCounters, mountCounters, SDL_PHYSFS_TRACE_OPEN, filename, start, 0);
+            start = SDL_GetTicksNS();
+#endif
+            read = PHYSFS_readBytes(handle, buffer, (PHYSFS_uint64)item->size);
+#ifdef SDL_PHYSFS_STATS
+            SDL_PhysFS_StatsRecord(fileCounters, mountCounters, SDL_PHYSFS_TRACE_READ, filename, start, read);
+            start = SDL_GetTicksNS();
+#endif
+            PHYSFS_close(handle);
+#ifdef SDL_PHYSFS_STATS
+            SDL_PhysFS_StatsRecord(fileCounters, mountCounters, SDL_PHYSFS_TRACE_CLOSE, filename, start, 0);
+#endif
+            if (read < 0) {
+                continue;
+            }
+        }
+
+        buffer[read] = '\0';
+        buffers[item->index] = buffer;
+        if (sizes != NULL) {
+            sizes[item->index] = (size_t)read;
+        }
+        position += (size_t)item->size + 1;
+    }
+    if (archive != NULL) {
+        SDL_CloseIO(archive);
+    }
+
+    // Record the loaded files in the order they were asked for, so a recorded manifest replays them the same way.
+    for (int i = 0; i < count; i++) {
+        if (buffers[i] != NULL) {
+            SDL_PhysFS_RecordAccess(filenames[i]);
+        }
+    }
+
+    SDL_free(groups);
+    SDL_PhysFS_FreeBatchItems(items, count);
+    return block;
+}
+
+/**
+ * A manifest being replayed by SDL_PhysFS_Prefetch().
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_Prefetcher {
+    char* manifest;
+    const char** paths;
+    int count;
+    SDL_AtomicInt next;
+    SDL_AtomicInt cancelled;
+    SDL_Thread* threads[SDL_PHYSFS_PREFETCH_THREADS];
+} SDL_PhysFS_Prefetcher;
+
+/**
+ * The prefetch that is running, if any. It's taken out under the lock by whoever waits for it, so it's only joined and freed once.
+ *
+ * @internal
+ */
+static struct {
+    SDL_SpinLock lock;
+    SDL_PhysFS_Prefetcher* current;
+} SDL_PhysFS_prefetch = { 0, NULL };
+
+/**
+ * Warms up a single file, so that opening it later is fast.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_PrefetchFile(const char* filename) {
+    const char* realDir = SDL_PhysFS_GetRealDir(filename);
+    if (realDir == NULL) {
+        return;
+    }
+
+#if defined(SDL_PHYSFS_POSIX) && defined(POSIX_FADV_WILLNEED)
+    // Files in mounted directories are read ahead by the OS, without copying them here.
+    const char* relative = SDL_PhysFS_GetMountRelativePath(filename, realDir);
+    if (relative != NULL && SDL_PhysFS_GetMountedPathType(realDir) == SDL_PATHTYPE_DIRECTORY) {
+        while (*relative == '/') {
+            relative++;
+        }
+        size_t realDirLength = SDL_strlen(realDir);
+        bool hasSeparator = realDirLength > 0 && realDir[realDirLength - 1] == '/';
+        char* path = NULL;
+        if (SDL_asprintf(&path, "%s%s%s", realDir, hasSeparator ? "" : "/", relative) >= 0) {
+            int fd = open(path, O_RDONLY);
+            SDL_free(path);
+            if (fd >= 0) {
+                posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+                close(fd);
+                return;
+            }
+        }
+    }
+#endif
+
+    // Archive entries are inflated into the content cache, when it's enabled.
+    PHYSFS_File* handle = NULL;
+    if (SDL_PhysFS_ContentCacheEnabled()) {
+        SDL_PhysFS_CachedFile* cached = SDL_PhysFS_ContentCacheLoad(filename, &handle);
+        if (cached != NULL) {
+            SDL_PhysFS_ReleaseCachedFile(cached);
+        }
+    }
+    else {
+        handle = PHYSFS_openRead(filename);
+    }
+
+    // Otherwise, reading it through leaves it in the OS's file cache.
+    if (handle != NULL) {
+        Uint8 buffer[SDL_PHYSFS_ARCHIVE_BUFFER_SIZE];
+        while (PHYSFS_readBytes(handle, buffer, sizeof(buffer)) > 0) {
+        }
+        PHYSFS_close(handle);
+    }
+}
+
+/**
+ * Prefetch thread: warms up files from the manifest, in order, until it's done or cancelled.
+ *
+ * @internal
+ */
+static int SDLCALL SDL_PhysFS_PrefetchWorker(void* data) {
+    SDL_PhysFS_Prefetcher* prefetcher = (SDL_PhysFS_Prefetcher*)data;
+    while (SDL_GetAtomicInt(&prefetcher->cancelled) == 0) {
+        int index = SDL_AddAtomicInt(&prefetcher->next, 1);
+        if (index >= prefetcher->count) {
+            break;
+        }
+        SDL_PhysFS_PrefetchFile(prefetcher->paths[index]);
+    }
+
+    return 0;
+}
+
+/**
+ * Waits for a prefetch that has been taken out of SDL_PhysFS_prefetch, optionally cancelling it first, and frees it.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_FinishPrefetch(SDL_PhysFS_Prefetcher* prefetcher, bool cancel) {
+    if (prefetcher == NULL) {
+        return;
+    }
+
+    if (cancel) {
+        SDL_SetAtomicInt(&prefetcher->cancelled, 1);
+    }
+    for (int i = 0; i < SDL_PHYSFS_PREFETCH_THREADS; i++) {
+        SDL_WaitThread(prefetcher->threads[i], NULL);
+    }
+
+    SDL_free((void*)prefetcher->paths);
+    SDL_free(prefetcher->manifest);
+    SDL_free(prefetcher);
+}
+
+/**
+ * Warms up the files listed in a manifest on background threads, so they load quickly when they're needed.
+ *
+ * Files in mounted directories are read ahead into the OS's file cache. Files
+ * in archives are decompressed into the content cache when it's enabled with
+ * SDL_PhysFS_SetContentCacheSize(), or otherwise read through once. The
+ * files are warmed up in the order they're listed.
+ *
+ * This returns immediately. Any prefetch that is already running is cancelled.
+ *
+ * @param manifest The filename of a manifest written by SDL_PhysFS_StopAccessRecording(), in the search path.
+ *
+ * @return true if prefetching started, false otherwise. Use SDL_GetError() for details.
+ *
+ * @see SDL_PhysFS_StartAccessRecording()
+ * @see SDL_PhysFS_WaitPrefetch()
+ * @see SDL_PhysFS_CancelPrefetch()
+ */
+bool SDL_PhysFS_Prefetch(const char* manifest) {
+    SDL_PhysFS_CancelPrefetch();
+
+    size_t size;
+    char* text = (char*)SDL_PhysFS_LoadFile(manifest, &size);
+    if (text == NULL) {
+        return false;
+    }
+
+    // Every path ends with a newline.
+    int count = 0;
+    for (size_t i = 0; i < size; i++) {
+        if (text[i] == '\n') {
+            count++;
+        }
+    }
+
+    SDL_PhysFS_Prefetcher* prefetcher = (SDL_PhysFS_Prefetcher*)SDL_calloc(1, sizeof(SDL_PhysFS_Prefetcher));
+    const char** paths = (const char**)SDL_malloc(sizeof(const char*) * (size_t)(count + 1));
+    if (prefetcher == NULL || paths == NULL) {
+        SDL_free(prefetcher);
+        SDL_free((void*)paths);
+        SDL_free(text);
+        return false;
+    }
+    prefetcher->manifest = text;
+    prefetcher->paths = paths;
+
+    char* line = text;
+    while (*line != '\0') {
+        char* end = SDL_strchr(line, '\n');
+        char* next = end != NULL ? end + 1 : line + SDL_strlen(line);
+        if (end == NULL) {
+            end = next;
+        }
+        *end = '\0';
+        if (end > line && end[-1] == '\r') {
+            end[-1] = '\0';
+        }
+        if (*line != '\0') {
+            paths[prefetcher->count++] = line;
+        }
+        line = next;
+    }
+
+    for (int i = 0; i < SDL_PHYSFS_PREFETCH_THREADS; i++) {
+        prefetcher->threads[i] = SDL_CreateThread(SDL_PhysFS_PrefetchWorker, "SDL_PhysFS_Prefetch", prefetcher);
+    }
+
+    // Another prefetch may have been started meanwhile, which this one replaces.
+    SDL_LockSpinlock(&SDL_PhysFS_prefetch.lock);
+    SDL_PhysFS_Prefetcher* replaced = SDL_PhysFS_prefetch.current;
+    SDL_PhysFS_prefetch.current = prefetcher;
+    SDL_UnlockSpinlock(&SDL_PhysFS_prefetch.lock);
+    SDL_PhysFS_FinishPrefetch(replaced, true);
+
+    return true;
+}
+
+/**
+ * Waits for the prefetch started by SDL_PhysFS_Prefetch() to finish.
+ *
+ * When several threads wait at once, the first one waits for the prefetch,
+ * and the others return right away.
+ *
+ * @see SDL_PhysFS_Prefetch()
+ */
+void SDL_PhysFS_WaitPrefetch(void) {
+    SDL_LockSpinlock(&SDL_PhysFS_prefetch.lock);
+    SDL_PhysFS_Prefetcher* prefetcher = SDL_PhysFS_prefetch.current;
+    SDL_PhysFS_prefetch.current = NULL;
+    SDL_UnlockSpinlock(&SDL_PhysFS_prefetch.lock);
+
+    SDL_PhysFS_FinishPrefetch(prefetcher, false);
+}
+
+/**
+ * Stops the prefetch started by SDL_PhysFS_Prefetch(), once the files being warmed up are done.
+ *
+ * This is done automatically by SDL_PhysFS_Quit().
+ *
+ * @see SDL_PhysFS_Prefetch()
+ */
+void SDL_PhysFS_CancelPrefetch(void) {
+    SDL_LockSpinlock(&SDL_PhysFS_prefetch.lock);
+    SDL_PhysFS_Prefetcher* prefetcher = SDL_PhysFS_prefetch.current;
+    SDL_PhysFS_prefetch.current = NULL;
+    SDL_UnlockSpinlock(&SDL_PhysFS_prefetch.lock);
+
+    SDL_PhysFS_FinishPrefetch(prefetcher, true);
+}
+
+struct SDL_PhysFS_AsyncTask {
+    SDL_PhysFS_AsyncQueue* queue;
+    char* filename;
+    void* writeData;
+    char* error;
+    bool done;
+    SDL_PhysFS_AsyncOutcome outcome;
+    struct SDL_PhysFS_AsyncTask* next;
+};
+
+struct SDL_PhysFS_AsyncQueue {
+    SDL_Mutex* lock;
+    SDL_Condition* pendingCondition;
+    SDL_Condition* completeCondition;
+    SDL_PhysFS_AsyncTask* pending;
+    SDL_PhysFS_AsyncTask* pendingTail;
+    SDL_PhysFS_AsyncTask* complete;
+    SDL_PhysFS_AsyncTask* completeTail;
+    SDL_Thread** threads;
+    int numThreads;
+    bool quit;
+};
+
+/**
+ * Runs a single asynchronous load on the current thread.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_RunAsyncTask(SDL_PhysFS_AsyncTask* task) {
+    SDL_PhysFS_AsyncOutcome* outcome = &task->outcome;
+    switch (outcome->type) {
+        case SDL_PHYSFS_ASYNC_LOADFILE:
+            outcome->data = SDL_PhysFS_LoadFile(task->filename, &outcome->size);
+            outcome->success = outcome->data != NULL;
+            break;
+        case SDL_PHYSFS_ASYNC_LOADSURFACE:
+            outcome->surface = SDL_PhysFS_LoadSurface(task->filename);
+            outcome->success = outcome->surface != NULL;
+            break;
+        case SDL_PHYSFS_ASYNC_LOADWAV: {
+            Uint8* audio = NULL;
+            Uint32 length = 0;
+            outcome->success = SDL_PhysFS_LoadWAV(task->filename, &outcome->spec, &audio, &length);
+            outcome->data = audio;
+            outcome->size = length;
+            break;
+        }
+        case SDL_PHYSFS_ASYNC_WRITEFILE:
+            outcome->size = SDL_PhysFS_WriteFileAtomic(task->filename, task->writeData, outcome->size);
+            outcome->success = outcome->size > 0;
+            break;
+    }
+
+    // SDL's error is per-thread, so keep it to report on the thread that retrieves the outcome.
+    if (!outcome->success) {
+        task->error = SDL_strdup(SDL_GetError());
+    }
+}
+
+/**
+ * Worker thread for an SDL_PhysFS_AsyncQueue.
+ *
+ * @internal
+ */
+static int SDLCALL SDL_PhysFS_AsyncWorker(void* data) {
+    SDL_PhysFS_AsyncQueue* queue = (SDL_PhysFS_AsyncQueue*)data;
+
+    SDL_LockMutex(queue->lock);
+    while (true) {
+        while (queue->pending == NULL && !queue->quit) {
+            SDL_WaitCondition(queue->pendingCondition, queue->lock);
+        }
+        if (queue->quit) {
+            break;
+        }
+
+        SDL_PhysFS_AsyncTask* task = queue->pending;
+        queue->pending = task->next;
+        if (queue->pending == NULL) {
+            queue->pendingTail = NULL;
+        }
+        task->next = NULL;
+        SDL_UnlockMutex(queue->lock);
+
+        SDL_PhysFS_RunAsyncTask(task);
+
+        SDL_LockMutex(queue->lock);
+        if (queue->completeTail != NULL) {
+            queue->completeTail->next = task;
+        }
+        else {
+            queue->complete = task;
+        }
+        queue->completeTail = task;
+        task->done = true;
+        SDL_BroadcastCondition(queue->completeCondition);
+    }
+    SDL_UnlockMutex(queue->lock);
+
+    return 0;
+}
+
+/**
+ * Frees a task, along with any results that weren't handed to the caller.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_DestroyAsyncTask(SDL_PhysFS_AsyncTask* task, bool freeResults) {
+    if (freeResults) {
+        SDL_free(task->outcome.data);
+        if (task->outcome.surface != NULL) {
+            SDL_DestroySurface(task->outcome.surface);
+        }
+    }
+
+    SDL_free(task->filename);
+    SDL_free(task->writeData);
+    SDL_free(task->error);
+    SDL_free(task);
+}
+
+/**
+ * Creates a queue for asynchronous loading, with its own pool of worker threads.
+ *
+ * @param numThreads The number of worker threads to load with, or 0 to use one per logical CPU core.
+ *
+ * @return The new queue, or NULL on failure. Use SDL_GetError() for details.
+ *
+ * @see SDL_PhysFS_DestroyAsyncQueue()
+ * @see SDL_PhysFS_LoadFileAsync()
+ */
+SDL_PhysFS_AsyncQueue* SDL_PhysFS_CreateAsyncQueue(int numThreads) {
+    if (numThreads < 0) {
+        SDL_InvalidParamError("numThreads");
+        return NULL;
+    }
+    if (numThreads == 0) {
+        numThreads = SDL_max(SDL_GetNumLogicalCPUCores(), 1);
+    }
+
+    SDL_PhysFS_AsyncQueue* queue = (SDL_PhysFS_AsyncQueue*)SDL_calloc(1, sizeof(SDL_PhysFS_AsyncQueue));
+    if (queue == NULL) {
+        return NULL;
+    }
+
+    queue->lock = SDL_CreateMutex();
+    queue->pendingCondition = SDL_CreateCondition();
+    queue->completeCondition = SDL_CreateCondition();
+    queue->threads = (SDL_Thread**)SDL_calloc((size_t)numThreads, sizeof(SDL_Thread*));
+    if (queue->lock == NULL || queue->pendingCondition == NULL || queue->completeCondition == NULL || queue->threads == NULL) {
+        SDL_PhysFS_DestroyAsyncQueue(queue);
+        return NULL;
+    }
+
+    for (int i = 0; i < numThreads; i++) {
+        queue->threads[i] = SDL_CreateThread(SDL_PhysFS_AsyncWorker, "SDL_PhysFS", queue);
+        if (queue->threads[i] == NULL) {
+            SDL_PhysFS_DestroyAsyncQueue(queue);
+            return NULL;
+        }
+        queue->numThreads++;
+    }
+
+    return queue;
+}
+
+/**
+ * Destroys an asynchronous loading queue.
+ *
+ * Loads that are in progress are waited on. Loads that haven't started are
+ * canceled, and results that haven't been retrieved are freed.
+ *
+ * @param queue The queue to destroy.
+ *
+ * @see SDL_PhysFS_CreateAsyncQueue()
+ */
+void SDL_PhysFS_DestroyAsyncQueue(SDL_PhysFS_AsyncQueue* queue) {
+    if (queue == NULL) {
+        return;
+    }
+
+    if (queue->lock != NULL) {
+        SDL_LockMutex(queue->lock);
+        queue->quit = true;
+        SDL_BroadcastCondition(queue->pendingCondition);
+        SDL_UnlockMutex(queue->lock);
+    }
+
+    for (int i = 0; i < queue->numThreads; i++) {
+        SDL_WaitThread(queue->threads[i], NULL);
+    }
+
+    while (queue->pending != NULL) {
+        SDL_PhysFS_AsyncTask* next = queue->pending->next;
+        SDL_PhysFS_DestroyAsyncTask(queue->pending, true);
+        queue->pending = next;
+    }
+    while (queue->complete != NULL) {
+        SDL_PhysFS_AsyncTask* next = queue->complete->next;
+        SDL_PhysFS_DestroyAsyncTask(queue->complete, true);
+        queue->complete = next;
+    }
+
+    SDL_free(queue->threads);
+    SDL_DestroyCondition(queue->completeCondition);
+    SDL_DestroyCondition(queue->pendingCondition);
+    SDL_DestroyMutex(queue->lock);
+    SDL_free(queue);
+}
+
+/**
+ * Adds a load to the queue, to be picked up by the next free worker thread.
+ *
+ * @internal
+ */
+static SDL_PhysFS_AsyncTask* SDL_PhysFS_QueueAsyncTask(const char* filename, SDL_PhysFS_AsyncQueue* queue, SDL_PhysFS_AsyncType type, void* userdata, void* writeData, size_t writeSize) {
+    if (filename == NULL || queue == NULL) {
+        SDL_free(writeData);
+        SDL_InvalidParamError("filename or queue");
+        return NULL;
+    }
+
+    SDL_PhysFS_AsyncTask* task = (SDL_PhysFS_AsyncTask*)SDL_calloc(1, sizeof(SDL_PhysFS_AsyncTask));
+    if (task == NULL) {
+        SDL_free(writeData);
+        return NULL;
+    }
+
+    task->filename = SDL_strdup(filename);
+    if (task->filename == NULL) {
+        SDL_free(writeData);
+        SDL_free(task);
+        return NULL;
+    }
+    task->writeData = writeData;
+    task->outcome.size = writeSize;
+    task->queue = queue;
+    task->outcome.task = task;
+    task->outcome.type = type;
+    task->outcome.userdata = userdata;
+
+    SDL_LockMutex(queue->lock);
+    if (queue->pendingTail != NULL) {
+        queue->pendingTail->next = task;
+    }
+    else {
+        queue->pending = task;
+    }
+    queue->pendingTail = task;
+    SDL_SignalCondition(queue->pendingCondition);
+    SDL_UnlockMutex(queue->lock);
+
+    return task;
+}
+
+/**
+ * Loads all the file data from a given filename on a worker thread.
+ *
+ * @param filename The name of the file to load.
+ * @param queue The queue to run the load on, and deliver its outcome to.
+ * @param userdata A pointer that is passed back in the outcome.
+ *
+ * @return The queued task, or NULL on failure. Use SDL_GetError() for details.
+ *
+ * @see SDL_PhysFS_LoadFile()
+ * @see SDL_PhysFS_GetAsyncResult()
+ */
+SDL_PhysFS_AsyncTask* SDL_PhysFS_LoadFileAsync(const char* filename, SDL_PhysFS_AsyncQueue* queue, void* userdata) {
+    return SDL_PhysFS_QueueAsyncTask(filename, queue, SDL_PHYSFS_ASYNC_LOADFILE, userdata, NULL, 0);
+}
+
+/**
+ * Loads a surface from any supported image format on a worker thread.
+ *
+ * @param filename The filename of the image file to load.
+ * @param queue The queue to run the load on, and deliver its outcome to.
+ * @param userdata A pointer that is passed back in the outcome.
+ *
+ * @return The queued task, or NULL on failure. Use SDL_GetError() for details.
+ *
+ * @see SDL_PhysFS_LoadSurface()
+ * @see SDL_PhysFS_GetAsyncResult()
+ */
+SDL_PhysFS_AsyncTask* SDL_PhysFS_LoadSurfaceAsync(const char* filename, SDL_PhysFS_AsyncQueue* queue, void* userdata) {
+    return SDL_PhysFS_QueueAsyncTask(filename, queue, SDL_PHYSFS_ASYNC_LOADSURFACE, userdata, NULL, 0);
+}
+
+/**
+ * Loads a wav file on a worker thread.
+ *
+ * @param filename The filename of the wav file to load.
+ * @param queue The queue to run the load on, and deliver its outcome to.
+ * @param userdata A pointer that is passed back in the outcome.
+ *
+ * @return The queued task, or NULL on failure. Use SDL_GetError() for details.
+ *
+ * @see SDL_PhysFS_LoadWAV()
+ * @see SDL_PhysFS_GetAsyncResult()
+ */
+SDL_PhysFS_AsyncTask* SDL_PhysFS_LoadWAVAsync(const char* filename, SDL_PhysFS_AsyncQueue* queue, void* userdata) {
+    return SDL_PhysFS_QueueAsyncTask(filename, queue, SDL_PHYSFS_ASYNC_LOADWAV, userdata, NULL, 0);
+}
+
+/**
+ * Atomically writes a data buffer to the given file on a worker thread.
+ *
+ * The buffer is copied, so it can be reused as soon as this returns.
+ *
+ * @param file The filename to write to in the write directory.
+ * @param buffer The data to write.
+ * @param size The number of bytes to write.
+ * @param queue The queue to run the write on, and deliver its outcome to.
+ * @param userdata A pointer that is passed back in the outcome.
+ *
+ * @return The queued task, or NULL on failure. Use SDL_GetError() for details.
+ *
+ * @see SDL_PhysFS_WriteFileAtomic()
+ * @see SDL_PhysFS_GetAsyncResult()
+ */
+SDL_PhysFS_AsyncTask* SDL_PhysFS_WriteFileAtomicAsync(const char* file, const void* buffer, size_t size, SDL_PhysFS_AsyncQueue* queue, void* userdata) {
+    if (buffer == NULL || size == 0) {
+        SDL_InvalidParamError("buffer or size");
+        return NULL;
+    }
+
+    void* writeData = SDL_malloc(size);
+    if (writeData == NULL) {
+        return NULL;
+    }
+    SDL_memcpy(writeData, buffer, size);
+
+    return SDL_PhysFS_QueueAsyncTask(file, queue, SDL_PHYSFS_ASYNC_WRITEFILE, userdata, writeData, size);
+}
+
+/**
+ * Hands a completed task's outcome to the caller, and frees the task. The queue must be locked.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_TakeAsyncOutcome(SDL_PhysFS_AsyncTask* task, SDL_PhysFS_AsyncOutcome* outcome) {
+    SDL_PhysFS_AsyncQueue* queue = task->queue;
+    SDL_PhysFS_AsyncTask* previous = NULL;
+    for (SDL_PhysFS_AsyncTask* it = queue->complete; it != NULL; previous = it, it = it->next) {
+        if (it == task) {
+            if (previous != NULL) {
+                previous->next = task->next;
+            }
+            else {
+                queue->complete = task->next;
+            }
+            if (queue->completeTail == task) {
+                queue->completeTail = previous;
+            }
+            break;
+        }
+    }
+
+    if (task->error != NULL) {
+        SDL_SetError("%s", task->error);
+    }
+
+    *outcome = task->outcome;
+    SDL_PhysFS_DestroyAsyncTask(task, false);
+}
+
+/**
+ * Checks whether an asynchronous load has finished, without blocking.
+ *
+ * @param task The task to check. It must not have had its outcome retrieved yet.
+ *
+ * @return true if the load is done and its outcome is waiting in the queue, false otherwise.
+ */
+bool SDL_PhysFS_IsAsyncTaskDone(SDL_PhysFS_AsyncTask* task) {
+    if (task == NULL) {
+        return false;
+    }
+
+    SDL_LockMutex(task->queue->lock);
+    bool done = task->done;
+    SDL_UnlockMutex(task->queue->lock);
+    return done;
+}
+
+/**
+ * Blocks until the given asynchronous load has finished, and retrieves its outcome.
+ *
+ * @param task The task to wait on. It is freed once this returns.
+ * @param outcome Where to put the outcome of the load.
+ *
+ * @return true if the outcome was retrieved, false on invalid parameters.
+ */
+bool SDL_PhysFS_WaitAsyncTask(SDL_PhysFS_AsyncTask* task, SDL_PhysFS_AsyncOutcome* outcome) {
+    if (task == NULL || outcome == NULL) {
+        return SDL_InvalidParamError("task or outcome");
+    }
+
+    SDL_PhysFS_AsyncQueue* queue = task->queue;
+    SDL_LockMutex(queue->lock);
+    while (!task->done) {
+        SDL_WaitCondition(queue->completeCondition, queue->lock);
+    }
+    SDL_PhysFS_TakeAsyncOutcome(task, outcome);
+    SDL_UnlockMutex(queue->lock);
+
+    return true;
+}
+
+/**
+ * Retrieves the outcome of the next finished asynchronous load, without blocking.
+ *
+ * @param queue The queue to check.
+ * @param outcome Where to put the outcome of the load.
+ *
+ * @return true if an outcome was retrieved, false if no loads have finished.
+ *
+ * @see SDL_PhysFS_WaitAsyncResult()
+ */
+bool SDL_PhysFS_GetAsyncResult(SDL_PhysFS_AsyncQueue* queue, SDL_PhysFS_AsyncOutcome* outcome) {
+    return SDL_PhysFS_WaitAsyncResult(queue, outcome, 0);
+}
+
+/**
+ * Waits for the next asynchronous load to finish, and retrieves its outcome.
+ *
+ * @param queue The queue to wait on.
+ * @param outcome Where to put the outcome of the load.
+ * @param timeoutMS The maximum time to wait in milliseconds, or -1 to wait indefinitely.
+ *
+ * @return true if an outcome was retrieved, false if none finished in time.
+ *
+ * @see SDL_PhysFS_GetAsyncResult()
+ */
+bool SDL_PhysFS_WaitAsyncResult(SDL_PhysFS_AsyncQueue* queue, SDL_PhysFS_AsyncOutcome* outcome, Sint32 timeoutMS) {
+    if (queue == NULL || outcome == NULL) {
+        return SDL_InvalidParamError("queue or outcome");
+    }
+
+    SDL_LockMutex(queue->lock);
+    if (queue->complete == NULL && timeoutMS != 0) {
+        Uint64 deadline = SDL_GetTicks() + (Uint64)(timeoutMS > 0 ? timeoutMS : 0);
+        while (queue->complete == NULL) {
+            if (timeoutMS < 0) {
+                SDL_WaitCondition(queue->completeCondition, queue->lock);
+                continue;
+            }
+
+            Uint64 now = SDL_GetTicks();
+            if (now >= deadline || !SDL_WaitConditionTimeout(queue->completeCondition, queue->lock, (Sint32)(deadline - now))) {
+                break;
+            }
+        }
+    }
+
+    bool result = queue->complete != NULL;
+    if (result) {
+        SDL_PhysFS_TakeAsyncOutcome(queue->complete, outcome);
+    }
+    SDL_UnlockMutex(queue->lock);
+
+    return result;
+}
+
+/**
+ * Writes a data buffer to the given file. Symmetric counterpart to SDL_PhysFS_LoadFile().
+ *
+ * @param file The filename to write to in the write directory.
+ * @param buffer The data to write.
+ * @param size The number of bytes to write.
+ *
+ * @return The number of bytes written, or 0 on failure. Use SDL_GetError() for details.
+ *
+ * @see SDL_PhysFS_LoadFile()
+ * @see SDL_PhysFS_SetWriteDir()
+ */
+size_t SDL_PhysFS_WriteFile(const char* file, const void* buffer, size_t size) {
+    if (file == NULL || size == 0 || buffer == NULL) {
+        return 0;
+    }
+
+    PHYSFS_File* handle = PHYSFS_openWrite(file);
+    if (handle == NULL) {
+        SDL_PhysFS_SetError("Failed to open file for writing");
+        return 0;
+    }
+
+    // The written file may now shadow, or be, a path that was resolved before.
+    PHYSFS_sint64 bytesWritten = PHYSFS_writeBytes(handle, buffer, (PHYSFS_uint64)size);
+    PHYSFS_close(handle);
+    SDL_PhysFS_ClearPathCache();
+    if (bytesWritten <= 0) {
+        SDL_PhysFS_SetError("Failed to write data to file");
+        return 0;
+    }
+
+    return (size_t)bytesWritten;
+}
+
+/**
+ * Builds the platform-dependent path of a file in the write directory.
+ *
+ * @return The path, which must be freed with SDL_free(), or NULL if there is no write directory.
+ *
+ * @internal
+ */
+static char* SDL_PhysFS_GetWritePath(const char* file) {
+    const char* writeDir = PHYSFS_getWriteDir();
+    if (writeDir == NULL) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_NO_WRITE_DIR);
+        return NULL;
+    }
+
+    const char* separator = PHYSFS_getDirSeparator();
+    size_t writeDirLength = SDL_strlen(writeDir);
+    bool hasSeparator = writeDirLength > 0 && SDL_strchr("/\\", writeDir[writeDirLength - 1]) != NULL;
+    while (*file == '/') {
+        file++;
+    }
+
+    char* path = NULL;
+    if (SDL_asprintf(&path, "%s%s%s", writeDir, hasSeparator ? "" : separator, file) < 0) {
+        return NULL;
+    }
+
+    for (char* it = path + writeDirLength; *it != '\0'; it++) {
+        if (*it == '/') {
+            *it = separator[0];
+        }
+    }
+
+    return path;
+}
+
+/**
+ * Flushes a file, or directory, in the write directory to disk.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_SyncPath(const char* path) {
+#ifdef SDL_PHYSFS_POSIX
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool result = fsync(fd) == 0;
+    close(fd);
+    return result;
+#else
+    (void)path;
+    return true;
+#endif
+}
+
+/**
+ * Writes a data buffer to the given file, so that it is either entirely replaced or left untouched.
+ *
+ * The data is written to a temporary file next to the target in the write
+ * directory, flushed to disk, and then renamed over the target. A crash
+ * part-way through leaves the previous contents intact, rather than a
+ * truncated file. Syncing to disk is done on POSIX platforms.
+ *
+ * @param file The filename to write to in the write directory.
+ * @param buffer The data to write.
+ * @param size The number of bytes to write.
+ *
+ * @return The number of bytes written, or 0 on failure. Use SDL_GetError() for details.
+ *
+ * @see SDL_PhysFS_WriteFile()
+ * @see SDL_PhysFS_WriteFileAtomicAsync()
+ */
+size_t SDL_PhysFS_WriteFileAtomic(const char* file, const void* buffer, size_t size) {
+    if (file == NULL || size == 0 || buffer == NULL) {
+        return 0;
+    }
+
+    // Each thread gets its own temporary file, so concurrent saves don't collide.
+    char* tempFile = NULL;
+    if (SDL_asprintf(&tempFile, "%s.%" SDL_PRIu64 ".tmp", file, (Uint64)SDL_GetCurrentThreadID()) < 0) {
+        return 0;
+    }
+
+    PHYSFS_File* handle = PHYSFS_openWrite(tempFile);
+    if (handle == NULL) {
+        SDL_PhysFS_SetError("Failed to open temporary file for writing");
+        SDL_free(tempFile);
+        return 0;
+    }
+
+    PHYSFS_sint64 bytesWritten = PHYSFS_writeBytes(handle, buffer, (PHYSFS_uint64)size);
+    bool written = bytesWritten == (PHYSFS_sint64)size && PHYSFS_flush(handle) != 0;
+    if (PHYSFS_close(handle) == 0 || !written) {
+        SDL_PhysFS_SetError("Failed to write data to temporary file");
+        PHYSFS_delete(tempFile);
+        SDL_free(tempFile);
+        return 0;
+    }
+
+    char* tempPath = SDL_PhysFS_GetWritePath(tempFile);
+    char* path = SDL_PhysFS_GetWritePath(file);
+    bool result = tempPath != NULL && path != NULL;
+    if (result && !SDL_PhysFS_SyncPath(tempPath)) {
+        SDL_SetError("SDL_PhysFS_WriteFileAtomic: Failed to sync %s", tempPath);
+        result = false;
+    }
+    if (result && !SDL_RenamePath(tempPath, path)) {
+        result = false;
+    }
+
+    // Sync the directory too, so the rename itself survives a crash.
+    if (result) {
+        char* directory = SDL_strdup(path);
+        char* lastSeparator = directory != NULL ? SDL_strrchr(directory, PHYSFS_getDirSeparator()[0]) : NULL;
+        if (lastSeparator != NULL) {
+            *lastSeparator = '\0';
+            SDL_PhysFS_SyncPath(directory);
+        }
+        SDL_free(directory);
+    }
+    else {
+        PHYSFS_delete(tempFile);
+    }
+
+    SDL_free(path);
+    SDL_free(tempPath);
+    SDL_free(tempFile);
+    SDL_PhysFS_ClearPathCache();
+
+    return result ? (size_t)bytesWritten : 0;
+}
+
+/**
+ * The state of a SDL_IOStream created by SDL_PhysFS_OpenOverlayIO().
+ *
+ * Until the first write, reads come from the original file. Writing creates
+ * a temporary copy in the write directory, and each block is copied into it
+ * from the original the first time it's written to. Reads are served from
+ * whichever of the two holds the block.
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_Overlay {
+    PHYSFS_File* source;
+    Sint64 sourceLength;
+    Sint64 sourcePosition;
+    SDL_IOStream* copy;
+    char* filename;
+    char* path;
+    char* tempPath;
+    char* writeDir;
+    Uint8* copied;
+    size_t blockCount;
+    Uint8* block;
+    Sint64 position;
+    Sint64 length;
+} SDL_PhysFS_Overlay;
+
+/**
+ * Frees an overlay, without closing its files.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_FreeOverlay(SDL_PhysFS_Overlay* overlay) {
+    SDL_free(overlay->filename);
+    SDL_free(overlay->path);
+    SDL_free(overlay->tempPath);
+    SDL_free(overlay->writeDir);
+    SDL_free(overlay->copied);
+    SDL_free(overlay->block);
+    SDL_free(overlay);
+}
+
+/**
+ * Reads from the original file, seeking only when the read isn't where the last one left off.
+ *
+ * @internal
+ */
+static PHYSFS_sint64 SDL_PhysFS_OverlayReadSource(SDL_PhysFS_Overlay* overlay, Sint64 offset, void* ptr, size_t size) {
+    if (overlay->sourcePosition != offset) {
+        if (!PHYSFS_seek(overlay->source, (PHYSFS_uint64)offset)) {
+            return -1;
+        }
+        overlay->sourcePosition = offset;
+    }
+
+    PHYSFS_sint64 rc = PHYSFS_readBytes(overlay->source, ptr, (PHYSFS_uint64)size);
+    if (rc > 0) {
+        overlay->sourcePosition += (Sint64)rc;
+    }
+
+    return rc;
+}
+
+/**
+ * Copies a block of the original file into the copy, if it isn't there already.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_OverlayCopyBlock(SDL_PhysFS_Overlay* overlay, Uint64 index) {
+    if (index >= overlay->blockCount || overlay->copied[index]) {
+        return true;
+    }
+
+    Sint64 offset = (Sint64)index * SDL_PHYSFS_OVERLAY_BLOCK_SIZE;
+    size_t size = (size_t)SDL_min((Sint64)SDL_PHYSFS_OVERLAY_BLOCK_SIZE, overlay->sourceLength - offset);
+    if (SDL_PhysFS_OverlayReadSource(overlay, offset, overlay->block, size) != (PHYSFS_sint64)size) {
+        SDL_PhysFS_SetError("Failed to read the original file");
+        return false;
+    }
+    if (SDL_SeekIO(overlay->copy, offset, SDL_IO_SEEK_SET) != offset || SDL_WriteIO(overlay->copy, overlay->block, size) != size) {
+        return false;
+    }
+    overlay->copied[index] = 1;
+
+    return true;
+}
+
+/**
+ * Creates the temporary copy in the write directory, on the first write.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_OverlayBegin(SDL_PhysFS_Overlay* overlay) {
+    // The file's directory is created in the write directory, if it isn't there already.
+    char* directory = SDL_strdup(overlay->filename);
+    char* lastSlash = directory != NULL ? SDL_strrchr(directory, '/') : NULL;
+    if (lastSlash != NULL) {
+        *lastSlash = '\0';
+    }
+    bool created = directory != NULL && (lastSlash == NULL || PHYSFS_mkdir(directory) != 0);
+    SDL_free(directory);
+    if (!created) {
+        SDL_PhysFS_SetError("Failed to create directory for overlay");
+        return false;
+    }
+
+    char* tempFile = NULL;
+    if (SDL_asprintf(&tempFile, "%s.%" SDL_PRIx64 ".tmp", overlay->filename, (Uint64)(uintptr_t)overlay) < 0) {
+        return false;
+    }
+    overlay->tempPath = SDL_PhysFS_GetWritePath(tempFile);
+    overlay->path = SDL_PhysFS_GetWritePath(overlay->filename);
+    SDL_free(tempFile);
+    if (overlay->tempPath == NULL || overlay->path == NULL) {
+        SDL_PhysFS_SetError("Failed to find the write directory");
+        return false;
+    }
+
+    overlay->copied = (Uint8*)SDL_calloc(overlay->blockCount > 0 ? overlay->blockCount : 1, 1);
+    overlay->block = (Uint8*)SDL_malloc(SDL_PHYSFS_OVERLAY_BLOCK_SIZE);
+    if (overlay->copied == NULL || overlay->block == NULL) {
+        return false;
+    }
+
+    overlay->copy = SDL_IOFromFile(overlay->tempPath, "w+b");
+    return overlay->copy != NULL;
+}
+
+/**
+ * SDL_IOStream callback for overlays: size.
+ *
+ * @internal
+ */
+static Sint64 SDLCALL SDL_PhysFS_OverlayGetIOSize(void* userdata) {
+    return ((SDL_PhysFS_Overlay*)userdata)->length;
+}
+
+/**
+ * SDL_IOStream callback for overlays: seek.
+ *
+ * @internal
+ */
+static Sint64 SDLCALL SDL_PhysFS_OverlaySeekIO(void* userdata, Sint64 offset, SDL_IOWhence whence) {
+    SDL_PhysFS_Overlay* overlay = (SDL_PhysFS_Overlay*)userdata;
+    Sint64 pos;
+    if (whence == SDL_IO_SEEK_SET) {
+        pos = offset;
+    }
+    else if (whence == SDL_IO_SEEK_CUR) {
+        pos = overlay->position + offset;
+    }
+    else if (whence == SDL_IO_SEEK_END) {
+        pos = overlay->length + offset;
+    }
+    else {
+        SDL_PhysFS_SetError("Invalid 'whence' parameter");
+        return -1;
+    }
+
+    if (pos < 0) {
+        SDL_PhysFS_SetError("Attempt to seek past start of file");
+        return -1;
+    }
+    overlay->position = pos;
+
+    return pos;
+}
+
+/**
+ * SDL_IOStream callback for overlays: read.
+ *
+ * @internal
+ */
+static size_t SDLCALL SDL_PhysFS_OverlayReadIO(void* userdata, void* ptr, size_t size, SDL_IOStatus* status) {
+    SDL_PhysFS_Overlay* overlay = (SDL_PhysFS_Overlay*)userdata;
+    Uint8* out = (Uint8*)ptr;
+    size_t total = 0;
+    while (total < size && overlay->position < overlay->length) {
+        Uint64 index = (Uint64)overlay->position / SDL_PHYSFS_OVERLAY_BLOCK_SIZE;
+        Sint64 blockEnd = SDL_min((Sint64)(index + 1) * SDL_PHYSFS_OVERLAY_BLOCK_SIZE, overlay->length);
+        size_t count = (size_t)SDL_min((Sint64)(size - total), blockEnd - overlay->position);
+        Sint64 rc;
+        if (overlay->copy != NULL && (index >= overlay->blockCount || overlay->copied[index])) {
+            rc = SDL_SeekIO(overlay->copy, overlay->position, SDL_IO_SEEK_SET) == overlay->position ?
+                (Sint64)SDL_ReadIO(overlay->copy, out + total, count) : -1;
+        }
+        else if (overlay->position < overlay->sourceLength) {
+            count = (size_t)SDL_min((Sint64)count, overlay->sourceLength - overlay->position);
+            rc = (Sint64)SDL_PhysFS_OverlayReadSource(overlay, overlay->position, out + total, count);
+        }
+        else {
+            // Past the original's end, in a block that hasn't been written to since the file grew.
+            SDL_memset(out + total, 0, count);
+            rc = (Sint64)count;
+        }
+
+        if (rc <= 0) {
+            if (total == 0) {
+                *status = SDL_IO_STATUS_ERROR;
+            }
+            return total;
+        }
+        total += (size_t)rc;
+        overlay->position += rc;
+    }
+
+    if (total == 0) {
+        *status = SDL_IO_STATUS_EOF;
+    }
+
+    return total;
+}
+
+/**
+ * SDL_IOStream callback for overlays: write.
+ *
+ * @internal
+ */
+static size_t SDLCALL SDL_PhysFS_OverlayWriteIO(void* userdata, const void* ptr, size_t size, SDL_IOStatus* status) {
+    SDL_PhysFS_Overlay* overlay = (SDL_PhysFS_Overlay*)userdata;
+    if (overlay->copy == NULL && !SDL_PhysFS_OverlayBegin(overlay)) {
+        *status = SDL_IO_STATUS_ERROR;
+        return 0;
+    }
+
+    const Uint8* in = (const Uint8*)ptr;
+    size_t total = 0;
+    while (total < size) {
+        Uint64 index = (Uint64)overlay->position / SDL_PHYSFS_OVERLAY_BLOCK_SIZE;
+        Sint64 blockEnd = (Sint64)(index + 1) * SDL_PHYSFS_OVERLAY_BLOCK_SIZE;
+        size_t count = (size_t)SDL_min((Sint64)(size - total), blockEnd - overlay->position);
+        if (!SDL_PhysFS_OverlayCopyBlock(overlay, index) ||
+            SDL_SeekIO(overlay->copy, overlay->position, SDL_IO_SEEK_SET) != overlay->position) {
+            break;
+        }
+
+        size_t written = SDL_WriteIO(overlay->copy, in + total, count);
+        total += written;
+        overlay->position += (Sint64)written;
+        if (written < count) {
+            break;
+        }
+    }
+
+    if (overlay->position > overlay->length) {
+        overlay->length = overlay->position;
+    }
+    if (total < size) {
+        *status = SDL_IO_STATUS_ERROR;
+    }
+
+    return total;
+}
+
+/**
+ * SDL_IOStream callback for overlays: flush.
+ *
+ * @internal
+ */
+static bool SDLCALL SDL_PhysFS_OverlayFlushIO(void* userdata, SDL_IOStatus* status) {
+    SDL_PhysFS_Overlay* overlay = (SDL_PhysFS_Overlay*)userdata;
+    if (overlay->copy == NULL || SDL_FlushIO(overlay->copy)) {
+        return true;
+    }
+
+    *status = SDL_IO_STATUS_ERROR;
+    return false;
+}
+
+/**
+ * Compares two directory names, ignoring trailing separators.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_SameDirectory(const char* a, const char* b) {
+    size_t lengthA = SDL_strlen(a);
+    size_t lengthB = SDL_strlen(b);
+    while (lengthA > 1 && (a[lengthA - 1] == '/' || a[lengthA - 1] == '\\')) {
+        lengthA--;
+    }
+    while (lengthB > 1 && (b[lengthB - 1] == '/' || b[lengthB - 1] == '\\')) {
+        lengthB--;
+    }
 
-    // Check to see how large the file is.
-    PHYSFS_sint64 size = PHYSFS_fileLength(handle);
-    if (size < 0) {
-        SDL_PhysFS_SetError("Cannot determine file size");
-        if (datasize != NULL) {
-            *datasize = 0;
+    return lengthA == lengthB && SDL_strncmp(a, b, lengthA) == 0;
+}
+
+/**
+ * Makes sure the write directory is at the front of the search path, mounted at "/", so an overlay's copy shadows the original.
+ *
+ * The write directory is mounted in front if it isn't in the search path.
+ * It's never moved: if it's mounted elsewhere, or behind something else,
+ * this fails.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_MountWriteDirFirst(const char* writeDir, const char* filename) {
+    char** searchPath = PHYSFS_getSearchPath();
+    if (searchPath == NULL) {
+        SDL_PhysFS_SetError("Failed to get the search path");
+        return false;
+    }
+    int index = -1;
+    const char* mountPoint = NULL;
+    for (int i = 0; searchPath[i] != NULL && index < 0; i++) {
+        if (SDL_PhysFS_SameDirectory(searchPath[i], writeDir)) {
+            index = i;
+            mountPoint = PHYSFS_getMountPoint(searchPath[i]);
         }
-        PHYSFS_close(handle);
-        return NULL;
     }
+    PHYSFS_freeList(searchPath);
 
-    // Existing empty files get an empty null-terminated buffer.
-    if (size == 0) {
-        PHYSFS_close(handle);
-        void* empty = SDL_malloc(1);
-        ((char*)empty)[0] = '\0';
-        if (datasize != NULL) {
-            *datasize = 0;
+    if (index < 0) {
+        if (PHYSFS_mount(writeDir, NULL, 0) == 0) {
+            SDL_PhysFS_SetError("Failed to mount the write directory");
+            return false;
         }
-        return empty;
+        SDL_PhysFS_RememberMountedPath(writeDir);
+        SDL_PhysFS_ClearPathCache();
+        return true;
+    }
+    if (mountPoint != NULL && SDL_strcmp(mountPoint, "/") != 0) {
+        return SDL_SetError("SDL_PhysFS_OpenOverlayIO: The write directory is mounted at %s, so it can't shadow %s", mountPoint, filename);
+    }
+    if (index > 0) {
+        return SDL_SetError("SDL_PhysFS_OpenOverlayIO: The write directory is mounted behind other directories or archives, so it can't shadow %s", filename);
     }
 
-    // Read the file, with an extra byte for null termination.
-    void* buffer = SDL_malloc((size_t)size + 1);
-    PHYSFS_sint64 read = PHYSFS_readBytes(handle, buffer, (PHYSFS_uint64)size);
-    if (read < 0) {
-        if (datasize != NULL) {
-            *datasize = 0;
+    return true;
+}
+
+/**
+ * SDL_IOStream callback for overlays: close.
+ *
+ * The blocks that were never written to are copied in, and the copy is
+ * renamed into place in the write directory, which SDL_PhysFS_OpenOverlayIO()
+ * put at the front of the search path, where it shadows the original.
+ *
+ * @internal
+ */
+static bool SDLCALL SDL_PhysFS_OverlayCloseIO(void* userdata) {
+    SDL_PhysFS_Overlay* overlay = (SDL_PhysFS_Overlay*)userdata;
+    bool result = true;
+    if (overlay->copy != NULL) {
+        for (size_t i = 0; result && i < overlay->blockCount; i++) {
+            result = SDL_PhysFS_OverlayCopyBlock(overlay, i);
         }
-        SDL_free(buffer);
-        SDL_PhysFS_SetError("Failed to read bytes from file");
-        PHYSFS_close(handle);
-        return NULL;
+        result = SDL_CloseIO(overlay->copy) && result;
     }
-    ((char*)buffer)[read] = '\0';
 
-    // Close the file handle, and return the bytes read and the buffer.
-    PHYSFS_close(handle);
-    if (datasize != NULL) {
-        *datasize = (size_t)read;
+    // The original is closed before the rename, which may replace it.
+    PHYSFS_close(overlay->source);
+
+    if (overlay->copy != NULL) {
+        if (!result || !SDL_RenamePath(overlay->tempPath, overlay->path)) {
+            SDL_RemovePath(overlay->tempPath);
+            result = false;
+        }
+        SDL_PhysFS_ClearPathCache();
     }
 
-    return buffer;
+    SDL_PhysFS_FreeOverlay(overlay);
+    return result;
 }
 
 /**
- * Writes a data buffer to the given file. Symmetric counterpart to SDL_PhysFS_LoadFile().
+ * Opens a file in the search path for reading and writing, copying it into the write directory as it's changed.
  *
- * @param file The filename to write to in the write directory.
- * @param buffer The data to write.
- * @param size The number of bytes to write.
+ * Files in archives, or anywhere outside the write directory, can't be
+ * opened for writing. This stream reads the file from wherever it's found,
+ * and nothing is copied until the first write. Then, each block of
+ * SDL_PHYSFS_OVERLAY_BLOCK_SIZE bytes is copied into a temporary file in the
+ * write directory the first time it's written to, so patching a large file
+ * copies little while it's open. When the stream is closed, the rest of the
+ * file is copied in, and it's renamed to the same path in the write
+ * directory.
  *
- * @return The number of bytes written, or 0 on failure. Use SDL_GetError() for details.
+ * The write directory must be at the front of the search path, so later
+ * reads find the changed file without remounting. If it isn't in the search
+ * path, it's mounted there when the stream is opened. Opening fails if it's
+ * mounted at a mount point of its own, as SDL_PhysFS_InitEx() does, or
+ * behind other directories or archives; mount it first to use overlays.
+ *
+ * Other readers see the original until the stream is closed. The closed file
+ * is a complete copy that stands in for the original, so closing writes the
+ * whole file once, however little of it was changed. If the changes can't be
+ * saved, the original is left as it was, and closing the stream fails.
+ *
+ * @code
+ * SDL_IOStream* io = SDL_PhysFS_OpenOverlayIO("data/level1.map");
+ * SDL_SeekIO(io, headerOffset, SDL_IO_SEEK_SET);
+ * SDL_WriteIO(io, &header, sizeof(header));
+ * SDL_CloseIO(io);
+ * @endcode
+ *
+ * @param filename The file to open, which must exist somewhere in the search path.
+ *
+ * @return The stream, or NULL on failure. Use SDL_GetError() for details.
  *
- * @see SDL_PhysFS_LoadFile()
  * @see SDL_PhysFS_SetWriteDir()
  */
-size_t SDL_PhysFS_WriteFile(const char* file, const void* buffer, size_t size) {
-    if (file == NULL || size == 0 || buffer == NULL) {
-        return 0;
+SDL_IOStream* SDL_PhysFS_OpenOverlayIO(const char* filename) {
+    if (filename == NULL) {
+        SDL_InvalidParamError("filename");
+        return NULL;
     }
 
-    PHYSFS_File* handle = PHYSFS_openWrite(file);
-    if (handle == NULL) {
-        SDL_PhysFS_SetError("Failed to open file for writing");
-        return 0;
+    const char* writeDir = PHYSFS_getWriteDir();
+    if (writeDir == NULL) {
+        PHYSFS_setErrorCode(PHYSFS_ERR_NO_WRITE_DIR);
+        SDL_PhysFS_SetError("No write directory for overlay");
+        return NULL;
+    }
+    if (!SDL_PhysFS_MountWriteDirFirst(writeDir, filename)) {
+        return NULL;
     }
 
-    PHYSFS_sint64 bytesWritten = PHYSFS_writeBytes(handle, buffer, (PHYSFS_uint64)size);
-    if (bytesWritten <= 0) {
-        SDL_PhysFS_SetError("Failed to write data to file");
-        PHYSFS_close(handle);
-        return 0;
+    SDL_PhysFS_Overlay* overlay = (SDL_PhysFS_Overlay*)SDL_calloc(1, sizeof(SDL_PhysFS_Overlay));
+    if (overlay == NULL) {
+        return NULL;
+    }
+    while (*filename == '/') {
+        filename++;
+    }
+    overlay->filename = SDL_strdup(filename);
+    overlay->writeDir = SDL_strdup(writeDir);
+    if (overlay->filename == NULL || overlay->writeDir == NULL) {
+        SDL_PhysFS_FreeOverlay(overlay);
+        return NULL;
     }
 
-    PHYSFS_close(handle);
-    return (size_t)bytesWritten;
+    overlay->source = SDL_PhysFS_IsKnownMissing(filename) ? NULL : PHYSFS_openRead(filename);
+    if (overlay->source == NULL) {
+        SDL_PhysFS_SetError("Failed to open file");
+        SDL_PhysFS_FreeOverlay(overlay);
+        return NULL;
+    }
+    overlay->sourceLength = (Sint64)PHYSFS_fileLength(overlay->source);
+    if (overlay->sourceLength < 0) {
+        SDL_PhysFS_SetError("Failed to find the length of file");
+        PHYSFS_close(overlay->source);
+        SDL_PhysFS_FreeOverlay(overlay);
+        return NULL;
+    }
+    overlay->length = overlay->sourceLength;
+    overlay->blockCount = (size_t)((overlay->sourceLength + SDL_PHYSFS_OVERLAY_BLOCK_SIZE - 1) / SDL_PHYSFS_OVERLAY_BLOCK_SIZE);
+
+    SDL_IOStreamInterface iface;
+    SDL_INIT_INTERFACE(&iface);
+    iface.size = SDL_PhysFS_OverlayGetIOSize;
+    iface.seek = SDL_PhysFS_OverlaySeekIO;
+    iface.read = SDL_PhysFS_OverlayReadIO;
+    iface.write = SDL_PhysFS_OverlayWriteIO;
+    iface.flush = SDL_PhysFS_OverlayFlushIO;
+    iface.close = SDL_PhysFS_OverlayCloseIO;
+    SDL_IOStream* io = SDL_OpenIO(&iface, overlay);
+    if (io == NULL) {
+        PHYSFS_close(overlay->source);
+        SDL_PhysFS_FreeOverlay(overlay);
+        return NULL;
+    }
+
+    return io;
 }
 
 /**
@@ -854,12 +7669,60 @@ char** SDL_PhysFS_LoadDirectoryFiles(const char *directory) {
     return PHYSFS_enumerateFiles(directory);
 }
 
+/**
+ * State passed through PHYSFS_enumerate() by SDL_PhysFS_EnumerateDirectoryEx().
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_EnumerateContext {
+    const char* path;
+    SDL_EnumerateDirectoryCallback callback;
+    void* userdata;
+    SDL_PhysFS_HashTable* seen;
+    bool failed;
+} SDL_PhysFS_EnumerateContext;
+
+/**
+ * PHYSFS_enumerate() callback that forwards each entry to the SDL callback.
+ *
+ * @internal
+ */
+static PHYSFS_EnumerateCallbackResult SDL_PhysFS_EnumerateCallback(void* data, const char* origdir, const char* fname) {
+    SDL_PhysFS_EnumerateContext* context = (SDL_PhysFS_EnumerateContext*)data;
+    (void)origdir;
+
+    // Entries provided by more than one mount are only reported the first time.
+    if (context->seen != NULL) {
+        Uint32 hash = SDL_PhysFS_Hash(fname);
+        if (SDL_PhysFS_HashFind(context->seen, fname, hash) != NULL) {
+            return PHYSFS_ENUM_OK;
+        }
+        if (SDL_PhysFS_HashInsert(context->seen, fname, hash, NULL) == NULL) {
+            context->failed = true;
+            return PHYSFS_ENUM_ERROR;
+        }
+    }
+
+    switch (context->callback(context->userdata, context->path, fname)) {
+        case SDL_ENUM_CONTINUE:
+            return PHYSFS_ENUM_OK;
+        case SDL_ENUM_SUCCESS:
+            return PHYSFS_ENUM_STOP;
+        case SDL_ENUM_FAILURE:
+        default:
+            context->failed = true;
+            return PHYSFS_ENUM_ERROR;
+    }
+}
+
 /**
  * Enumerate a directory in PhysFS through a callback function.
  *
- * The callback is called once for each entry in the directory, until all
- * entries have been provided or the callback returns SDL_ENUM_SUCCESS or
- * SDL_ENUM_FAILURE.
+ * The callback is called once for each entry in the directory, as PhysFS finds
+ * them, until all entries have been provided or the callback returns
+ * SDL_ENUM_SUCCESS or SDL_ENUM_FAILURE. Nothing is buffered, so the same name
+ * may be provided more than once if several mounts contain it. Use
+ * SDL_PhysFS_EnumerateDirectoryEx() to skip duplicates or sort the entries.
  *
  * @param path The path of the directory to enumerate.
  * @param callback A function that is called for each entry in the directory.
@@ -868,32 +7731,358 @@ char** SDL_PhysFS_LoadDirectoryFiles(const char *directory) {
  * @return true on success, or false if there was a problem or the callback
  *         returned SDL_ENUM_FAILURE. Use SDL_GetError() for details.
  *
+ * @see SDL_PhysFS_EnumerateDirectoryEx()
  * @see SDL_PhysFS_LoadDirectoryFiles()
  */
 bool SDL_PhysFS_EnumerateDirectory(const char* path, SDL_EnumerateDirectoryCallback callback, void *userdata) {
+    return SDL_PhysFS_EnumerateDirectoryEx(path, 0, callback, userdata);
+}
+
+/**
+ * Enumerate a directory in PhysFS through a callback function, with options.
+ *
+ * With no flags, entries are streamed to the callback as PhysFS finds them.
+ * SDL_PHYSFS_ENUMERATE_UNIQUE remembers each name provided so far to skip
+ * duplicates. SDL_PHYSFS_ENUMERATE_SORTED reads the whole directory with
+ * SDL_PhysFS_LoadDirectoryFiles() first, to provide unique names in order.
+ *
+ * @param path The path of the directory to enumerate.
+ * @param flags A combination of SDL_PHYSFS_ENUMERATE_* flags, or 0.
+ * @param callback A function that is called for each entry in the directory.
+ * @param userdata A pointer that is passed to the callback.
+ *
+ * @return true on success, or false if there was a problem or the callback
+ *         returned SDL_ENUM_FAILURE. Use SDL_GetError() for details.
+ *
+ * @see SDL_PhysFS_EnumerateDirectory()
+ */
+bool SDL_PhysFS_EnumerateDirectoryEx(const char* path, SDL_PhysFS_EnumerateFlags flags, SDL_EnumerateDirectoryCallback callback, void *userdata) {
     if (callback == NULL) {
         return SDL_InvalidParamError("callback");
     }
 
-    char** directoryFiles = SDL_PhysFS_LoadDirectoryFiles(path);
-    if (!directoryFiles) {
+    if ((flags & SDL_PHYSFS_ENUMERATE_SORTED) != 0) {
+        char** directoryFiles = SDL_PhysFS_LoadDirectoryFiles(path);
+        if (!directoryFiles) {
+            SDL_PhysFS_SetError("Failed to enumerate directory");
+            return false;
+        }
+
+        bool result = true;
+        for (char** file = directoryFiles; *file != NULL; file++) {
+            SDL_EnumerationResult enumResult = callback(userdata, path, *file);
+            if (enumResult == SDL_ENUM_FAILURE) {
+                result = false;
+                break;
+            }
+            if (enumResult == SDL_ENUM_SUCCESS) {
+                break;
+            }
+        }
+
+        SDL_PhysFS_FreeDirectoryFiles(directoryFiles);
+        return result;
+    }
+
+    SDL_PhysFS_HashTable seen = { NULL, 0, 0 };
+    SDL_PhysFS_EnumerateContext context;
+    context.path = path;
+    context.callback = callback;
+    context.userdata = userdata;
+    context.seen = (flags & SDL_PHYSFS_ENUMERATE_UNIQUE) != 0 ? &seen : NULL;
+    context.failed = false;
+
+    bool result = PHYSFS_enumerate(path, SDL_PhysFS_EnumerateCallback, &context) != 0;
+    SDL_PhysFS_HashClear(&seen);
+
+    // A failing callback has already set its own error.
+    if (!result && !context.failed) {
         SDL_PhysFS_SetError("Failed to enumerate directory");
+    }
+
+    return result && !context.failed;
+}
+
+/**
+ * Matches a path against a wildcard pattern, the same way as SDL_GlobDirectory().
+ *
+ * '*' matches any number of characters and '?' matches one character, neither matching '/'.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_WildcardMatch(const char* pattern, const char* str, bool caseInsensitive) {
+    while (*pattern != '\0') {
+        if (*pattern == '*') {
+            // Try every split of the rest of this path component.
+            pattern++;
+            for (;;) {
+                if (SDL_PhysFS_WildcardMatch(pattern, str, caseInsensitive)) {
+                    return true;
+                }
+                if (*str == '\0' || *str == '/') {
+                    return false;
+                }
+                str++;
+            }
+        }
+
+        if (*str == '\0') {
+            return false;
+        }
+        if (*pattern == '?') {
+            if (*str == '/') {
+                return false;
+            }
+        }
+        else if (caseInsensitive ? SDL_tolower((unsigned char)*pattern) != SDL_tolower((unsigned char)*str) : *pattern != *str) {
+            return false;
+        }
+
+        pattern++;
+        str++;
+    }
+
+    return *str == '\0';
+}
+
+/**
+ * A directory waiting to be walked.
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_WalkDirectory {
+    struct SDL_PhysFS_WalkDirectory* next;
+    char path[1];
+} SDL_PhysFS_WalkDirectory;
+
+/**
+ * State shared by every thread taking part in SDL_PhysFS_Walk().
+ *
+ * @internal
+ */
+typedef struct SDL_PhysFS_Walker {
+    size_t rootLength;
+    const char* pattern;
+    bool caseInsensitive;
+    SDL_PhysFS_WalkCallback callback;
+    void* userdata;
+    SDL_Mutex* lock;
+    SDL_Condition* condition;
+    SDL_PhysFS_WalkDirectory* pending;
+    int active;
+    SDL_AtomicInt done;
+    bool failed;
+} SDL_PhysFS_Walker;
+
+/**
+ * Adds a directory to be walked.
+ *
+ * @internal
+ */
+static bool SDL_PhysFS_WalkPush(SDL_PhysFS_Walker* walker, const char* path) {
+    size_t length = SDL_strlen(path);
+    SDL_PhysFS_WalkDirectory* directory = (SDL_PhysFS_WalkDirectory*)SDL_malloc(sizeof(SDL_PhysFS_WalkDirectory) + length);
+    if (directory == NULL) {
         return false;
     }
+    SDL_memcpy(directory->path, path, length + 1);
 
-    bool result = true;
-    for (char** file = directoryFiles; *file != NULL; file++) {
-        SDL_EnumerationResult enumResult = callback(userdata, path, *file);
-        if (enumResult == SDL_ENUM_FAILURE) {
-            result = false;
+    SDL_LockMutex(walker->lock);
+    directory->next = walker->pending;
+    walker->pending = directory;
+    SDL_SignalCondition(walker->condition);
+    SDL_UnlockMutex(walker->lock);
+    return true;
+}
+
+/**
+ * Stops the walk, from any thread.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_WalkStop(SDL_PhysFS_Walker* walker, bool failed) {
+    SDL_LockMutex(walker->lock);
+    SDL_SetAtomicInt(&walker->done, 1);
+    walker->failed = walker->failed || failed;
+    SDL_BroadcastCondition(walker->condition);
+    SDL_UnlockMutex(walker->lock);
+}
+
+/**
+ * Reports each matching entry of a directory, and queues its subdirectories.
+ *
+ * @internal
+ */
+static void SDL_PhysFS_WalkEntries(SDL_PhysFS_Walker* walker, const char* directory) {
+    char** files = PHYSFS_enumerateFiles(directory);
+    if (files == NULL) {
+        SDL_PhysFS_SetError("Failed to enumerate directory");
+        SDL_PhysFS_WalkStop(walker, true);
+        return;
+    }
+
+    size_t directoryLength = SDL_strlen(directory);
+    bool atRoot = directoryLength == 0 || SDL_strcmp(directory, "/") == 0;
+    const char* separator = atRoot || directory[directoryLength - 1] == '/' ? "" : "/";
+    for (char** file = files; *file != NULL && SDL_GetAtomicInt(&walker->done) == 0; file++) {
+        char* path = NULL;
+        if (SDL_asprintf(&path, "%s%s%s", atRoot ? "" : directory, separator, *file) < 0) {
+            SDL_PhysFS_WalkStop(walker, true);
             break;
         }
-        if (enumResult == SDL_ENUM_SUCCESS) {
+
+        PHYSFS_Stat stat;
+        if (PHYSFS_stat(path, &stat) == 0) {
+            SDL_free(path);
+            continue;
+        }
+
+        // Symlinks aren't followed, to avoid loops.
+        if (stat.filetype == PHYSFS_FILETYPE_DIRECTORY && !SDL_PhysFS_WalkPush(walker, path)) {
+            SDL_free(path);
+            SDL_PhysFS_WalkStop(walker, true);
+            break;
+        }
+
+        const char* relative = path + SDL_min(walker->rootLength, SDL_strlen(path));
+        while (*relative == '/') {
+            relative++;
+        }
+        if (walker->pattern == NULL || SDL_PhysFS_WildcardMatch(walker->pattern, relative, walker->caseInsensitive)) {
+            SDL_PathInfo info;
+            info.type = stat.filetype == PHYSFS_FILETYPE_REGULAR ? SDL_PATHTYPE_FILE :
+                stat.filetype == PHYSFS_FILETYPE_DIRECTORY ? SDL_PATHTYPE_DIRECTORY : SDL_PATHTYPE_OTHER;
+            info.size = stat.filesize > 0 ? (Uint64)stat.filesize : 0;
+            info.create_time = stat.createtime > 0 ? (SDL_Time)stat.createtime * SDL_NS_PER_SECOND : 0;
+            info.modify_time = stat.modtime > 0 ? (SDL_Time)stat.modtime * SDL_NS_PER_SECOND : 0;
+            info.access_time = stat.accesstime > 0 ? (SDL_Time)stat.accesstime * SDL_NS_PER_SECOND : 0;
+
+            SDL_EnumerationResult result = walker->callback(walker->userdata, path, &info);
+            if (result != SDL_ENUM_CONTINUE) {
+                SDL_PhysFS_WalkStop(walker, result == SDL_ENUM_FAILURE);
+            }
+        }
+
+        SDL_free(path);
+    }
+
+    PHYSFS_freeList(files);
+}
+
+/**
+ * Walks queued directories until none are left, or the walk is stopped.
+ *
+ * @internal
+ */
+static int SDLCALL SDL_PhysFS_WalkWorker(void* data) {
+    SDL_PhysFS_Walker* walker = (SDL_PhysFS_Walker*)data;
+
+    SDL_LockMutex(walker->lock);
+    while (true) {
+        // Other threads may still queue more directories.
+        while (walker->pending == NULL && walker->active > 0 && SDL_GetAtomicInt(&walker->done) == 0) {
+            SDL_WaitCondition(walker->condition, walker->lock);
+        }
+        if (SDL_GetAtomicInt(&walker->done) != 0 || walker->pending == NULL) {
             break;
         }
+
+        SDL_PhysFS_WalkDirectory* directory = walker->pending;
+        walker->pending = directory->next;
+        walker->active++;
+        SDL_UnlockMutex(walker->lock);
+
+        SDL_PhysFS_WalkEntries(walker, directory->path);
+        SDL_free(directory);
+
+        SDL_LockMutex(walker->lock);
+        walker->active--;
+        if (walker->active == 0 && walker->pending == NULL) {
+            SDL_BroadcastCondition(walker->condition);
+        }
+    }
+    SDL_UnlockMutex(walker->lock);
+
+    return 0;
+}
+
+/**
+ * Recursively walks a directory tree in PhysFS, reporting entries that match a pattern.
+ *
+ * The pattern is matched against each entry's path relative to root, the
+ * same way as SDL_GlobDirectory(). The callback gets the entry's full path,
+ * along with its type, size and times from PHYSFS_stat().
+ *
+ * With SDL_PHYSFS_WALK_PARALLEL, subdirectories are walked on up to
+ * SDL_PHYSFS_WALK_THREADS threads, counting the calling thread, and the
+ * callback may be called concurrently from any of them.
+ * PhysFS serializes its own work behind a global lock, so this helps most
+ * when the callback does work of its own, such as loading or hashing.
+ *
+ * @code
+ * SDL_PhysFS_Walk("assets/sprites", "*.png", SDL_PHYSFS_WALK_CASEINSENSITIVE, onSprite, NULL);
+ * @endcode
+ *
+ * @param root The directory to walk.
+ * @param pattern The pattern to match entries against, or NULL to report every entry.
+ * @param flags A combination of SDL_PHYSFS_WALK_* flags, or 0.
+ * @param callback A function that is called for each matching entry.
+ * @param userdata A pointer that is passed to the callback.
+ *
+ * @return true on success, or false if there was a problem or the callback
+ *         returned SDL_ENUM_FAILURE. Use SDL_GetError() for details.
+ *
+ * @see SDL_PhysFS_EnumerateDirectory()
+ */
+bool SDL_PhysFS_Walk(const char* root, const char* pattern, SDL_PhysFS_WalkFlags flags, SDL_PhysFS_WalkCallback callback, void* userdata) {
+    if (root == NULL || callback == NULL) {
+        return SDL_InvalidParamError("root or callback");
+    }
+
+    PHYSFS_Stat stat;
+    if (PHYSFS_stat(root, &stat) == 0 || stat.filetype != PHYSFS_FILETYPE_DIRECTORY) {
+        SDL_PhysFS_SetError("Failed to find directory to walk");
+        return false;
+    }
+
+    SDL_PhysFS_Walker walker;
+    SDL_zero(walker);
+    walker.rootLength = SDL_strcmp(root, "/") == 0 ? 0 : SDL_strlen(root);
+    walker.pattern = pattern;
+    walker.caseInsensitive = (flags & SDL_PHYSFS_WALK_CASEINSENSITIVE) != 0;
+    walker.callback = callback;
+    walker.userdata = userdata;
+    walker.lock = SDL_CreateMutex();
+    walker.condition = SDL_CreateCondition();
+
+    bool result = walker.lock != NULL && walker.condition != NULL && SDL_PhysFS_WalkPush(&walker, root);
+    if (result) {
+        // The calling thread always takes part, joined by workers when walking in parallel.
+        int numThreads = (flags & SDL_PHYSFS_WALK_PARALLEL) != 0 ? SDL_min(SDL_GetNumLogicalCPUCores(), SDL_PHYSFS_WALK_THREADS) - 1 : 0;
+        SDL_Thread** threads = numThreads > 0 ? (SDL_Thread**)SDL_calloc((size_t)numThreads, sizeof(SDL_Thread*)) : NULL;
+        for (int i = 0; threads != NULL && i < numThreads; i++) {
+            threads[i] = SDL_CreateThread(SDL_PhysFS_WalkWorker, "SDL_PhysFS_Walk", &walker);
+        }
+
+        SDL_PhysFS_WalkWorker(&walker);
+
+        for (int i = 0; threads != NULL && i < numThreads; i++) {
+            if (threads[i] != NULL) {
+                SDL_WaitThread(threads[i], NULL);
+            }
+        }
+        SDL_free(threads);
+        result = !walker.failed;
+    }
+
+    while (walker.pending != NULL) {
+        SDL_PhysFS_WalkDirectory* next = walker.pending->next;
+        SDL_free(walker.pending);
+        walker.pending = next;
     }
+    SDL_DestroyCondition(walker.condition);
+    SDL_DestroyMutex(walker.lock);
 
-    SDL_PhysFS_FreeDirectoryFiles(directoryFiles);
     return result;
 }
 
@@ -910,9 +8099,11 @@ void SDL_PhysFS_FreeDirectoryFiles(char** files) {
  * Determine if a file exists in the search path.
  *
  * @return true if it exists, false otherwise.
+ *
+ * @see SDL_PhysFS_SetPathCacheEnabled()
  */
 bool SDL_PhysFS_Exists(const char* file) {
-    return PHYSFS_exists(file) != 0;
+    return SDL_PhysFS_GetRealDir(file) != NULL;
 }
 
 #ifdef __cplusplus
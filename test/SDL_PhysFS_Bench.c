@@ -0,0 +1,868 @@
+#include <SDL3/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SDL_PHYSFS_IMPLEMENTATION
+#include "SDL_PhysFS.h"
+
+/**
+ * Benchmarks for SDL_PhysFS.
+ *
+ * Generates a synthetic directory tree, and a zip archive of the same files,
+ * then measures the common operations against both.
+ *
+ *   SDL_PhysFS_Bench [--count N] [--size BYTES] [--large BYTES] [--iterations N]
+ *                    [--data DIR] [--format text|json|csv] [--output FILE]
+ *
+ * Given two archives of the same files, such as a zip built by a generic tool
+ * and one built by sdl_physfs_pack, compares mounting them and loading the
+ * files in a manifest's order instead:
+ *
+ *   SDL_PhysFS_Bench --naive ARCHIVE --packed ARCHIVE --manifest FILE
+ */
+
+#define BENCH_FILES_PER_DIRECTORY 32
+#define BENCH_MAX_RESULTS 64
+
+typedef struct BenchConfig {
+    int fileCount;
+    size_t fileSize;
+    size_t largeFileSize;
+    int iterations;
+    const char* dataDirectory;
+    const char* format;
+    const char* output;
+    const char* naiveArchive;
+    const char* packedArchive;
+    const char* manifest;
+} BenchConfig;
+
+typedef struct BenchResult {
+    char name[64];
+    const char* source;
+    int operations;
+    Uint64 bytes;
+    Uint64 totalNS;
+    Uint64 p50NS;
+    Uint64 p90NS;
+    Uint64 p99NS;
+    Uint64 maxNS;
+} BenchResult;
+
+/**
+ * Checks the result of a call the benchmark depends on, exiting if it failed.
+ *
+ * SDL_assert() compiles its condition away in optimized builds, which are the
+ * ones worth benchmarking, so the calls are made and checked with this instead.
+ */
+#define BENCH_CHECK(condition) benchCheck((condition), #condition, __LINE__)
+
+static void benchCheck(bool passed, const char* condition, int line) {
+    if (!passed) {
+        fprintf(stderr, "SDL_PhysFS_Bench.c:%d: %s failed: %s\n", line, condition, SDL_GetError());
+        exit(1);
+    }
+}
+
+static BenchConfig config = { 256, 4096, 4 * 1024 * 1024, 1000, "bench_data", "text", NULL, NULL, NULL, NULL };
+static BenchResult results[BENCH_MAX_RESULTS];
+static int resultCount = 0;
+static Uint64* samples = NULL;
+static Uint64 randomState = 0x5EED;
+
+static int SDLCALL benchCompareSamples(const void* a, const void* b) {
+    Uint64 left = *(const Uint64*)a;
+    Uint64 right = *(const Uint64*)b;
+    return (left > right) - (left < right);
+}
+
+/**
+ * Nearest-rank percentile of the sorted samples.
+ */
+static Uint64 benchPercentile(int count, int percent) {
+    int rank = (count * percent + 99) / 100;
+    return samples[rank > 0 ? rank - 1 : 0];
+}
+
+/**
+ * Records the samples collected by a benchmark.
+ */
+static void benchFinish(const char* name, const char* source, int count, Uint64 bytes) {
+    BENCH_CHECK(resultCount < BENCH_MAX_RESULTS);
+    BENCH_CHECK(count > 0);
+    BenchResult* result = &results[resultCount++];
+    SDL_strlcpy(result->name, name, sizeof(result->name));
+    result->source = source;
+    result->operations = count;
+    result->bytes = bytes;
+    result->totalNS = 0;
+    for (int i = 0; i < count; i++) {
+        result->totalNS += samples[i];
+    }
+
+    SDL_qsort(samples, (size_t)count, sizeof(Uint64), benchCompareSamples);
+    result->p50NS = benchPercentile(count, 50);
+    result->p90NS = benchPercentile(count, 90);
+    result->p99NS = benchPercentile(count, 99);
+    result->maxNS = samples[count - 1];
+}
+
+static Uint64 benchRandom(Uint64 bound) {
+    return ((Uint64)SDL_rand_bits_r(&randomState) << 32 | SDL_rand_bits_r(&randomState)) % bound;
+}
+
+static void benchFileName(char* buffer, size_t size, int index) {
+    SDL_snprintf(buffer, size, "d%03d/file%05d.bin", index / BENCH_FILES_PER_DIRECTORY, index);
+}
+
+static void benchFillData(Uint8* data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        data[i] = (Uint8)SDL_rand_bits_r(&randomState);
+    }
+}
+
+/**
+ * Writes a single generated file into the directory tree, and as a stored entry in the zip.
+ */
+static void benchAddFile(const char* tree, SDL_IOStream* zip, SDL_IOStream* centralDirectory, int* entries, const char* name, const Uint8* data, size_t size) {
+    char path[512];
+    SDL_snprintf(path, sizeof(path), "%s/%s", tree, name);
+    char* lastSlash = SDL_strrchr(path, '/');
+    *lastSlash = '\0';
+    BENCH_CHECK(SDL_CreateDirectory(path));
+    *lastSlash = '/';
+    BENCH_CHECK(SDL_SaveFile(path, data, size));
+
+    Uint32 crc = SDL_crc32(0, data, size);
+    Uint16 nameLength = (Uint16)SDL_strlen(name);
+    Uint32 offset = (Uint32)SDL_TellIO(zip);
+
+    BENCH_CHECK(SDL_WriteU32LE(zip, 0x04034b50));
+    BENCH_CHECK(SDL_WriteU16LE(zip, 10));
+    BENCH_CHECK(SDL_WriteU16LE(zip, 0));
+    BENCH_CHECK(SDL_WriteU16LE(zip, 0));
+    BENCH_CHECK(SDL_WriteU16LE(zip, 0));
+    BENCH_CHECK(SDL_WriteU16LE(zip, 0x21));
+    BENCH_CHECK(SDL_WriteU32LE(zip, crc));
+    BENCH_CHECK(SDL_WriteU32LE(zip, (Uint32)size));
+    BENCH_CHECK(SDL_WriteU32LE(zip, (Uint32)size));
+    BENCH_CHECK(SDL_WriteU16LE(zip, nameLength));
+    BENCH_CHECK(SDL_WriteU16LE(zip, 0));
+    BENCH_CHECK(SDL_WriteIO(zip, name, nameLength) == nameLength);
+    BENCH_CHECK(SDL_WriteIO(zip, data, size) == size);
+
+    BENCH_CHECK(SDL_WriteU32LE(centralDirectory, 0x02014b50));
+    BENCH_CHECK(SDL_WriteU16LE(centralDirectory, 20));
+    BENCH_CHECK(SDL_WriteU16LE(centralDirectory, 10));
+    BENCH_CHECK(SDL_WriteU16LE(centralDirectory, 0));
+    BENCH_CHECK(SDL_WriteU16LE(centralDirectory, 0));
+    BENCH_CHECK(SDL_WriteU16LE(centralDirectory, 0));
+    BENCH_CHECK(SDL_WriteU16LE(centralDirectory, 0x21));
+    BENCH_CHECK(SDL_WriteU32LE(centralDirectory, crc));
+    BENCH_CHECK(SDL_WriteU32LE(centralDirectory, (Uint32)size));
+    BENCH_CHECK(SDL_WriteU32LE(centralDirectory, (Uint32)size));
+    BENCH_CHECK(SDL_WriteU16LE(centralDirectory, nameLength));
+    BENCH_CHECK(SDL_WriteU16LE(centralDirectory, 0));
+    BENCH_CHECK(SDL_WriteU16LE(centralDirectory, 0));
+    BENCH_CHECK(SDL_WriteU16LE(centralDirectory, 0));
+    BENCH_CHECK(SDL_WriteU16LE(centralDirectory, 0));
+    BENCH_CHECK(SDL_WriteU32LE(centralDirectory, 0));
+    BENCH_CHECK(SDL_WriteU32LE(centralDirectory, offset));
+    BENCH_CHECK(SDL_WriteIO(centralDirectory, name, nameLength) == nameLength);
+
+    (*entries)++;
+}
+
+/**
+ * Generates the synthetic data set: a directory tree and a zip archive holding the same files.
+ */
+static void benchGenerate(const char* tree, const char* zipPath) {
+    BENCH_CHECK(SDL_CreateDirectory(tree));
+    SDL_IOStream* zip = SDL_IOFromFile(zipPath, "wb");
+    BENCH_CHECK(zip != NULL);
+    SDL_IOStream* centralDirectory = SDL_IOFromDynamicMem();
+    BENCH_CHECK(centralDirectory != NULL);
+
+    int entries = 0;
+    char name[64];
+    Uint8* data = (Uint8*)SDL_malloc(config.fileSize);
+    BENCH_CHECK(data != NULL);
+    for (int i = 0; i < config.fileCount; i++) {
+        benchFillData(data, config.fileSize);
+        benchFileName(name, sizeof(name), i);
+        benchAddFile(tree, zip, centralDirectory, &entries, name, data, config.fileSize);
+    }
+    SDL_free(data);
+
+    Uint8* large = (Uint8*)SDL_malloc(config.largeFileSize);
+    BENCH_CHECK(large != NULL);
+    benchFillData(large, config.largeFileSize);
+    benchAddFile(tree, zip, centralDirectory, &entries, "large.bin", large, config.largeFileSize);
+    SDL_free(large);
+
+    // Central directory, followed by the end of central directory record
+    Sint64 directorySize = SDL_GetIOSize(centralDirectory);
+    Uint32 directoryOffset = (Uint32)SDL_TellIO(zip);
+    void* directory = SDL_GetPointerProperty(SDL_GetIOProperties(centralDirectory), SDL_PROP_IOSTREAM_DYNAMIC_MEMORY_POINTER, NULL);
+    BENCH_CHECK(SDL_WriteIO(zip, directory, (size_t)directorySize) == (size_t)directorySize);
+    SDL_CloseIO(centralDirectory);
+
+    // More entries than the end record can count go in a zip64 record, with a locator for it.
+    if (entries >= 0xFFFF) {
+        Uint64 zip64Offset = (Uint64)SDL_TellIO(zip);
+        BENCH_CHECK(SDL_WriteU32LE(zip, 0x06064b50));
+        BENCH_CHECK(SDL_WriteU64LE(zip, 44));
+        BENCH_CHECK(SDL_WriteU16LE(zip, 45));
+        BENCH_CHECK(SDL_WriteU16LE(zip, 45));
+        BENCH_CHECK(SDL_WriteU32LE(zip, 0));
+        BENCH_CHECK(SDL_WriteU32LE(zip, 0));
+        BENCH_CHECK(SDL_WriteU64LE(zip, (Uint64)entries));
+        BENCH_CHECK(SDL_WriteU64LE(zip, (Uint64)entries));
+        BENCH_CHECK(SDL_WriteU64LE(zip, (Uint64)directorySize));
+        BENCH_CHECK(SDL_WriteU64LE(zip, directoryOffset));
+        BENCH_CHECK(SDL_WriteU32LE(zip, 0x07064b50));
+        BENCH_CHECK(SDL_WriteU32LE(zip, 0));
+        BENCH_CHECK(SDL_WriteU64LE(zip, zip64Offset));
+        BENCH_CHECK(SDL_WriteU32LE(zip, 1));
+    }
+
+    BENCH_CHECK(SDL_WriteU32LE(zip, 0x06054b50));
+    BENCH_CHECK(SDL_WriteU16LE(zip, 0));
+    BENCH_CHECK(SDL_WriteU16LE(zip, 0));
+    BENCH_CHECK(SDL_WriteU16LE(zip, (Uint16)SDL_min(entries, 0xFFFF)));
+    BENCH_CHECK(SDL_WriteU16LE(zip, (Uint16)SDL_min(entries, 0xFFFF)));
+    BENCH_CHECK(SDL_WriteU32LE(zip, (Uint32)directorySize));
+    BENCH_CHECK(SDL_WriteU32LE(zip, directoryOffset));
+    BENCH_CHECK(SDL_WriteU16LE(zip, 0));
+    BENCH_CHECK(SDL_CloseIO(zip));
+}
+
+static void benchLoadFile(const char* name, const char* source) {
+    char filename[128];
+    char path[64];
+    Uint64 bytes = 0;
+    for (int i = 0; i < config.iterations; i++) {
+        benchFileName(path, sizeof(path), (int)benchRandom((Uint64)config.fileCount));
+        SDL_snprintf(filename, sizeof(filename), "%s/%s", source, path);
+        Uint64 start = SDL_GetTicksNS();
+        size_t size;
+        void* data = SDL_PhysFS_LoadFile(filename, &size);
+        samples[i] = SDL_GetTicksNS() - start;
+        BENCH_CHECK(data != NULL);
+        bytes += size;
+        SDL_free(data);
+    }
+    benchFinish(name, source, config.iterations, bytes);
+}
+
+typedef struct BenchWorker {
+    const char* source;
+    int first;
+    int count;
+    Uint64 bytes;
+} BenchWorker;
+
+/**
+ * Loads its share of the small files, writing each load's time into its own part of the samples.
+ */
+static int SDLCALL benchLoadWorker(void* data) {
+    BenchWorker* worker = (BenchWorker*)data;
+    char filename[128];
+    char path[64];
+    for (int i = 0; i < worker->count; i++) {
+        int index = worker->first + i;
+        benchFileName(path, sizeof(path), (int)(((Uint64)index * 7919) % (Uint64)config.fileCount));
+        SDL_snprintf(filename, sizeof(filename), "%s/%s", worker->source, path);
+        Uint64 start = SDL_GetTicksNS();
+        size_t size;
+        void* loaded = SDL_PhysFS_LoadFile(filename, &size);
+        samples[index] = SDL_GetTicksNS() - start;
+        BENCH_CHECK(loaded != NULL);
+        worker->bytes += size;
+        SDL_free(loaded);
+    }
+
+    return 0;
+}
+
+/**
+ * Loads small files from several threads at once.
+ */
+static void benchThreadedLoads(const char* name, const char* source, int numThreads) {
+    BenchWorker workers[16];
+    SDL_Thread* threads[16];
+    numThreads = SDL_min(SDL_min(numThreads, (int)SDL_arraysize(threads)), config.iterations);
+    int perThread = config.iterations / numThreads;
+
+    Uint64 start = SDL_GetTicksNS();
+    for (int i = 0; i < numThreads; i++) {
+        workers[i].source = source;
+        workers[i].first = i * perThread;
+        workers[i].count = perThread;
+        workers[i].bytes = 0;
+        threads[i] = SDL_CreateThread(benchLoadWorker, "benchLoadWorker", &workers[i]);
+        BENCH_CHECK(threads[i] != NULL);
+    }
+    Uint64 bytes = 0;
+    for (int i = 0; i < numThreads; i++) {
+        SDL_WaitThread(threads[i], NULL);
+        bytes += workers[i].bytes;
+    }
+    Uint64 elapsed = SDL_GetTicksNS() - start;
+
+    char label[64];
+    SDL_snprintf(label, sizeof(label), "%s x%d threads", name, numThreads);
+    benchFinish(label, source, perThread * numThreads, bytes);
+
+    // Throughput is over the wall clock time, rather than the sum of every load's time.
+    results[resultCount - 1].totalNS = elapsed;
+}
+
+/**
+ * Reads whole small files in 64 byte chunks, the way many decoders do.
+ */
+static void benchSmallReads(const char* name, const char* source, size_t bufferSize) {
+    char filename[128];
+    char path[64];
+    Uint64 bytes = 0;
+    Uint8 chunk[64];
+    for (int i = 0; i < config.iterations; i++) {
+        benchFileName(path, sizeof(path), (int)benchRandom((Uint64)config.fileCount));
+        SDL_snprintf(filename, sizeof(filename), "%s/%s", source, path);
+        Uint64 start = SDL_GetTicksNS();
+        SDL_IOStream* io = SDL_PhysFS_IOFromFileEx(filename, bufferSize);
+        BENCH_CHECK(io != NULL);
+        size_t read;
+        while ((read = SDL_ReadIO(io, chunk, sizeof(chunk))) > 0) {
+            bytes += read;
+        }
+        SDL_CloseIO(io);
+        samples[i] = SDL_GetTicksNS() - start;
+    }
+    benchFinish(name, source, config.iterations, bytes);
+}
+
+/**
+ * Reads the large file start to finish in 1 MB chunks.
+ */
+static void benchLargeReads(const char* source) {
+    char filename[64];
+    SDL_snprintf(filename, sizeof(filename), "%s/large.bin", source);
+    size_t chunkSize = 1024 * 1024;
+    Uint8* chunk = (Uint8*)SDL_malloc(chunkSize);
+    BENCH_CHECK(chunk != NULL);
+    int iterations = SDL_max(config.iterations / 100, 5);
+    Uint64 bytes = 0;
+    for (int i = 0; i < iterations; i++) {
+        Uint64 start = SDL_GetTicksNS();
+        SDL_IOStream* io = SDL_PhysFS_IOFromFile(filename);
+        BENCH_CHECK(io != NULL);
+        size_t read;
+        while ((read = SDL_ReadIO(io, chunk, chunkSize)) > 0) {
+            bytes += read;
+        }
+        SDL_CloseIO(io);
+        samples[i] = SDL_GetTicksNS() - start;
+    }
+    SDL_free(chunk);
+    benchFinish("IOFromFile large reads", source, iterations, bytes);
+}
+
+/**
+ * Seeks to random offsets in the large file, reading 4 KB at each.
+ */
+static void benchRandomSeeks(const char* source) {
+    char filename[64];
+    SDL_snprintf(filename, sizeof(filename), "%s/large.bin", source);
+    SDL_IOStream* io = SDL_PhysFS_IOFromFile(filename);
+    BENCH_CHECK(io != NULL);
+    Uint8 chunk[4096];
+    Uint64 bytes = 0;
+    for (int i = 0; i < config.iterations; i++) {
+        Sint64 offset = (Sint64)benchRandom((Uint64)(config.largeFileSize - sizeof(chunk)));
+        Uint64 start = SDL_GetTicksNS();
+        BENCH_CHECK(SDL_SeekIO(io, offset, SDL_IO_SEEK_SET) == offset);
+        bytes += SDL_ReadIO(io, chunk, sizeof(chunk));
+        samples[i] = SDL_GetTicksNS() - start;
+    }
+    SDL_CloseIO(io);
+    benchFinish("SeekIO random 4KB reads", source, config.iterations, bytes);
+}
+
+/**
+ * Walks through the large file with short forward seeks, the way decoders skip chunks they don't need.
+ */
+static void benchForwardSeeks(const char* source) {
+    char filename[64];
+    SDL_snprintf(filename, sizeof(filename), "%s/large.bin", source);
+    Uint8 chunk[64];
+    Uint64 bytes = 0;
+    int iterations = SDL_max(config.iterations / 100, 5);
+    for (int i = 0; i < iterations; i++) {
+        SDL_IOStream* io = SDL_PhysFS_IOFromFile(filename);
+        BENCH_CHECK(io != NULL);
+        Uint64 start = SDL_GetTicksNS();
+        size_t read;
+        while ((read = SDL_ReadIO(io, chunk, sizeof(chunk))) > 0) {
+            bytes += read;
+            if (SDL_SeekIO(io, 1024, SDL_IO_SEEK_CUR) < 0) {
+                break;
+            }
+        }
+        samples[i] = SDL_GetTicksNS() - start;
+        SDL_CloseIO(io);
+    }
+    benchFinish("SeekIO short forward seeks", source, iterations, bytes);
+}
+
+/**
+ * Reads the large file in 4 KB chunks, stepping back 1 KB after each, the way decoders look back at what they just read.
+ */
+static void benchBackwardSeeks(const char* name, const char* source, size_t rewindSize) {
+    char filename[64];
+    SDL_snprintf(filename, sizeof(filename), "%s/large.bin", source);
+    Uint8 chunk[4096];
+    Uint64 bytes = 0;
+    int iterations = SDL_max(config.iterations / 100, 5);
+    for (int i = 0; i < iterations; i++) {
+        SDL_IOStream* io = SDL_PhysFS_IOFromFile(filename);
+        BENCH_CHECK(io != NULL);
+        BENCH_CHECK(SDL_PhysFS_SetIORewindSize(io, rewindSize));
+        Uint64 start = SDL_GetTicksNS();
+        size_t read;
+        while ((read = SDL_ReadIO(io, chunk, sizeof(chunk))) == sizeof(chunk)) {
+            bytes += read;
+            if (SDL_SeekIO(io, -1024, SDL_IO_SEEK_CUR) < 0) {
+                break;
+            }
+        }
+        samples[i] = SDL_GetTicksNS() - start;
+        SDL_CloseIO(io);
+    }
+    benchFinish(name, source, iterations, bytes);
+}
+
+/**
+ * Asks for the position and size repeatedly, the way decoders probe a stream.
+ */
+static void benchTellSize(const char* source) {
+    char filename[64];
+    SDL_snprintf(filename, sizeof(filename), "%s/large.bin", source);
+    SDL_IOStream* io = SDL_PhysFS_IOFromFile(filename);
+    BENCH_CHECK(io != NULL);
+    for (int i = 0; i < config.iterations; i++) {
+        Uint64 start = SDL_GetTicksNS();
+        for (int j = 0; j < 100; j++) {
+            BENCH_CHECK(SDL_TellIO(io) >= 0);
+            BENCH_CHECK(SDL_GetIOSize(io) == (Sint64)config.largeFileSize);
+        }
+        samples[i] = SDL_GetTicksNS() - start;
+    }
+    SDL_CloseIO(io);
+    benchFinish("TellIO/GetIOSize x100", source, config.iterations, 0);
+}
+
+static SDL_EnumerationResult SDLCALL benchEnumerateCounter(void* userdata, const char* dirname, const char* fname) {
+    (void)dirname;
+    (void)fname;
+    (*(int*)userdata)++;
+    return SDL_ENUM_CONTINUE;
+}
+
+static void benchEnumerate(const char* source) {
+    char directory[64];
+    int directories = (config.fileCount + BENCH_FILES_PER_DIRECTORY - 1) / BENCH_FILES_PER_DIRECTORY;
+    for (int i = 0; i < config.iterations; i++) {
+        SDL_snprintf(directory, sizeof(directory), "%s/d%03d", source, (int)benchRandom((Uint64)directories));
+        int entries = 0;
+        Uint64 start = SDL_GetTicksNS();
+        BENCH_CHECK(SDL_PhysFS_EnumerateDirectory(directory, benchEnumerateCounter, &entries));
+        samples[i] = SDL_GetTicksNS() - start;
+        BENCH_CHECK(entries > 0);
+    }
+    benchFinish("EnumerateDirectory", source, config.iterations, 0);
+}
+
+/**
+ * Checks for files that exist, and files that don't, in equal measure.
+ */
+static void benchExists(const char* name, const char* source) {
+    char filename[128];
+    char path[64];
+    for (int i = 0; i < config.iterations; i++) {
+        int index = (int)benchRandom((Uint64)config.fileCount);
+        bool present = (i & 1) == 0;
+        benchFileName(path, sizeof(path), present ? index : config.fileCount + index);
+        SDL_snprintf(filename, sizeof(filename), "%s/%s", source, path);
+        Uint64 start = SDL_GetTicksNS();
+        bool exists = SDL_PhysFS_Exists(filename);
+        samples[i] = SDL_GetTicksNS() - start;
+        BENCH_CHECK(exists == present);
+    }
+    benchFinish(name, source, config.iterations, 0);
+}
+
+/**
+ * Opens files that don't exist, either reporting the error through SDL or probing quietly.
+ */
+static void benchMisses(const char* name, const char* source, bool quiet) {
+    char filename[128];
+    char path[64];
+    for (int i = 0; i < config.iterations; i++) {
+        benchFileName(path, sizeof(path), config.fileCount + (int)benchRandom((Uint64)config.fileCount));
+        SDL_snprintf(filename, sizeof(filename), "%s/%s", source, path);
+        Uint64 start = SDL_GetTicksNS();
+        SDL_IOStream* io = NULL;
+        if (quiet) {
+            SDL_PhysFS_TryOpen(filename, &io);
+        }
+        else {
+            io = SDL_PhysFS_IOFromFile(filename);
+        }
+        samples[i] = SDL_GetTicksNS() - start;
+        BENCH_CHECK(io == NULL);
+    }
+    benchFinish(name, source, config.iterations, 0);
+}
+
+static void benchWriteFile(void) {
+    Uint8* data = (Uint8*)SDL_malloc(config.fileSize);
+    BENCH_CHECK(data != NULL);
+    benchFillData(data, config.fileSize);
+    char filename[64];
+    Uint64 bytes = 0;
+    for (int i = 0; i < config.iterations; i++) {
+        SDL_snprintf(filename, sizeof(filename), "out%03d.bin", i % 100);
+        Uint64 start = SDL_GetTicksNS();
+        bytes += SDL_PhysFS_WriteFile(filename, data, config.fileSize);
+        samples[i] = SDL_GetTicksNS() - start;
+    }
+    SDL_free(data);
+    benchFinish("WriteFile", "write", config.iterations, bytes);
+}
+
+/**
+ * Opens and closes a file repeatedly, which is dominated by PhysFS's small allocations.
+ */
+static void benchOpenClose(const char* source) {
+    char filename[64];
+    benchFileName(filename, sizeof(filename), 0);
+    char path[128];
+    SDL_snprintf(path, sizeof(path), "%s/%s", source, filename);
+    for (int i = 0; i < config.iterations; i++) {
+        Uint64 start = SDL_GetTicksNS();
+        SDL_IOStream* io = SDL_PhysFS_IOFromFile(path);
+        BENCH_CHECK(io != NULL);
+        SDL_CloseIO(io);
+        samples[i] = SDL_GetTicksNS() - start;
+    }
+    benchFinish("IOFromFile open/close", source, config.iterations, 0);
+}
+
+/**
+ * Mounts the archive and looks up one file, through its central directory and then through a mount index.
+ *
+ * PhysFS starts from nothing on each mount, as it does at launch, though the OS still caches the files.
+ */
+static void benchMountIndex(const char* zip) {
+    char indexPath[512];
+    SDL_snprintf(indexPath, sizeof(indexPath), "%s%s", zip, SDL_PHYSFS_MOUNT_INDEX_EXTENSION);
+    int iterations = SDL_min(SDL_max(config.iterations / 10, 5), config.iterations);
+    for (int indexed = 0; indexed < 2; indexed++) {
+        if (indexed) {
+            BENCH_CHECK(SDL_PhysFS_WriteMountIndex(zip));
+        }
+        for (int i = 0; i < iterations; i++) {
+            Uint64 start = SDL_GetTicksNS();
+            BENCH_CHECK(SDL_PhysFS_Mount(zip, "mount"));
+            BENCH_CHECK(SDL_PhysFS_Exists("mount/large.bin"));
+            samples[i] = SDL_GetTicksNS() - start;
+            BENCH_CHECK(SDL_PhysFS_Unmount(zip));
+        }
+        benchFinish(indexed ? "Mount (mount index)" : "Mount (central directory)", "zip", iterations, 0);
+    }
+    BENCH_CHECK(SDL_RemovePath(indexPath));
+}
+
+static double benchSeconds(Uint64 ns) {
+    return (double)ns / (double)SDL_NS_PER_SECOND;
+}
+
+static void benchWriteResults(FILE* out, const char* allocator) {
+    if (SDL_strcmp(config.format, "json") == 0) {
+        fprintf(out, "{\n  \"allocator\": \"%s\",\n  \"files\": %d,\n  \"fileSize\": %u,\n  \"largeFileSize\": %u,\n  \"results\": [\n",
+            allocator, config.fileCount, (unsigned)config.fileSize, (unsigned)config.largeFileSize);
+        for (int i = 0; i < resultCount; i++) {
+            const BenchResult* result = &results[i];
+            double seconds = benchSeconds(result->totalNS);
+            fprintf(out, "    {\"name\": \"%s\", \"source\": \"%s\", \"operations\": %d, \"bytes\": %" SDL_PRIu64 ", "
+                "\"opsPerSecond\": %.1f, \"mbPerSecond\": %.2f, \"p50NS\": %" SDL_PRIu64 ", \"p90NS\": %" SDL_PRIu64 ", "
+                "\"p99NS\": %" SDL_PRIu64 ", \"maxNS\": %" SDL_PRIu64 "}%s\n",
+                result->name, result->source, result->operations, result->bytes,
+                seconds > 0 ? result->operations / seconds : 0.0,
+                seconds > 0 ? (double)result->bytes / (1024.0 * 1024.0) / seconds : 0.0,
+                result->p50NS, result->p90NS, result->p99NS, result->maxNS,
+                i + 1 < resultCount ? "," : "");
+        }
+        fprintf(out, "  ]\n}\n");
+    }
+    else if (SDL_strcmp(config.format, "csv") == 0) {
+        fprintf(out, "name,source,allocator,operations,bytes,ops_per_second,mb_per_second,p50_ns,p90_ns,p99_ns,max_ns\n");
+        for (int i = 0; i < resultCount; i++) {
+            const BenchResult* result = &results[i];
+            double seconds = benchSeconds(result->totalNS);
+            fprintf(out, "%s,%s,%s,%d,%" SDL_PRIu64 ",%.1f,%.2f,%" SDL_PRIu64 ",%" SDL_PRIu64 ",%" SDL_PRIu64 ",%" SDL_PRIu64 "\n",
+                result->name, result->source, allocator, result->operations, result->bytes,
+                seconds > 0 ? result->operations / seconds : 0.0,
+                seconds > 0 ? (double)result->bytes / (1024.0 * 1024.0) / seconds : 0.0,
+                result->p50NS, result->p90NS, result->p99NS, result->maxNS);
+        }
+    }
+    else {
+        fprintf(out, "Allocator: %s, %d files of %u bytes, large file of %u bytes\n",
+            allocator, config.fileCount, (unsigned)config.fileSize, (unsigned)config.largeFileSize);
+        fprintf(out, "%-28s %-6s %12s %10s %10s %10s %10s %10s\n", "benchmark", "source", "ops/s", "MB/s", "p50 us", "p90 us", "p99 us", "max us");
+        for (int i = 0; i < resultCount; i++) {
+            const BenchResult* result = &results[i];
+            double seconds = benchSeconds(result->totalNS);
+            fprintf(out, "%-28s %-6s %12.1f %10.2f %10.2f %10.2f %10.2f %10.2f\n",
+                result->name, result->source,
+                seconds > 0 ? result->operations / seconds : 0.0,
+                seconds > 0 ? (double)result->bytes / (1024.0 * 1024.0) / seconds : 0.0,
+                (double)result->p50NS / 1000.0, (double)result->p90NS / 1000.0,
+                (double)result->p99NS / 1000.0, (double)result->maxNS / 1000.0);
+        }
+    }
+}
+
+static bool benchParseArguments(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (value == NULL) {
+            return false;
+        }
+        if (SDL_strcmp(argv[i], "--count") == 0) {
+            config.fileCount = SDL_atoi(value);
+        }
+        else if (SDL_strcmp(argv[i], "--size") == 0) {
+            config.fileSize = (size_t)SDL_strtoul(value, NULL, 10);
+        }
+        else if (SDL_strcmp(argv[i], "--large") == 0) {
+            config.largeFileSize = (size_t)SDL_strtoul(value, NULL, 10);
+        }
+        else if (SDL_strcmp(argv[i], "--iterations") == 0) {
+            config.iterations = SDL_atoi(value);
+        }
+        else if (SDL_strcmp(argv[i], "--data") == 0) {
+            config.dataDirectory = value;
+        }
+        else if (SDL_strcmp(argv[i], "--format") == 0) {
+            config.format = value;
+        }
+        else if (SDL_strcmp(argv[i], "--output") == 0) {
+            config.output = value;
+        }
+        else if (SDL_strcmp(argv[i], "--naive") == 0) {
+            config.naiveArchive = value;
+        }
+        else if (SDL_strcmp(argv[i], "--packed") == 0) {
+            config.packedArchive = value;
+        }
+        else if (SDL_strcmp(argv[i], "--manifest") == 0) {
+            config.manifest = value;
+        }
+        else {
+            return false;
+        }
+        i++;
+    }
+
+    // Comparing archives needs both of them, and the order to load their files in.
+    if ((config.naiveArchive != NULL || config.packedArchive != NULL || config.manifest != NULL) &&
+        (config.naiveArchive == NULL || config.packedArchive == NULL || config.manifest == NULL)) {
+        return false;
+    }
+
+    return config.fileCount > 0 && config.fileSize > 0 && config.largeFileSize > 4096 && config.iterations > 0;
+}
+
+/**
+ * Runs the benchmarks against the generated directory tree and zip archive.
+ */
+static void benchSuite(const char* argv0) {
+    // Each configuration gets its own data set, so differently sized runs don't mix.
+    char tree[512];
+    char zip[512];
+    char write[512];
+    SDL_snprintf(tree, sizeof(tree), "%s/%dx%u", config.dataDirectory, config.fileCount, (unsigned)config.fileSize);
+    SDL_snprintf(zip, sizeof(zip), "%s.zip", tree);
+    SDL_snprintf(write, sizeof(write), "%s/write", config.dataDirectory);
+    BENCH_CHECK(SDL_CreateDirectory(config.dataDirectory));
+    BENCH_CHECK(SDL_CreateDirectory(write));
+    benchGenerate(tree, zip);
+
+    BENCH_CHECK(SDL_PhysFS_Init(argv0));
+    benchMountIndex(zip);
+    BENCH_CHECK(SDL_PhysFS_Mount(tree, "dir"));
+    BENCH_CHECK(SDL_PhysFS_Mount(zip, "zip"));
+    BENCH_CHECK(SDL_PhysFS_SetWriteDir(write));
+
+    const char* sources[] = { "dir", "zip" };
+    for (size_t i = 0; i < SDL_arraysize(sources); i++) {
+        const char* source = sources[i];
+        benchLoadFile("LoadFile", source);
+        SDL_PhysFS_SetContentCacheSize(config.fileSize * (size_t)config.fileCount * 2);
+        benchLoadFile("LoadFile (content cache)", source);
+        SDL_PhysFS_SetContentCacheSize(0);
+        benchSmallReads("IOFromFile small reads", source, SDL_PHYSFS_DIRECTORY_BUFFER_SIZE);
+        benchSmallReads("IOFromFileEx unbuffered reads", source, 0);
+        benchLargeReads(source);
+        benchRandomSeeks(source);
+        benchForwardSeeks(source);
+        benchBackwardSeeks("SeekIO short backward seeks", source, 0);
+        benchBackwardSeeks("SeekIO short backward seeks (rewind)", source, 8192);
+        benchTellSize(source);
+        benchEnumerate(source);
+        benchExists("Exists", source);
+        SDL_PhysFS_SetPathCacheEnabled(true);
+        benchExists("Exists (path cache)", source);
+        benchMisses("TryOpen misses (path cache)", source, true);
+        SDL_PhysFS_SetPathCacheEnabled(false);
+        benchMisses("IOFromFile misses", source, false);
+        benchMisses("TryOpen misses", source, true);
+        benchOpenClose(source);
+    }
+    benchWriteFile();
+
+    // Scaling across threads from one archive, through PhysFS and then with parallel reads.
+    const int threadCounts[] = { 1, 2, 4, 8, 16 };
+    for (size_t i = 0; i < SDL_arraysize(threadCounts); i++) {
+        benchThreadedLoads("LoadFile", "zip", threadCounts[i]);
+    }
+    SDL_PhysFS_SetParallelReads(true);
+    for (size_t i = 0; i < SDL_arraysize(threadCounts); i++) {
+        benchThreadedLoads("LoadFile (parallel reads)", "zip", threadCounts[i]);
+    }
+    SDL_PhysFS_SetParallelReads(false);
+
+    BENCH_CHECK(SDL_PhysFS_Quit());
+}
+
+/**
+ * Reads the manifest into a list of filenames, in order.
+ */
+static char** benchLoadManifest(int* count) {
+    size_t size;
+    char* text = (char*)SDL_LoadFile(config.manifest, &size);
+    BENCH_CHECK(text != NULL);
+
+    int lines = 1;
+    for (size_t i = 0; i < size; i++) {
+        lines += text[i] == '\n';
+    }
+
+    // The filenames point into the text, which is freed along with the list.
+    char** names = (char**)SDL_malloc(sizeof(char*) * ((size_t)lines + 1));
+    BENCH_CHECK(names != NULL);
+    *count = 0;
+    char* line = text;
+    while (line != NULL && *line != '\0') {
+        char* next = SDL_strchr(line, '\n');
+        if (next != NULL) {
+            *next++ = '\0';
+        }
+        size_t length = SDL_strlen(line);
+        if (length > 0 && line[length - 1] == '\r') {
+            line[length - 1] = '\0';
+        }
+        if (*line != '\0') {
+            names[(*count)++] = line;
+        }
+        line = next;
+    }
+    names[*count] = text;
+
+    return names;
+}
+
+/**
+ * Mounts an archive, then loads every file in the manifest from it, in order.
+ */
+static void benchLoadArchive(const char* source, const char* archive, char** names, int count) {
+    char filename[512];
+    int iterations = SDL_min(SDL_max(config.iterations / 100, 5), config.iterations);
+    Uint64* loads = (Uint64*)SDL_malloc(sizeof(Uint64) * (size_t)iterations);
+    BENCH_CHECK(loads != NULL);
+    Uint64 bytes = 0;
+    for (int i = 0; i < iterations; i++) {
+        Uint64 start = SDL_GetTicksNS();
+        BENCH_CHECK(SDL_PhysFS_Mount(archive, source));
+        Uint64 mounted = SDL_GetTicksNS();
+        for (int j = 0; j < count; j++) {
+            SDL_snprintf(filename, sizeof(filename), "%s/%s", source, names[j]);
+            size_t size;
+            void* data = SDL_PhysFS_LoadFile(filename, &size);
+            BENCH_CHECK(data != NULL);
+            bytes += size;
+            SDL_free(data);
+        }
+        loads[i] = SDL_GetTicksNS() - mounted;
+        samples[i] = mounted - start;
+        BENCH_CHECK(SDL_PhysFS_Unmount(archive));
+    }
+    benchFinish("Mount", source, iterations, 0);
+
+    SDL_memcpy(samples, loads, sizeof(Uint64) * (size_t)iterations);
+    SDL_free(loads);
+    benchFinish("LoadFile manifest order", source, iterations, bytes);
+}
+
+/**
+ * Compares an archive built by sdl_physfs_pack against another archive of the same files.
+ */
+static void benchCompareArchives(const char* argv0) {
+    int count;
+    char** names = benchLoadManifest(&count);
+    BENCH_CHECK(SDL_PhysFS_Init(argv0));
+    benchLoadArchive("naive", config.naiveArchive, names, count);
+    benchLoadArchive("packed", config.packedArchive, names, count);
+    BENCH_CHECK(SDL_PhysFS_Quit());
+    SDL_free(names[count]);
+    SDL_free(names);
+}
+
+int main(int argc, char* argv[]) {
+    if (!benchParseArguments(argc, argv)) {
+        fprintf(stderr, "Usage: %s [--count N] [--size BYTES] [--large BYTES] [--iterations N] [--data DIR] [--format text|json|csv] [--output FILE]\n"
+            "       %s --naive ARCHIVE --packed ARCHIVE --manifest FILE [--iterations N] [--format text|json|csv] [--output FILE]\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    BENCH_CHECK(SDL_Init(0));
+    samples = (Uint64*)SDL_malloc(sizeof(Uint64) * (size_t)config.iterations);
+    BENCH_CHECK(samples != NULL);
+
+    if (config.packedArchive != NULL) {
+        benchCompareArchives(argv[0]);
+    }
+    else {
+        benchSuite(argv[0]);
+    }
+    SDL_free(samples);
+
+#ifdef SDL_PHYSFS_POOL_ALLOCATOR
+    const char* allocator = "pool";
+#else
+    const char* allocator = "sdl";
+#endif
+    FILE* out = config.output != NULL ? fopen(config.output, "w") : stdout;
+    BENCH_CHECK(out != NULL);
+    benchWriteResults(out, allocator);
+    if (out != stdout) {
+        fclose(out);
+    }
+
+    SDL_Quit();
+
+    return 0;
+}
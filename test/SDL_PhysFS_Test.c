@@ -11,6 +11,137 @@ static SDL_EnumerationResult SDLCALL enumerateCounter(void* userdata, const char
     return SDL_ENUM_CONTINUE;
 }
 
+static SDL_EnumerationResult SDLCALL enumerateFirst(void* userdata, const char* dirname, const char* fname) {
+    (void)dirname;
+    (void)fname;
+    (*(int*)userdata)++;
+    return SDL_ENUM_SUCCESS;
+}
+
+static SDL_EnumerationResult SDLCALL walkCounter(void* userdata, const char* path, const SDL_PathInfo* info) {
+    (void)path;
+    SDL_assert(info->type == SDL_PATHTYPE_FILE);
+    SDL_assert(info->size > 0);
+    SDL_AddAtomicInt((SDL_AtomicInt*)userdata, 1);
+    return SDL_ENUM_CONTINUE;
+}
+
+static void SDLCALL traceCounter(void* userdata, SDL_PhysFS_TraceEvent event, const char* filename, Uint64 timestampNS, Uint64 durationNS, Sint64 bytes) {
+    (void)timestampNS;
+    (void)durationNS;
+    (void)bytes;
+    SDL_assert(filename != NULL);
+    ((int*)userdata)[event]++;
+}
+
+static int SDLCALL parallelLoader(void* data) {
+    int loaded = 0;
+    for (int i = 0; i < 100; i++) {
+        size_t size;
+        char* text = (char*)SDL_PhysFS_LoadFile((const char*)data, &size);
+        if (text != NULL && size >= 12 && memcmp(text, "Hello, World", 12) == 0) {
+            loaded++;
+        }
+        SDL_free(text);
+    }
+    return loaded;
+}
+
+static const char* contentBlobs[] = { "Hello", "World" };
+
+/**
+ * Writes a content hash, or a pack identity, whose first byte is the given value and the rest zeros.
+ */
+static void writeContentHash(SDL_IOStream* io, Uint8 value) {
+    Uint8 hash[SDL_PHYSFS_CONTENT_PACK_HASH_SIZE] = { 0 };
+    hash[0] = value;
+    SDL_assert(SDL_WriteIO(io, hash, sizeof(hash)) == sizeof(hash));
+}
+
+/**
+ * Writes a content pack storing a run of contentBlobs, with each name pointing at one of contentBlobs. Blob i's hash is i + 1.
+ *
+ * The pack's identity is id, and a non-zero baseId makes it a delta pack of the pack with that identity.
+ */
+static size_t writeContentPack(Uint8* buffer, size_t capacity, Uint8 id, Uint8 baseId, int firstBlob, int numBlobs, const char** names, const int* blobs, int numNames) {
+    SDL_IOStream* io = SDL_IOFromMem(buffer, capacity);
+    SDL_assert(io != NULL);
+    SDL_assert(SDL_SeekIO(io, SDL_PHYSFS_CONTENT_PACK_HEADER_SIZE, SDL_IO_SEEK_SET) == SDL_PHYSFS_CONTENT_PACK_HEADER_SIZE);
+    Uint64 offsets[SDL_arraysize(contentBlobs)];
+    for (int i = 0; i < numBlobs; i++) {
+        const char* data = contentBlobs[firstBlob + i];
+        offsets[i] = (Uint64)SDL_TellIO(io);
+        SDL_assert(SDL_WriteIO(io, data, SDL_strlen(data)) == SDL_strlen(data));
+    }
+
+    Uint64 indexOffset = (Uint64)SDL_TellIO(io);
+    if (baseId != 0) {
+        writeContentHash(io, baseId);
+    }
+    for (int i = 0; i < numBlobs; i++) {
+        writeContentHash(io, (Uint8)(firstBlob + i + 1));
+        SDL_assert(SDL_WriteU64LE(io, offsets[i]));
+        SDL_assert(SDL_WriteU64LE(io, SDL_strlen(contentBlobs[firstBlob + i])));
+    }
+    Uint32 nameOffset = 0;
+    for (int i = 0; i < numNames; i++) {
+        Uint32 nameLength = (Uint32)SDL_strlen(names[i]);
+        writeContentHash(io, (Uint8)(blobs[i] + 1));
+        SDL_assert(SDL_WriteU64LE(io, SDL_strlen(contentBlobs[blobs[i]])));
+        SDL_assert(SDL_WriteU32LE(io, nameOffset));
+        SDL_assert(SDL_WriteU32LE(io, nameLength));
+        nameOffset += nameLength + 1;
+    }
+    for (int i = 0; i < numNames; i++) {
+        SDL_assert(SDL_WriteIO(io, names[i], SDL_strlen(names[i]) + 1) == SDL_strlen(names[i]) + 1);
+    }
+    size_t size = (size_t)SDL_TellIO(io);
+
+    SDL_assert(SDL_SeekIO(io, 0, SDL_IO_SEEK_SET) == 0);
+    SDL_assert(SDL_WriteIO(io, SDL_PHYSFS_CONTENT_PACK_MAGIC, 8) == 8);
+    SDL_assert(SDL_WriteU32LE(io, SDL_PHYSFS_CONTENT_PACK_VERSION));
+    SDL_assert(SDL_WriteU32LE(io, (Uint32)numBlobs));
+    SDL_assert(SDL_WriteU32LE(io, (Uint32)numNames));
+    SDL_assert(SDL_WriteU32LE(io, nameOffset));
+    SDL_assert(SDL_WriteU64LE(io, indexOffset));
+    SDL_assert(SDL_WriteU32LE(io, baseId != 0 ? 1 : 0));
+    SDL_assert(SDL_WriteU32LE(io, 0));
+    writeContentHash(io, id);
+    SDL_CloseIO(io);
+    return size;
+}
+
+/**
+ * Writes a zip archive holding one stored file.
+ */
+static size_t writeStoredZip(Uint8* buffer, size_t capacity, const char* name, const char* data) {
+    SDL_IOStream* io = SDL_IOFromMem(buffer, capacity);
+    SDL_assert(io != NULL);
+    Uint16 nameLength = (Uint16)SDL_strlen(name);
+    Uint32 size = (Uint32)SDL_strlen(data);
+    Uint32 crc = SDL_crc32(0, data, size);
+    SDL_assert(SDL_WriteU32LE(io, 0x04034b50) && SDL_WriteU16LE(io, 10) && SDL_WriteU16LE(io, 0) && SDL_WriteU16LE(io, 0));
+    SDL_assert(SDL_WriteU16LE(io, 0) && SDL_WriteU16LE(io, 0x21) && SDL_WriteU32LE(io, crc));
+    SDL_assert(SDL_WriteU32LE(io, size) && SDL_WriteU32LE(io, size) && SDL_WriteU16LE(io, nameLength) && SDL_WriteU16LE(io, 0));
+    SDL_assert(SDL_WriteIO(io, name, nameLength) == nameLength && SDL_WriteIO(io, data, size) == size);
+
+    Uint32 directoryOffset = (Uint32)SDL_TellIO(io);
+    SDL_assert(SDL_WriteU32LE(io, 0x02014b50) && SDL_WriteU16LE(io, 20) && SDL_WriteU16LE(io, 10) && SDL_WriteU16LE(io, 0));
+    SDL_assert(SDL_WriteU16LE(io, 0) && SDL_WriteU16LE(io, 0) && SDL_WriteU16LE(io, 0x21) && SDL_WriteU32LE(io, crc));
+    SDL_assert(SDL_WriteU32LE(io, size) && SDL_WriteU32LE(io, size) && SDL_WriteU16LE(io, nameLength));
+    SDL_assert(SDL_WriteU16LE(io, 0) && SDL_WriteU16LE(io, 0) && SDL_WriteU16LE(io, 0) && SDL_WriteU16LE(io, 0));
+    SDL_assert(SDL_WriteU32LE(io, 0) && SDL_WriteU32LE(io, 0));
+    SDL_assert(SDL_WriteIO(io, name, nameLength) == nameLength);
+    Uint32 directorySize = (Uint32)SDL_TellIO(io) - directoryOffset;
+
+    SDL_assert(SDL_WriteU32LE(io, 0x06054b50) && SDL_WriteU16LE(io, 0) && SDL_WriteU16LE(io, 0));
+    SDL_assert(SDL_WriteU16LE(io, 1) && SDL_WriteU16LE(io, 1) && SDL_WriteU32LE(io, directorySize));
+    SDL_assert(SDL_WriteU32LE(io, directoryOffset) && SDL_WriteU16LE(io, 0));
+    size_t written = (size_t)SDL_TellIO(io);
+    SDL_CloseIO(io);
+    return written;
+}
+
 int main(int argc, char* argv[]) {
     (void)argc;
 
@@ -44,6 +175,81 @@ int main(int argc, char* argv[]) {
         SDL_DestroySurface(bmp);
     }
 
+    // SDL_PhysFS_LoadSurfaceFormat
+    {
+        SDL_Surface* bmp = SDL_PhysFS_LoadBMP("res/test.bmp");
+        SDL_assert(bmp != NULL);
+        SDL_PixelFormat formats[] = { SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGB24, SDL_PIXELFORMAT_BGR24 };
+        for (size_t i = 0; i < SDL_arraysize(formats); i++) {
+            SDL_Surface* expected = SDL_ConvertSurface(bmp, formats[i]);
+            SDL_Surface* surface = SDL_PhysFS_LoadSurfaceFormat("res/test.bmp", formats[i]);
+            SDL_assert(expected != NULL && surface != NULL);
+            SDL_assert(surface->format == formats[i]);
+            SDL_assert(surface->w == 250 && surface->h == 239);
+            for (int y = 0; y < surface->h; y++) {
+                SDL_assert(memcmp((Uint8*)surface->pixels + y * surface->pitch, (Uint8*)expected->pixels + y * expected->pitch, (size_t)(surface->w * SDL_BYTESPERPIXEL(formats[i]))) == 0);
+            }
+
+            // The surface keeps the attributes SDL_ConvertSurface() would have given it.
+            SDL_BlendMode expectedBlendMode, blendMode;
+            SDL_assert(SDL_GetSurfaceBlendMode(expected, &expectedBlendMode) && SDL_GetSurfaceBlendMode(surface, &blendMode));
+            SDL_assert(blendMode == expectedBlendMode);
+            SDL_assert(SDL_GetSurfaceColorspace(surface) == SDL_GetSurfaceColorspace(expected));
+            SDL_DestroySurface(expected);
+            SDL_DestroySurface(surface);
+        }
+        SDL_DestroySurface(bmp);
+        SDL_assert(SDL_PhysFS_LoadSurfaceFormat("res/notfound.bmp", SDL_PIXELFORMAT_ARGB8888) == NULL);
+    }
+
+    // SDL_PhysFS_LoadSurfacesFormat
+    {
+        const char* names[] = { "res/test.bmp", "res/notfound.bmp", "res/test.bmp" };
+        SDL_Surface* surfaces[3];
+        SDL_assert(SDL_PhysFS_LoadSurfacesFormat(names, 3, SDL_PIXELFORMAT_ARGB8888, surfaces) == false);
+        SDL_assert(surfaces[0] != NULL && surfaces[0]->format == SDL_PIXELFORMAT_ARGB8888);
+        SDL_assert(surfaces[1] == NULL);
+        SDL_assert(surfaces[2] != NULL && surfaces[2]->w == 250);
+        SDL_DestroySurface(surfaces[0]);
+        SDL_DestroySurface(surfaces[2]);
+        SDL_assert(SDL_PhysFS_LoadSurfacesFormat(names, 1, SDL_PIXELFORMAT_ARGB8888, surfaces));
+        SDL_DestroySurface(surfaces[0]);
+    }
+
+    // SDL_PhysFS_LoadTexture with the software renderer
+    {
+        SDL_Surface* target = SDL_CreateSurface(64, 64, SDL_PIXELFORMAT_ARGB8888);
+        SDL_assert(target != NULL);
+        SDL_Renderer* renderer = SDL_CreateSoftwareRenderer(target);
+        SDL_assert(renderer != NULL);
+        float w, h;
+        SDL_Texture* texture = SDL_PhysFS_LoadTexture(renderer, "res/test.bmp");
+        SDL_assert(texture != NULL);
+        SDL_assert(SDL_GetTextureSize(texture, &w, &h));
+        SDL_assert(w == 250.0f && h == 239.0f);
+        SDL_Surface* bmp = SDL_PhysFS_LoadBMP("res/test.bmp");
+        SDL_BlendMode surfaceBlendMode, textureBlendMode;
+        SDL_assert(bmp != NULL && SDL_GetSurfaceBlendMode(bmp, &surfaceBlendMode));
+        SDL_assert(SDL_GetTextureBlendMode(texture, &textureBlendMode) && textureBlendMode == surfaceBlendMode);
+        SDL_DestroySurface(bmp);
+        SDL_DestroyTexture(texture);
+        SDL_assert(SDL_PhysFS_LoadTexture(renderer, "res/notfound.bmp") == NULL);
+        SDL_assert(SDL_PhysFS_LoadTexture(NULL, "res/test.bmp") == NULL);
+
+        // SDL_PhysFS_LoadTextures
+        const char* names[] = { "res/test.bmp", "res/notfound.bmp", "res/test.bmp" };
+        SDL_Texture* textures[3];
+        SDL_assert(SDL_PhysFS_LoadTextures(renderer, names, 3, textures) == false);
+        SDL_assert(textures[0] != NULL && textures[1] == NULL && textures[2] != NULL);
+        SDL_assert(SDL_GetTextureSize(textures[2], &w, &h));
+        SDL_assert(w == 250.0f && h == 239.0f);
+        SDL_DestroyTexture(textures[0]);
+        SDL_DestroyTexture(textures[2]);
+
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroySurface(target);
+    }
+
     // SDL_PhysFS_LoadFile
     {
         size_t size;
@@ -61,6 +267,128 @@ int main(int argc, char* argv[]) {
         SDL_free(data);
     }
 
+    // SDL_PhysFS_TryOpen, SDL_PhysFS_TryLoadFile
+    {
+        SDL_SetError("untouched");
+        SDL_IOStream* io = (SDL_IOStream*)&io;
+        SDL_assert(SDL_PhysFS_TryOpen("res/notfound.txt", &io) == PHYSFS_ERR_NOT_FOUND);
+        SDL_assert(io == NULL);
+        void* data = &data;
+        size_t size = 1;
+        SDL_assert(SDL_PhysFS_TryLoadFile("res/notfound.txt", &data, &size) == PHYSFS_ERR_NOT_FOUND);
+        SDL_assert(data == NULL && size == 0);
+        SDL_assert(SDL_strcmp(SDL_GetError(), "untouched") == 0);
+
+        SDL_assert(SDL_PhysFS_TryOpen("res/test.txt", &io) == PHYSFS_ERR_OK);
+        SDL_assert(io != NULL);
+        SDL_CloseIO(io);
+        SDL_assert(SDL_PhysFS_TryLoadFile("res/test.txt", &data, &size) == PHYSFS_ERR_OK);
+        SDL_assert(data != NULL && size >= 12);
+        SDL_assert(memcmp(data, "Hello, World", 12) == 0);
+        SDL_free(data);
+        SDL_assert(SDL_PhysFS_TryLoadFile(NULL, &data, NULL) == PHYSFS_ERR_INVALID_ARGUMENT);
+
+        // Errors are reported as usual once the probe is done.
+        SDL_assert(SDL_PhysFS_LoadFile("res/notfound.txt", NULL) == NULL);
+        SDL_assert(SDL_strcmp(SDL_GetError(), "untouched") != 0);
+    }
+
+    // SDL_PhysFS_LoadFiles
+    {
+        SDL_assert(SDL_PhysFS_Mount("resources/test.zip", "zipbatch"));
+        const char* names[] = { "res/test.bmp", "zipbatch/test.txt", "res/notfound.txt", "res/test.txt" };
+        void* buffers[4];
+        size_t sizes[4];
+        void* block = SDL_PhysFS_LoadFiles(names, 4, buffers, sizes);
+        SDL_assert(block != NULL);
+        SDL_assert(buffers[0] != NULL && sizes[0] == 179866);
+        SDL_assert(buffers[1] != NULL && sizes[1] == 13);
+        SDL_assert(memcmp(buffers[1], "Hello, World", 12) == 0);
+        SDL_assert(buffers[2] == NULL && sizes[2] == 0);
+        SDL_assert(buffers[3] != NULL && memcmp(buffers[3], "Hello, World", 12) == 0);
+        SDL_free(block);
+
+        // The archive's index is kept for the next batch.
+        const char* zipNames[] = { "zipbatch/notfound.txt", "zipbatch/test.txt" };
+        block = SDL_PhysFS_LoadFiles(zipNames, 2, buffers, sizes);
+        SDL_assert(block != NULL);
+        SDL_assert(buffers[0] == NULL && sizes[0] == 0);
+        SDL_assert(buffers[1] != NULL && sizes[1] == 13 && memcmp(buffers[1], "Hello, World", 12) == 0);
+        SDL_free(block);
+
+        // Batches go through the content cache, and are recorded like single loads.
+        SDL_PhysFS_SetContentCacheSize(1024 * 1024);
+        SDL_PhysFS_StartAccessRecording();
+        const char* cachedNames[] = { "zipbatch/test.txt", "res/test.txt" };
+        for (int pass = 0; pass < 2; pass++) {
+            block = SDL_PhysFS_LoadFiles(cachedNames, 2, buffers, sizes);
+            SDL_assert(block != NULL);
+            SDL_assert(buffers[0] != NULL && sizes[0] == 13 && memcmp(buffers[0], "Hello, World", 12) == 0);
+            SDL_assert(buffers[1] != NULL && memcmp(buffers[1], "Hello, World", 12) == 0);
+            SDL_free(block);
+        }
+        SDL_assert(SDL_PhysFS_StopAccessRecording("batch.manifest"));
+        char* manifest = (char*)SDL_PhysFS_LoadFile("pref/batch.manifest", NULL);
+        SDL_assert(manifest != NULL);
+        SDL_assert(SDL_strcmp(manifest, "zipbatch/test.txt\nres/test.txt\n") == 0);
+        SDL_free(manifest);
+#ifdef SDL_PHYSFS_STATS
+        SDL_PhysFS_Stats* stats = SDL_PhysFS_GetStats();
+        SDL_assert(stats != NULL);
+        bool hit = false;
+        for (int i = 0; i < stats->numFiles; i++) {
+            if (SDL_strcmp(stats->files[i].name, "zipbatch/test.txt") == 0) {
+                hit = stats->files[i].counters.contentCacheHits == 1;
+            }
+        }
+        SDL_assert(hit);
+        SDL_free(stats);
+#endif
+        SDL_PhysFS_SetContentCacheSize(0);
+        SDL_assert(SDL_PhysFS_Unmount("resources/test.zip"));
+    }
+
+    // SDL_PhysFS_MapFile
+    {
+        size_t size;
+        const char* text = (const char*)SDL_PhysFS_MapFile("res/test.txt", &size);
+        SDL_assert(text != NULL);
+        SDL_assert(size >= 12);
+        SDL_assert(memcmp(text, "Hello, World", 12) == 0);
+        SDL_PhysFS_UnmapFile(text);
+
+        SDL_assert(SDL_PhysFS_Mount("resources/test.zip", "zipmap"));
+        text = (const char*)SDL_PhysFS_MapFile("zipmap/test.txt", &size);
+        SDL_assert(text != NULL);
+        SDL_assert(size == 13);
+        SDL_assert(memcmp(text, "Hello, World", 12) == 0);
+        SDL_PhysFS_UnmapFile(text);
+
+        // The second map finds the entry in the archive's index.
+        text = (const char*)SDL_PhysFS_MapFile("zipmap/test.txt", &size);
+        SDL_assert(text != NULL && size == 13);
+        SDL_assert(memcmp(text, "Hello, World", 12) == 0);
+        SDL_PhysFS_UnmapFile(text);
+        SDL_assert(SDL_PhysFS_Unmount("resources/test.zip"));
+
+        // An entry without a valid local header isn't mapped.
+        Uint8 badZip[256];
+        size_t badSize = writeStoredZip(badZip, sizeof(badZip), "bad.txt", "Hello, World");
+        badZip[0] = 0;
+        char* prefPath = SDL_GetPrefPath("SDL_PhysFS", "Test");
+        char* badPath = NULL;
+        SDL_assert(SDL_asprintf(&badPath, "%sbadheader.zip", prefPath) > 0);
+        SDL_assert(SDL_SaveFile(badPath, badZip, badSize));
+        SDL_assert(SDL_PhysFS_Mount(badPath, "zipbad"));
+        SDL_assert(SDL_PhysFS_MapFile("zipbad/bad.txt", &size) == NULL);
+        SDL_assert(SDL_PhysFS_Unmount(badPath));
+        SDL_free(badPath);
+        SDL_free(prefPath);
+
+        SDL_assert(SDL_PhysFS_MapFile("res/notfound.txt", &size) == NULL);
+        SDL_assert(size == 0);
+    }
+
     // SDL_PhysFS_LoadWAV
     {
         SDL_AudioSpec wavSpec;
@@ -73,6 +401,130 @@ int main(int argc, char* argv[]) {
         SDL_free(wavBuffer);
     }
 
+    // SDL_PhysFS_OpenAudioStream
+    {
+        SDL_AudioSpec wavSpec;
+        Uint32 wavLength;
+        Uint8* wavBuffer;
+        SDL_assert(SDL_PhysFS_LoadWAV("res/test.wav", &wavSpec, &wavBuffer, &wavLength));
+
+        // Streamed in the file's format, the data matches SDL_PhysFS_LoadWAV().
+        SDL_AudioStream* stream = SDL_PhysFS_OpenAudioStream("res/test.wav", NULL);
+        SDL_assert(stream != NULL);
+        Uint8* streamed = (Uint8*)SDL_malloc(wavLength + 4096);
+        SDL_assert(streamed != NULL);
+        Uint32 total = 0;
+        int got;
+        while ((got = SDL_GetAudioStreamData(stream, streamed + total, (int)SDL_min(4096, wavLength + 4096 - total))) > 0) {
+            total += (Uint32)got;
+        }
+        SDL_assert(got == 0);
+        SDL_assert(total == wavLength);
+        SDL_assert(memcmp(streamed, wavBuffer, wavLength) == 0);
+        SDL_DestroyAudioStream(stream);
+        SDL_free(streamed);
+        SDL_free(wavBuffer);
+
+        // Converted
+        SDL_AudioSpec mono = { SDL_AUDIO_F32, 1, 22050 };
+        stream = SDL_PhysFS_OpenAudioStream("res/test.wav", &mono);
+        SDL_assert(stream != NULL);
+        float samples[1024];
+        total = 0;
+        while ((got = SDL_GetAudioStreamData(stream, samples, sizeof(samples))) > 0) {
+            total += (Uint32)got;
+        }
+        SDL_assert(total > 0 && total % sizeof(float) == 0);
+        SDL_DestroyAudioStream(stream);
+
+        // Played through the dummy audio driver
+        SDL_SetHint(SDL_HINT_AUDIO_DRIVER, "dummy");
+        SDL_assert(SDL_InitSubSystem(SDL_INIT_AUDIO));
+        SDL_AudioDeviceID device = SDL_OpenAudioDevice(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, NULL);
+        SDL_assert(device != 0);
+        stream = SDL_PhysFS_OpenAudioStream("res/test.wav", NULL);
+        SDL_assert(stream != NULL);
+        SDL_assert(SDL_BindAudioStream(device, stream));
+        SDL_Delay(100);
+        SDL_DestroyAudioStream(stream);
+        SDL_CloseAudioDevice(device);
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+
+        // An odd-sized data chunk, padded and followed by another chunk, stops at its last whole frame.
+        Uint8 odd[80];
+        Uint8 oddData[23];
+        for (int i = 0; i < (int)sizeof(oddData); i++) {
+            oddData[i] = (Uint8)(i + 1);
+        }
+        SDL_IOStream* wav = SDL_IOFromMem(odd, sizeof(odd));
+        SDL_assert(wav != NULL);
+        SDL_assert(SDL_WriteU32LE(wav, 0x46464952) && SDL_WriteU32LE(wav, 0) && SDL_WriteU32LE(wav, 0x45564157));
+        SDL_assert(SDL_WriteU32LE(wav, 0x20746D66) && SDL_WriteU32LE(wav, 16));
+        SDL_assert(SDL_WriteU16LE(wav, 1) && SDL_WriteU16LE(wav, 2) && SDL_WriteU32LE(wav, 22050));
+        SDL_assert(SDL_WriteU32LE(wav, 22050 * 4) && SDL_WriteU16LE(wav, 4) && SDL_WriteU16LE(wav, 16));
+        SDL_assert(SDL_WriteU32LE(wav, 0x61746164) && SDL_WriteU32LE(wav, sizeof(oddData)));
+        SDL_assert(SDL_WriteIO(wav, oddData, sizeof(oddData)) == sizeof(oddData) && SDL_WriteU8(wav, 0));
+        SDL_assert(SDL_WriteU32LE(wav, 0x5453494C) && SDL_WriteU32LE(wav, 8));
+        SDL_assert(SDL_WriteU32LE(wav, 0x7F7F7F7F) && SDL_WriteU32LE(wav, 0x7F7F7F7F));
+        size_t oddSize = (size_t)SDL_TellIO(wav);
+        SDL_assert(SDL_SeekIO(wav, 4, SDL_IO_SEEK_SET) == 4 && SDL_WriteU32LE(wav, (Uint32)oddSize - 8));
+        SDL_CloseIO(wav);
+        SDL_assert(SDL_PhysFS_WriteFile("odd.wav", odd, oddSize) == oddSize);
+        stream = SDL_PhysFS_OpenAudioStream("pref/odd.wav", NULL);
+        SDL_assert(stream != NULL);
+        Uint8 oddStreamed[64];
+        total = 0;
+        while ((got = SDL_GetAudioStreamData(stream, oddStreamed + total, (int)(sizeof(oddStreamed) - total))) > 0) {
+            total += (Uint32)got;
+        }
+        SDL_assert(got == 0);
+        SDL_assert(total == 20);
+        SDL_assert(memcmp(oddStreamed, oddData, 20) == 0);
+        SDL_DestroyAudioStream(stream);
+
+        SDL_assert(SDL_PhysFS_OpenAudioStream("res/test.txt", NULL) == NULL);
+        SDL_assert(SDL_PhysFS_OpenAudioStream("res/notfound.wav", NULL) == NULL);
+    }
+
+    // SDL_PhysFS_LoadFileAsync
+    {
+        SDL_PhysFS_AsyncQueue* queue = SDL_PhysFS_CreateAsyncQueue(2);
+        SDL_assert(queue != NULL);
+        SDL_PhysFS_AsyncTask* textTask = SDL_PhysFS_LoadFileAsync("res/test.txt", queue, NULL);
+        SDL_assert(textTask != NULL);
+        SDL_assert(SDL_PhysFS_LoadSurfaceAsync("res/test.bmp", queue, NULL) != NULL);
+        SDL_assert(SDL_PhysFS_LoadWAVAsync("res/test.wav", queue, NULL) != NULL);
+        SDL_assert(SDL_PhysFS_LoadFileAsync("res/notfound.txt", queue, NULL) != NULL);
+
+        SDL_PhysFS_AsyncOutcome outcome;
+        SDL_assert(SDL_PhysFS_WaitAsyncTask(textTask, &outcome));
+        SDL_assert(outcome.success);
+        SDL_assert(outcome.type == SDL_PHYSFS_ASYNC_LOADFILE);
+        SDL_assert(memcmp(outcome.data, "Hello, World", 12) == 0);
+        SDL_free(outcome.data);
+
+        int failures = 0;
+        for (int i = 0; i < 3; i++) {
+            SDL_assert(SDL_PhysFS_WaitAsyncResult(queue, &outcome, -1));
+            if (!outcome.success) {
+                failures++;
+                continue;
+            }
+            if (outcome.type == SDL_PHYSFS_ASYNC_LOADSURFACE) {
+                SDL_assert(outcome.surface->w == 250);
+                SDL_DestroySurface(outcome.surface);
+            }
+            else {
+                SDL_assert(outcome.type == SDL_PHYSFS_ASYNC_LOADWAV);
+                SDL_assert(outcome.size > 200);
+                SDL_free(outcome.data);
+            }
+        }
+        SDL_assert(failures == 1);
+        SDL_assert(!SDL_PhysFS_GetAsyncResult(queue, &outcome));
+        SDL_PhysFS_DestroyAsyncQueue(queue);
+    }
+
     // SDL_PhysFS_IOFromFile
     {
         SDL_IOStream* io = SDL_PhysFS_IOFromFile("res/test.txt");
@@ -81,6 +533,79 @@ int main(int argc, char* argv[]) {
         SDL_CloseIO(io);
     }
 
+    // SDL_PhysFS_IOFromFileEx
+    {
+        SDL_IOStream* io = SDL_PhysFS_IOFromFileEx("res/test.txt", 4);
+        SDL_assert(io != NULL);
+        char text[12];
+        for (size_t i = 0; i < sizeof(text); i++) {
+            SDL_assert(SDL_ReadIO(io, &text[i], 1) == 1);
+        }
+        SDL_assert(memcmp(text, "Hello, World", 12) == 0);
+        SDL_assert(SDL_SeekIO(io, 7, SDL_IO_SEEK_SET) == 7);
+        SDL_assert(SDL_ReadIO(io, text, 5) == 5);
+        SDL_assert(memcmp(text, "World", 5) == 0);
+        SDL_CloseIO(io);
+    }
+
+    // SDL_PhysFS_SeekIO
+    {
+        SDL_IOStream* io = SDL_PhysFS_IOFromFile("res/test.bmp");
+        SDL_assert(io != NULL);
+        SDL_assert(SDL_GetIOSize(io) == 179866);
+        SDL_assert(SDL_TellIO(io) == 0);
+        char header[2];
+        SDL_assert(SDL_ReadIO(io, header, sizeof(header)) == sizeof(header));
+        SDL_assert(header[0] == 'B' && header[1] == 'M');
+        SDL_assert(SDL_SeekIO(io, 100, SDL_IO_SEEK_CUR) == 102);
+        SDL_assert(SDL_TellIO(io) == 102);
+        SDL_assert(SDL_SeekIO(io, -10, SDL_IO_SEEK_END) == 179856);
+        char tail[10];
+        SDL_assert(SDL_ReadIO(io, tail, sizeof(tail)) == sizeof(tail));
+        SDL_assert(SDL_ReadIO(io, tail, 1) == 0);
+        SDL_assert(SDL_TellIO(io) == 179866);
+        SDL_assert(SDL_SeekIO(io, 0, SDL_IO_SEEK_SET) == 0);
+        SDL_assert(SDL_ReadIO(io, header, sizeof(header)) == sizeof(header));
+        SDL_assert(header[0] == 'B' && header[1] == 'M');
+        SDL_CloseIO(io);
+    }
+
+    // SDL_PhysFS_SetIORewindSize
+    {
+        SDL_IOStream* io = SDL_PhysFS_IOFromFile("res/test.bmp");
+        SDL_assert(io != NULL);
+        SDL_assert(SDL_PhysFS_SetIORewindSize(io, 64));
+        char first[100];
+        char again[100];
+        SDL_assert(SDL_ReadIO(io, first, sizeof(first)) == sizeof(first));
+        SDL_assert(SDL_SeekIO(io, -50, SDL_IO_SEEK_CUR) == 50);
+        SDL_assert(SDL_ReadIO(io, again, 20) == 20);
+        SDL_assert(memcmp(again, first + 50, 20) == 0);
+        SDL_assert(SDL_ReadIO(io, again, 60) == 60);
+        SDL_assert(memcmp(again, first + 70, 30) == 0);
+        SDL_assert(SDL_TellIO(io) == 130);
+        SDL_assert(SDL_SeekIO(io, 0, SDL_IO_SEEK_SET) == 0);
+        SDL_assert(SDL_ReadIO(io, again, 2) == 2);
+        SDL_assert(again[0] == 'B' && again[1] == 'M');
+        SDL_assert(SDL_PhysFS_SetIORewindSize(io, 0));
+        SDL_CloseIO(io);
+        SDL_assert(SDL_PhysFS_SetIORewindSize(NULL, 64) == false);
+    }
+
+    // SDL_PhysFS_OpenIO
+    {
+        SDL_IOStream* io = SDL_PhysFS_OpenIO(PHYSFS_openWrite("openio.txt"));
+        SDL_assert(io != NULL);
+        SDL_assert(SDL_WriteIO(io, "Hello", 5) == 5);
+        SDL_assert(SDL_TellIO(io) == 5);
+        SDL_assert(SDL_GetIOSize(io) == 5);
+        SDL_assert(SDL_WriteIO(io, ", World", 7) == 7);
+        SDL_assert(SDL_TellIO(io) == 12);
+        SDL_assert(SDL_GetIOSize(io) == 12);
+        SDL_assert(SDL_CloseIO(io));
+        SDL_PhysFS_ClearPathCache();
+    }
+
     // SDL_PhysFS_WriteFile and read-back
     SDL_assert(SDL_PhysFS_WriteFile("test.txt", "Hello World!", 12) == 12);
     {
@@ -92,6 +617,259 @@ int main(int argc, char* argv[]) {
         SDL_free((void*)data);
     }
 
+    // SDL_PhysFS_WriteFileAtomic
+    {
+        SDL_assert(SDL_PhysFS_WriteFileAtomic("atomic.txt", "first", 5) == 5);
+        SDL_assert(SDL_PhysFS_WriteFileAtomic("atomic.txt", "second", 6) == 6);
+        size_t datasize;
+        char* data = (char*)SDL_PhysFS_LoadFile("pref/atomic.txt", &datasize);
+        SDL_assert(data != NULL);
+        SDL_assert(datasize == 6);
+        SDL_assert(memcmp(data, "second", 6) == 0);
+        SDL_free(data);
+
+        // No temporary files are left behind.
+        char** files = SDL_PhysFS_LoadDirectoryFiles("pref");
+        SDL_assert(files != NULL);
+        for (char** file = files; *file != NULL; file++) {
+            SDL_assert(SDL_strstr(*file, ".tmp") == NULL);
+        }
+        SDL_PhysFS_FreeDirectoryFiles(files);
+    }
+
+    // SDL_PhysFS_WriteFileAtomicAsync
+    {
+        SDL_PhysFS_AsyncQueue* queue = SDL_PhysFS_CreateAsyncQueue(1);
+        SDL_assert(queue != NULL);
+        char buffer[] = "async";
+        SDL_PhysFS_AsyncTask* task = SDL_PhysFS_WriteFileAtomicAsync("atomic.txt", buffer, 5, queue, NULL);
+        SDL_assert(task != NULL);
+        buffer[0] = 'X';
+        SDL_PhysFS_AsyncOutcome outcome;
+        SDL_assert(SDL_PhysFS_WaitAsyncTask(task, &outcome));
+        SDL_assert(outcome.success);
+        SDL_assert(outcome.type == SDL_PHYSFS_ASYNC_WRITEFILE);
+        SDL_assert(outcome.size == 5);
+        SDL_assert(outcome.data == NULL);
+        SDL_PhysFS_DestroyAsyncQueue(queue);
+
+        size_t datasize;
+        char* data = (char*)SDL_PhysFS_LoadFile("pref/atomic.txt", &datasize);
+        SDL_assert(data != NULL);
+        SDL_assert(datasize == 5);
+        SDL_assert(memcmp(data, "async", 5) == 0);
+        SDL_free(data);
+    }
+
+    // Content packs
+    {
+        static Uint8 base[512];
+        static Uint8 delta[512];
+        const char* baseNames[] = { "a.txt", "dir/b.txt" };
+        const int baseBlobs[] = { 0, 0 };
+        const char* deltaNames[] = { "dir/c.txt", "new.txt" };
+        const int deltaBlobs[] = { 0, 1 };
+        size_t baseSize = writeContentPack(base, sizeof(base), 1, 0, 0, 1, baseNames, baseBlobs, 2);
+        size_t deltaSize = writeContentPack(delta, sizeof(delta), 2, 1, 1, 1, deltaNames, deltaBlobs, 2);
+        SDL_assert(SDL_PhysFS_MountFromMemory(base, baseSize, "base.cas", "cas"));
+        SDL_assert(SDL_PhysFS_MountFromMemory(delta, deltaSize, "delta.cas", "casdelta"));
+
+        // Both paths read the one blob.
+        size_t size;
+        char* text = (char*)SDL_PhysFS_LoadFile("cas/a.txt", &size);
+        SDL_assert(text != NULL && size == 5 && memcmp(text, "Hello", 5) == 0);
+        SDL_free(text);
+        text = (char*)SDL_PhysFS_LoadFile("cas/dir/b.txt", &size);
+        SDL_assert(text != NULL && size == 5 && memcmp(text, "Hello", 5) == 0);
+        SDL_free(text);
+        char** files = SDL_PhysFS_LoadDirectoryFiles("cas/dir");
+        SDL_assert(files != NULL && files[0] != NULL && SDL_strcmp(files[0], "b.txt") == 0 && files[1] == NULL);
+        SDL_PhysFS_FreeDirectoryFiles(files);
+        SDL_assert(SDL_PhysFS_LoadFile("cas/dir", NULL) == NULL);
+
+        // The delta pack finds the blob it doesn't have in the base, until the base is unmounted.
+        text = (char*)SDL_PhysFS_LoadFile("casdelta/dir/c.txt", &size);
+        SDL_assert(text != NULL && size == 5 && memcmp(text, "Hello", 5) == 0);
+        SDL_free(text);
+        text = (char*)SDL_PhysFS_LoadFile("casdelta/new.txt", &size);
+        SDL_assert(text != NULL && size == 5 && memcmp(text, "World", 5) == 0);
+        SDL_free(text);
+        SDL_assert(SDL_PhysFS_Unmount("base.cas"));
+        SDL_assert(SDL_PhysFS_LoadFile("casdelta/dir/c.txt", NULL) == NULL);
+
+        // Another pack with the same blob isn't the delta pack's base, so it isn't searched.
+        static Uint8 other[512];
+        size_t otherSize = writeContentPack(other, sizeof(other), 3, 0, 0, 1, baseNames, baseBlobs, 2);
+        SDL_assert(SDL_PhysFS_MountFromMemory(other, otherSize, "other.cas", "casother"));
+        SDL_assert(PHYSFS_exists("casother/a.txt"));
+        SDL_assert(SDL_PhysFS_LoadFile("casdelta/dir/c.txt", NULL) == NULL);
+        SDL_assert(SDL_PhysFS_Unmount("other.cas"));
+        SDL_assert(SDL_PhysFS_Unmount("delta.cas"));
+
+        // Corrupt packs are refused.
+        base[24]++;
+        SDL_assert(!SDL_PhysFS_MountFromMemory(base, baseSize, "corrupt.cas", "cas"));
+    }
+
+    // SDL_PhysFS_WriteMountIndex
+    {
+        size_t zipSize;
+        Uint8* zipData = (Uint8*)SDL_LoadFile("resources/test.zip", &zipSize);
+        SDL_assert(zipData != NULL);
+        char* prefPath = SDL_GetPrefPath("SDL_PhysFS", "Test");
+        char* zipPath = NULL;
+        SDL_assert(SDL_asprintf(&zipPath, "%sindexed.zip", prefPath) > 0);
+        SDL_assert(SDL_SaveFile(zipPath, zipData, zipSize));
+        SDL_assert(SDL_PhysFS_WriteMountIndex("resources/test.txt") == false);
+        SDL_assert(SDL_PhysFS_WriteMountIndex(zipPath));
+
+        // Files mounted through the index have no modification time, unlike those from PhysFS's zip archiver.
+        PHYSFS_Stat stat;
+        SDL_assert(SDL_PhysFS_Mount(zipPath, "zipindex"));
+        SDL_assert(PHYSFS_stat("zipindex/test.txt", &stat) != 0);
+        SDL_assert(stat.modtime == -1 && stat.filesize == 13);
+        size_t size;
+        char* text = (char*)SDL_PhysFS_LoadFile("zipindex/test.txt", &size);
+        SDL_assert(text != NULL && size == 13 && memcmp(text, "Hello, World!", 13) == 0);
+        SDL_free(text);
+        char** files = SDL_PhysFS_LoadDirectoryFiles("zipindex");
+        SDL_assert(files != NULL && files[0] != NULL && SDL_strcmp(files[0], "test.txt") == 0 && files[1] == NULL);
+        SDL_PhysFS_FreeDirectoryFiles(files);
+        SDL_assert(SDL_PhysFS_Exists("zipindex/notfound.txt") == false);
+        SDL_assert(SDL_PhysFS_Unmount(zipPath));
+
+        // An index with a null byte inside a path is corrupt, and is ignored.
+        char* indexPath = NULL;
+        SDL_assert(SDL_asprintf(&indexPath, "%s.sdlidx", zipPath) > 0);
+        size_t indexSize;
+        Uint8* index = (Uint8*)SDL_LoadFile(indexPath, &indexSize);
+        SDL_assert(index != NULL);
+        bool patched = false;
+        for (size_t i = 0; i + 9 <= indexSize && !patched; i++) {
+            if (memcmp(index + i, "test.txt", 9) == 0) {
+                index[i + 2] = '\0';
+                patched = true;
+            }
+        }
+        SDL_assert(patched);
+        SDL_assert(SDL_SaveFile(indexPath, index, indexSize));
+        SDL_assert(SDL_PhysFS_Mount(zipPath, "zipindex"));
+        SDL_assert(PHYSFS_stat("zipindex/test.txt", &stat) != 0);
+        SDL_assert(stat.modtime != -1);
+        SDL_assert(SDL_PhysFS_Unmount(zipPath));
+        SDL_free(index);
+        SDL_free(indexPath);
+
+        // Once the archive changes, here by gaining a comment, the index is ignored.
+        Uint8* commented = (Uint8*)SDL_malloc(zipSize + 1);
+        SDL_assert(commented != NULL);
+        SDL_memcpy(commented, zipData, zipSize);
+        commented[zipSize - 2] = 1;
+        commented[zipSize] = '!';
+        SDL_assert(SDL_SaveFile(zipPath, commented, zipSize + 1));
+        SDL_assert(SDL_PhysFS_Mount(zipPath, "zipindex"));
+        SDL_assert(PHYSFS_stat("zipindex/test.txt", &stat) != 0);
+        SDL_assert(stat.modtime != -1);
+        SDL_assert(SDL_PhysFS_Unmount(zipPath));
+
+        // Long paths are indexed along with the rest.
+        static Uint8 longZip[2048];
+        char longName[601];
+        SDL_memset(longName, 'a', sizeof(longName) - 1);
+        longName[sizeof(longName) - 1] = '\0';
+        size_t longSize = writeStoredZip(longZip, sizeof(longZip), longName, "long");
+        SDL_free(zipPath);
+        SDL_assert(SDL_asprintf(&zipPath, "%slongname.zip", prefPath) > 0);
+        SDL_assert(SDL_SaveFile(zipPath, longZip, longSize));
+        SDL_assert(SDL_PhysFS_WriteMountIndex(zipPath));
+        SDL_assert(SDL_PhysFS_Mount(zipPath, "ziplong"));
+        char longPath[640];
+        SDL_snprintf(longPath, sizeof(longPath), "ziplong/%s", longName);
+        SDL_assert(PHYSFS_stat(longPath, &stat) != 0);
+        SDL_assert(stat.modtime == -1 && stat.filesize == 4);
+        SDL_assert(SDL_PhysFS_Unmount(zipPath));
+
+        SDL_free(commented);
+        SDL_free(zipData);
+        SDL_free(zipPath);
+        SDL_free(prefPath);
+    }
+
+    // SDL_PhysFS_OpenOverlayIO
+    {
+        // The write directory is mounted at "pref", which can't shadow anything, so use one of its own.
+        SDL_assert(SDL_PhysFS_OpenOverlayIO("res/test.txt") == NULL);
+        char* prefPath = SDL_GetPrefPath("SDL_PhysFS", "Test");
+        char* overlayPath = NULL;
+        SDL_assert(SDL_asprintf(&overlayPath, "%soverlay", prefPath) > 0);
+        SDL_assert(PHYSFS_mkdir("overlay"));
+        SDL_assert(SDL_PhysFS_SetWriteDir(overlayPath));
+        SDL_assert(SDL_PhysFS_Mount("resources/test.zip", "zipoverlay"));
+        SDL_assert(SDL_PhysFS_OpenOverlayIO("zipoverlay/notfound.txt") == NULL);
+
+        SDL_IOStream* io = SDL_PhysFS_OpenOverlayIO("zipoverlay/test.txt");
+        SDL_assert(io != NULL);
+        SDL_assert(SDL_GetIOSize(io) == 13);
+        SDL_assert(SDL_WriteIO(io, "Howdy", 5) == 5);
+        char buffer[16];
+        SDL_assert(SDL_SeekIO(io, 0, SDL_IO_SEEK_SET) == 0);
+        SDL_assert(SDL_ReadIO(io, buffer, sizeof(buffer)) == 13);
+        SDL_assert(memcmp(buffer, "Howdy, World", 12) == 0);
+
+        // Others see the original until the stream is closed.
+        char* text = (char*)SDL_PhysFS_LoadFile("zipoverlay/test.txt", NULL);
+        SDL_assert(text != NULL && memcmp(text, "Hello, World", 12) == 0);
+        SDL_free(text);
+        SDL_assert(SDL_CloseIO(io));
+        size_t size;
+        text = (char*)SDL_PhysFS_LoadFile("zipoverlay/test.txt", &size);
+        SDL_assert(text != NULL && size == 13 && memcmp(text, "Howdy, World", 12) == 0);
+        SDL_free(text);
+
+        // The overlay itself can be changed, and grown.
+        io = SDL_PhysFS_OpenOverlayIO("zipoverlay/test.txt");
+        SDL_assert(io != NULL);
+        SDL_assert(SDL_SeekIO(io, 0, SDL_IO_SEEK_END) == 13);
+        SDL_assert(SDL_WriteIO(io, "!!", 2) == 2);
+        SDL_assert(SDL_CloseIO(io));
+        text = (char*)SDL_PhysFS_LoadFile("zipoverlay/test.txt", &size);
+        SDL_assert(text != NULL && size == 15 && memcmp(text, "Howdy, World", 12) == 0 && memcmp(text + 13, "!!", 2) == 0);
+        SDL_free(text);
+
+        // A write directory mounted behind the archive can't shadow it.
+        SDL_assert(SDL_PhysFS_Unmount(overlayPath));
+        SDL_assert(SDL_PhysFS_Mount(overlayPath, NULL));
+        SDL_assert(SDL_PhysFS_OpenOverlayIO("zipoverlay/test.txt") == NULL);
+        SDL_assert(SDL_PhysFS_Unmount(overlayPath));
+
+        // Mounted in front, it's recognized with a trailing separator, and not mounted again.
+        char* slashedPath = NULL;
+        SDL_assert(SDL_asprintf(&slashedPath, "%s/", overlayPath) > 0);
+        SDL_assert(PHYSFS_mount(slashedPath, NULL, 0));
+        io = SDL_PhysFS_OpenOverlayIO("zipoverlay/test.txt");
+        SDL_assert(io != NULL);
+        SDL_assert(SDL_WriteIO(io, "J", 1) == 1);
+        SDL_assert(SDL_CloseIO(io));
+        char** searchPath = PHYSFS_getSearchPath();
+        SDL_assert(searchPath != NULL && searchPath[0] != NULL && SDL_strcmp(searchPath[0], slashedPath) == 0);
+        for (char** dir = searchPath; *dir != NULL; dir++) {
+            SDL_assert(SDL_strcmp(*dir, overlayPath) != 0);
+        }
+        PHYSFS_freeList(searchPath);
+        text = (char*)SDL_PhysFS_LoadFile("zipoverlay/test.txt", &size);
+        SDL_assert(text != NULL && size == 15 && memcmp(text, "Jowdy, World", 12) == 0);
+        SDL_free(text);
+        SDL_assert(PHYSFS_unmount(slashedPath));
+        SDL_free(slashedPath);
+
+        SDL_assert(PHYSFS_delete("zipoverlay/test.txt"));
+        SDL_assert(PHYSFS_delete("zipoverlay"));
+        SDL_assert(SDL_PhysFS_Unmount("resources/test.zip"));
+        SDL_assert(SDL_PhysFS_SetWriteDir(prefPath));
+        SDL_free(overlayPath);
+        SDL_free(prefPath);
+    }
+
     // SDL_PhysFS_MountFromMemory
     {
         size_t zipSize;
@@ -110,10 +888,214 @@ int main(int argc, char* argv[]) {
         SDL_free(zipData);
     }
 
+    // SDL_PhysFS_MountFromIO
+    {
+        SDL_IOStream* zipIO = SDL_IOFromFile("resources/test.zip", "rb");
+        SDL_assert(zipIO != NULL);
+        SDL_assert(SDL_PhysFS_MountFromIO(zipIO, "test-io.zip", "zipio", true));
+        SDL_assert(SDL_PhysFS_Exists("zipio/test.txt"));
+        {
+            size_t size;
+            const char* text = (const char*)SDL_PhysFS_LoadFile("zipio/test.txt", &size);
+            SDL_assert(text != NULL);
+            SDL_assert(memcmp(text, "Hello, World", 12) == 0);
+            SDL_free((void*)text);
+        }
+        SDL_assert(SDL_PhysFS_Unmount("test-io.zip"));
+    }
+
     // SDL_PhysFS_Exists
     SDL_assert(SDL_PhysFS_Exists("res/test.bmp") == true);
     SDL_assert(SDL_PhysFS_Exists("res/notfound.txt") == false);
 
+    // SDL_PhysFS_SetPathCacheEnabled
+    {
+        SDL_PhysFS_SetPathCacheEnabled(true);
+        SDL_assert(SDL_PhysFS_Exists("res/test.bmp") == true);
+        SDL_assert(SDL_PhysFS_Exists("res/test.bmp") == true);
+        SDL_assert(SDL_PhysFS_Exists("zipcache/test.txt") == false);
+        SDL_assert(SDL_PhysFS_IOFromFile("zipcache/test.txt") == NULL);
+
+        // Mounting invalidates the cached miss.
+        SDL_assert(SDL_PhysFS_Mount("resources/test.zip", "zipcache"));
+        SDL_assert(SDL_PhysFS_Exists("zipcache/test.txt") == true);
+        SDL_assert(SDL_PhysFS_Unmount("resources/test.zip"));
+        SDL_assert(SDL_PhysFS_Exists("zipcache/test.txt") == false);
+
+        // Writing invalidates the cached miss.
+        PHYSFS_delete("cache.txt");
+        SDL_PhysFS_ClearPathCache();
+        SDL_assert(SDL_PhysFS_Exists("pref/cache.txt") == false);
+        SDL_assert(SDL_PhysFS_WriteFile("cache.txt", "cache", 5) == 5);
+        SDL_assert(SDL_PhysFS_Exists("pref/cache.txt") == true);
+
+        // Past the limit on missing paths, lookups still walk the search path.
+        for (int i = 0; i < SDL_PHYSFS_PATH_CACHE_MAX_MISSING + 16; i++) {
+            char missing[64];
+            SDL_snprintf(missing, sizeof(missing), "res/missing%d.txt", i);
+            SDL_assert(SDL_PhysFS_Exists(missing) == false);
+        }
+        SDL_assert(SDL_PhysFS_Exists("res/test.bmp") == true);
+
+        SDL_PhysFS_SetPathCacheEnabled(false);
+    }
+
+    // SDL_PhysFS_SetParallelReads
+    {
+        SDL_PhysFS_SetParallelReads(true);
+        SDL_assert(SDL_PhysFS_Mount("resources/test.zip", "zipparallel"));
+        SDL_Thread* threads[4];
+        for (int i = 0; i < 4; i++) {
+            threads[i] = SDL_CreateThread(parallelLoader, "parallelLoader", (void*)"zipparallel/test.txt");
+            SDL_assert(threads[i] != NULL);
+        }
+        SDL_assert(parallelLoader((void*)"zipparallel/test.txt") == 100);
+        for (int i = 0; i < 4; i++) {
+            int loaded = 0;
+            SDL_WaitThread(threads[i], &loaded);
+            SDL_assert(loaded == 100);
+        }
+
+        // Directories, and missing files, go through PhysFS.
+        SDL_assert(parallelLoader((void*)"res/test.txt") == 100);
+        SDL_assert(SDL_PhysFS_LoadFile("zipparallel/notfound.txt", NULL) == NULL);
+
+        // Remounting reindexes the archive.
+        SDL_assert(SDL_PhysFS_Unmount("resources/test.zip"));
+        SDL_assert(SDL_PhysFS_LoadFile("zipparallel/test.txt", NULL) == NULL);
+        SDL_assert(SDL_PhysFS_Mount("resources/test.zip", "zipparallel"));
+        SDL_assert(parallelLoader((void*)"zipparallel/test.txt") == 100);
+
+        // Content cache misses are read in parallel, and then cached.
+        SDL_PhysFS_SetContentCacheSize(1024 * 1024);
+        for (int i = 0; i < 4; i++) {
+            threads[i] = SDL_CreateThread(parallelLoader, "parallelLoader", (void*)"zipparallel/test.txt");
+            SDL_assert(threads[i] != NULL);
+        }
+        for (int i = 0; i < 4; i++) {
+            int loaded = 0;
+            SDL_WaitThread(threads[i], &loaded);
+            SDL_assert(loaded == 100);
+        }
+        const char* cached = (const char*)SDL_PhysFS_AcquireFile("zipparallel/test.txt", NULL);
+        SDL_assert(cached != NULL && memcmp(cached, "Hello, World", 12) == 0);
+        SDL_assert(SDL_PhysFS_AcquireFile("zipparallel/test.txt", NULL) == cached);
+        SDL_PhysFS_ReleaseFile(cached);
+        SDL_PhysFS_ReleaseFile(cached);
+        SDL_PhysFS_SetContentCacheSize(0);
+
+        SDL_assert(SDL_PhysFS_Unmount("resources/test.zip"));
+        SDL_PhysFS_SetParallelReads(false);
+        SDL_assert(parallelLoader((void*)"res/test.txt") == 100);
+    }
+
+    // SDL_PhysFS_SetContentCacheSize
+    {
+        SDL_PhysFS_SetContentCacheSize(1024 * 1024);
+        size_t size;
+        const char* shared = (const char*)SDL_PhysFS_AcquireFile("res/test.txt", &size);
+        SDL_assert(shared != NULL);
+        SDL_assert(memcmp(shared, "Hello, World", 12) == 0);
+        const char* again = (const char*)SDL_PhysFS_AcquireFile("res/test.txt", NULL);
+        SDL_assert(again == shared);
+        SDL_PhysFS_ReleaseFile(again);
+
+        // Hits are copied by LoadFile, and read in place by IOFromFile.
+        size_t loadedSize;
+        char* loaded = (char*)SDL_PhysFS_LoadFile("res/test.txt", &loadedSize);
+        SDL_assert(loaded != NULL && loaded != shared);
+        SDL_assert(loadedSize == size);
+        SDL_assert(memcmp(loaded, shared, size) == 0);
+        SDL_free(loaded);
+        SDL_IOStream* io = SDL_PhysFS_IOFromFile("res/test.txt");
+        SDL_assert(io != NULL);
+        SDL_assert(SDL_GetIOSize(io) == (Sint64)size);
+        char text[12];
+        SDL_assert(SDL_ReadIO(io, text, sizeof(text)) == sizeof(text));
+        SDL_assert(memcmp(text, "Hello, World", 12) == 0);
+        SDL_CloseIO(io);
+
+        // Clearing the cache keeps acquired data valid.
+        SDL_PhysFS_ClearContentCache();
+        SDL_assert(memcmp(shared, "Hello, World", 12) == 0);
+        SDL_PhysFS_ReleaseFile(shared);
+
+        // Writes invalidate the cache.
+        SDL_assert(SDL_PhysFS_WriteFile("cached.txt", "before", 6) == 6);
+        shared = (const char*)SDL_PhysFS_AcquireFile("pref/cached.txt", &size);
+        SDL_assert(shared != NULL && size == 6);
+        SDL_PhysFS_ReleaseFile(shared);
+        SDL_assert(SDL_PhysFS_WriteFile("cached.txt", "after!", 6) == 6);
+        loaded = (char*)SDL_PhysFS_LoadFile("pref/cached.txt", &loadedSize);
+        SDL_assert(loaded != NULL);
+        SDL_assert(memcmp(loaded, "after!", 6) == 0);
+        SDL_free(loaded);
+
+        // Files over a quarter of the budget are read directly.
+        SDL_PhysFS_SetContentCacheSize(1024);
+        SDL_assert(SDL_PhysFS_AcquireFile("res/notfound.txt", NULL) == NULL);
+        shared = (const char*)SDL_PhysFS_AcquireFile("res/test.bmp", &size);
+        SDL_assert(shared != NULL && size == 179866);
+        again = (const char*)SDL_PhysFS_AcquireFile("res/test.bmp", NULL);
+        SDL_assert(again != NULL && again != shared);
+        SDL_PhysFS_ReleaseFile(again);
+        SDL_PhysFS_ReleaseFile(shared);
+        SDL_PhysFS_SetContentCacheSize(0);
+    }
+
+    // SDL_PhysFS_StartAccessRecording
+    {
+        SDL_PhysFS_StartAccessRecording();
+        SDL_IOStream* io = SDL_PhysFS_IOFromFile("res/test.txt");
+        SDL_assert(io != NULL);
+        SDL_CloseIO(io);
+        void* data = SDL_PhysFS_LoadFile("res/test.bmp", NULL);
+        SDL_assert(data != NULL);
+        SDL_free(data);
+        data = SDL_PhysFS_LoadFile("res/test.txt", NULL);
+        SDL_assert(data != NULL);
+        SDL_free(data);
+        SDL_assert(SDL_PhysFS_LoadFile("res/notfound.txt", NULL) == NULL);
+        SDL_assert(SDL_PhysFS_StopAccessRecording("access.manifest"));
+
+        char* manifest = (char*)SDL_PhysFS_LoadFile("pref/access.manifest", NULL);
+        SDL_assert(manifest != NULL);
+        SDL_assert(SDL_strcmp(manifest, "res/test.txt\nres/test.bmp\n") == 0);
+        SDL_free(manifest);
+
+        // SDL_PhysFS_Prefetch
+        SDL_PhysFS_SetContentCacheSize(1024 * 1024);
+        SDL_assert(SDL_PhysFS_Prefetch("pref/access.manifest"));
+        SDL_PhysFS_WaitPrefetch();
+        SDL_assert(SDL_PhysFS_Prefetch("pref/access.manifest"));
+        SDL_PhysFS_CancelPrefetch();
+        SDL_assert(!SDL_PhysFS_Prefetch("pref/notfound.manifest"));
+
+        // Archive entries are warmed up into the content cache, so the next load is a hit.
+        SDL_assert(SDL_PhysFS_Mount("resources/test.zip", "zipprefetch"));
+        SDL_assert(SDL_PhysFS_WriteFile("prefetch.manifest", "zipprefetch/test.txt\n", 21) == 21);
+        SDL_assert(SDL_PhysFS_Prefetch("pref/prefetch.manifest"));
+        SDL_PhysFS_WaitPrefetch();
+        SDL_PhysFS_WaitPrefetch();
+        data = SDL_PhysFS_LoadFile("zipprefetch/test.txt", NULL);
+        SDL_assert(data != NULL && memcmp(data, "Hello, World", 12) == 0);
+        SDL_free(data);
+#ifdef SDL_PHYSFS_STATS
+        SDL_PhysFS_Stats* stats = SDL_PhysFS_GetStats();
+        SDL_assert(stats != NULL);
+        bool warmed = false;
+        for (int i = 0; i < stats->numFiles; i++) {
+            if (SDL_strcmp(stats->files[i].name, "zipprefetch/test.txt") == 0) {
+                warmed = stats->files[i].counters.contentCacheHits == 1;
+            }
+        }
+        SDL_assert(warmed);
+        SDL_free(stats);
+#endif
+        SDL_assert(SDL_PhysFS_Unmount("resources/test.zip"));
+        SDL_PhysFS_SetContentCacheSize(0);
+    }
+
     // SDL_PhysFS_GetVersion
     SDL_assert(SDL_PhysFS_GetVersion() > 2);
 
@@ -136,6 +1118,84 @@ int main(int argc, char* argv[]) {
         SDL_assert(count == 4);
     }
 
+    // SDL_PhysFS_EnumerateDirectoryEx
+    {
+        // test.txt is provided by both the directory and the archive.
+        SDL_assert(SDL_PhysFS_Mount("resources/test.zip", "res"));
+        int count = 0;
+        SDL_assert(SDL_PhysFS_EnumerateDirectoryEx("res", 0, enumerateCounter, &count));
+        SDL_assert(count == 5);
+        count = 0;
+        SDL_assert(SDL_PhysFS_EnumerateDirectoryEx("res", SDL_PHYSFS_ENUMERATE_UNIQUE, enumerateCounter, &count));
+        SDL_assert(count == 4);
+        count = 0;
+        SDL_assert(SDL_PhysFS_EnumerateDirectoryEx("res", SDL_PHYSFS_ENUMERATE_SORTED, enumerateCounter, &count));
+        SDL_assert(count == 4);
+        count = 0;
+        SDL_assert(SDL_PhysFS_EnumerateDirectory("res", enumerateFirst, &count));
+        SDL_assert(count == 1);
+        SDL_assert(SDL_PhysFS_Unmount("resources/test.zip"));
+    }
+
+    // SDL_PhysFS_Walk
+    {
+        SDL_assert(SDL_PhysFS_Mount("resources/test.zip", "res/nested"));
+        SDL_AtomicInt count;
+        SDL_SetAtomicInt(&count, 0);
+        SDL_assert(SDL_PhysFS_Walk("res", "*.txt", 0, walkCounter, &count));
+        SDL_assert(SDL_GetAtomicInt(&count) == 1);
+        SDL_SetAtomicInt(&count, 0);
+        SDL_assert(SDL_PhysFS_Walk("res", "*/*.TXT", SDL_PHYSFS_WALK_CASEINSENSITIVE | SDL_PHYSFS_WALK_PARALLEL, walkCounter, &count));
+        SDL_assert(SDL_GetAtomicInt(&count) == 1);
+        SDL_SetAtomicInt(&count, 0);
+        SDL_assert(SDL_PhysFS_Walk("res", "*.?mp", SDL_PHYSFS_WALK_PARALLEL, walkCounter, &count));
+        SDL_assert(SDL_GetAtomicInt(&count) == 1);
+        SDL_assert(!SDL_PhysFS_Walk("res/notfound", NULL, 0, walkCounter, &count));
+        SDL_assert(SDL_PhysFS_Unmount("resources/test.zip"));
+    }
+
+    // SDL_PhysFS_GetStats
+#ifdef SDL_PHYSFS_STATS
+    {
+        int events[SDL_PHYSFS_TRACE_CLOSE + 1] = { 0 };
+        SDL_PhysFS_ResetStats();
+        SDL_assert(SDL_PhysFS_SetTraceCallback(traceCounter, events));
+        SDL_IOStream* io = SDL_PhysFS_IOFromFile("res/test.txt");
+        SDL_assert(io != NULL);
+        char text[5];
+        SDL_assert(SDL_ReadIO(io, text, sizeof(text)) == sizeof(text));
+        SDL_assert(SDL_SeekIO(io, 0, SDL_IO_SEEK_SET) == 0);
+        SDL_CloseIO(io);
+        size_t size;
+        void* data = SDL_PhysFS_LoadFile("res/test.txt", &size);
+        SDL_assert(data != NULL);
+        SDL_free(data);
+        SDL_assert(SDL_PhysFS_SetTraceCallback(NULL, NULL));
+        SDL_assert(events[SDL_PHYSFS_TRACE_OPEN] == 2);
+        SDL_assert(events[SDL_PHYSFS_TRACE_SEEK] == 1);
+        SDL_assert(events[SDL_PHYSFS_TRACE_CLOSE] == 2);
+
+        SDL_PhysFS_Stats* stats = SDL_PhysFS_GetStats();
+        SDL_assert(stats != NULL);
+        SDL_assert(stats->total.opens == 2);
+        SDL_assert(stats->total.seeks == 1);
+        SDL_assert(stats->total.bytesRead == sizeof(text) + size);
+        bool found = false;
+        for (int i = 0; i < stats->numFiles; i++) {
+            if (SDL_strcmp(stats->files[i].name, "res/test.txt") == 0) {
+                SDL_assert(stats->files[i].counters.opens == 2);
+                found = true;
+            }
+        }
+        SDL_assert(found);
+        SDL_assert(stats->numMounts >= 1);
+        SDL_free(stats);
+    }
+#else
+    SDL_assert(SDL_PhysFS_GetStats() == NULL);
+    SDL_assert(!SDL_PhysFS_SetTraceCallback(traceCounter, NULL));
+#endif
+
     // SDL_PhysFS_IOStatus
     SDL_assert(SDL_PhysFS_IOStatus(PHYSFS_ERR_OK) == SDL_IO_STATUS_READY);
     SDL_assert(SDL_PhysFS_IOStatus(PHYSFS_ERR_PAST_EOF) == SDL_IO_STATUS_EOF);
@@ -1,10 +1,10 @@
 set(SDL_STATIC TRUE)
 set(SDL_SHARED FALSE)
 set(SDL_DISABLE_UNINSTALL TRUE)
-set(SDL_VIDEO OFF)
-set(SDL_AUDIO OFF)
+set(SDL_VIDEO ON)
+set(SDL_AUDIO ON)
 set(SDL_GPU OFF)
-set(SDL_RENDER OFF)
+set(SDL_RENDER ON)
 set(SDL_UNIX_CONSOLE_BUILD ON)
 
 include(FetchContent)
@@ -0,0 +1,645 @@
+#include <SDL3/SDL.h>
+#include <stdio.h>
+
+#define SDL_PHYSFS_IMPLEMENTATION
+#include "SDL_PhysFS.h"
+
+/**
+ * Builds a content pack from a directory, for mounting with SDL_PhysFS_Mount().
+ *
+ *   sdl_physfs_cas [--base BASE.cas]... [--no-verify] <directory> <output.cas>
+ *
+ * - Files with identical contents are stored once, however many paths share them.
+ * - With one or more base packs, the output is a delta pack: blobs that a base
+ *   already has are left out, and found in the base when both are mounted. The
+ *   delta pack records the identity of each base, and no other pack is searched.
+ * - Blobs are written in path order, so loading a directory walks the pack front to back.
+ *
+ * Blobs are named by the SHA-256 of their contents, and shared blobs are still
+ * compared byte for byte, so a hash collision fails the build rather than
+ * aliasing two files. The pack is mounted afterwards, along with its
+ * bases, and every file is checked against its source.
+ */
+
+#define CAS_HASH_SIZE SDL_PHYSFS_CONTENT_PACK_HASH_SIZE
+
+typedef struct CasEntry {
+    char* name;
+    Uint8 hash[CAS_HASH_SIZE];
+    Uint64 size;
+    int blob;
+} CasEntry;
+
+typedef struct CasBlob {
+    Uint8 hash[CAS_HASH_SIZE];
+    Uint64 size;
+    Uint64 offset;
+    bool inBase;
+} CasBlob;
+
+typedef struct CasBase {
+    const char* path;
+    Uint8 id[CAS_HASH_SIZE];
+    CasBlob* blobs;
+    Uint32 count;
+} CasBase;
+
+typedef struct CasConfig {
+    const char* directory;
+    const char* output;
+    CasBase* bases;
+    int numBases;
+    bool verify;
+} CasConfig;
+
+static CasConfig config = { NULL, NULL, NULL, 0, true };
+
+typedef struct CasSha256 {
+    Uint32 state[8];
+    Uint8 block[64];
+    Uint64 length;
+} CasSha256;
+
+static const Uint32 casSha256Constants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static Uint32 casRotateRight(Uint32 value, int bits) {
+    return (value >> bits) | (value << (32 - bits));
+}
+
+static void casSha256Block(CasSha256* context, const Uint8* block) {
+    Uint32 w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = ((Uint32)block[i * 4] << 24) | ((Uint32)block[i * 4 + 1] << 16) | ((Uint32)block[i * 4 + 2] << 8) | (Uint32)block[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        Uint32 s0 = casRotateRight(w[i - 15], 7) ^ casRotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        Uint32 s1 = casRotateRight(w[i - 2], 17) ^ casRotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    Uint32 v[8];
+    SDL_memcpy(v, context->state, sizeof(v));
+    for (int i = 0; i < 64; i++) {
+        Uint32 s1 = casRotateRight(v[4], 6) ^ casRotateRight(v[4], 11) ^ casRotateRight(v[4], 25);
+        Uint32 choice = (v[4] & v[5]) ^ (~v[4] & v[6]);
+        Uint32 t1 = v[7] + s1 + choice + casSha256Constants[i] + w[i];
+        Uint32 s0 = casRotateRight(v[0], 2) ^ casRotateRight(v[0], 13) ^ casRotateRight(v[0], 22);
+        Uint32 majority = (v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]);
+        SDL_memmove(v + 1, v, sizeof(Uint32) * 7);
+        v[4] += t1;
+        v[0] = t1 + s0 + majority;
+    }
+    for (int i = 0; i < 8; i++) {
+        context->state[i] += v[i];
+    }
+}
+
+static void casSha256Init(CasSha256* context) {
+    static const Uint32 initial[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+    SDL_memcpy(context->state, initial, sizeof(initial));
+    context->length = 0;
+}
+
+static void casSha256Update(CasSha256* context, const void* data, size_t size) {
+    const Uint8* bytes = (const Uint8*)data;
+    while (size > 0) {
+        // Whole blocks are hashed in place, and the rest is gathered into the context's block.
+        size_t used = (size_t)(context->length % 64);
+        if (used == 0 && size >= 64) {
+            casSha256Block(context, bytes);
+            context->length += 64;
+            bytes += 64;
+            size -= 64;
+            continue;
+        }
+
+        size_t length = SDL_min(size, 64 - used);
+        SDL_memcpy(context->block + used, bytes, length);
+        context->length += length;
+        bytes += length;
+        size -= length;
+        if (context->length % 64 == 0) {
+            casSha256Block(context, context->block);
+        }
+    }
+}
+
+static void casSha256Final(CasSha256* context, Uint8* hash) {
+    Uint64 bits = context->length * 8;
+    Uint8 padding = 0x80;
+    casSha256Update(context, &padding, 1);
+    padding = 0;
+    while (context->length % 64 != 56) {
+        casSha256Update(context, &padding, 1);
+    }
+    for (int i = 7; i >= 0; i--) {
+        Uint8 byte = (Uint8)(bits >> (i * 8));
+        casSha256Update(context, &byte, 1);
+    }
+    for (int i = 0; i < 8; i++) {
+        hash[i * 4] = (Uint8)(context->state[i] >> 24);
+        hash[i * 4 + 1] = (Uint8)(context->state[i] >> 16);
+        hash[i * 4 + 2] = (Uint8)(context->state[i] >> 8);
+        hash[i * 4 + 3] = (Uint8)context->state[i];
+    }
+}
+
+/**
+ * The content hash that names a blob: the SHA-256 of its contents. The archiver matches blobs by hash and size.
+ */
+static void casHash(const void* data, size_t size, Uint8* hash) {
+    CasSha256 context;
+    casSha256Init(&context);
+    casSha256Update(&context, data, size);
+    casSha256Final(&context, hash);
+}
+
+static int casCompareKeys(const Uint8* hash, Uint64 size, const Uint8* otherHash, Uint64 otherSize) {
+    int result = SDL_memcmp(hash, otherHash, CAS_HASH_SIZE);
+    if (result != 0) {
+        return result;
+    }
+    if (size != otherSize) {
+        return size < otherSize ? -1 : 1;
+    }
+
+    return 0;
+}
+
+static int SDLCALL casCompareBlobs(const void* a, const void* b) {
+    const CasBlob* left = (const CasBlob*)a;
+    const CasBlob* right = (const CasBlob*)b;
+    return casCompareKeys(left->hash, left->size, right->hash, right->size);
+}
+
+static int SDLCALL casCompareEntryNames(const void* a, const void* b) {
+    return SDL_strcmp(((const CasEntry*)a)->name, ((const CasEntry*)b)->name);
+}
+
+static CasEntry* casSortEntries;
+
+static int SDLCALL casCompareEntryContents(const void* a, const void* b) {
+    const CasEntry* left = &casSortEntries[*(const int*)a];
+    const CasEntry* right = &casSortEntries[*(const int*)b];
+    int result = casCompareKeys(left->hash, left->size, right->hash, right->size);
+    return result != 0 ? result : SDL_strcmp(left->name, right->name);
+}
+
+static void* casLoadEntry(const CasEntry* entry, size_t* size) {
+    char path[1024];
+    SDL_snprintf(path, sizeof(path), "%s/%s", config.directory, entry->name);
+    return SDL_LoadFile(path, size);
+}
+
+/**
+ * Lists every regular file under the directory by name, with the hash and size of its contents.
+ */
+static CasEntry* casCollectEntries(const char* directory, int* count) {
+    int numPaths = 0;
+    char** paths = SDL_GlobDirectory(directory, NULL, 0, &numPaths);
+    if (paths == NULL) {
+        return NULL;
+    }
+
+    CasEntry* entries = (CasEntry*)SDL_calloc((size_t)numPaths + 1, sizeof(CasEntry));
+    if (entries == NULL) {
+        SDL_free(paths);
+        return NULL;
+    }
+
+    *count = 0;
+    char fullPath[1024];
+    for (int i = 0; i < numPaths; i++) {
+        SDL_PathInfo info;
+        SDL_snprintf(fullPath, sizeof(fullPath), "%s/%s", directory, paths[i]);
+        if (!SDL_GetPathInfo(fullPath, &info) || info.type != SDL_PATHTYPE_FILE) {
+            continue;
+        }
+
+        size_t size;
+        void* data = SDL_LoadFile(fullPath, &size);
+        if (data == NULL) {
+            SDL_free(paths);
+            for (int j = 0; j < *count; j++) {
+                SDL_free(entries[j].name);
+            }
+            SDL_free(entries);
+            return NULL;
+        }
+
+        CasEntry* entry = &entries[(*count)++];
+        entry->name = SDL_strdup(paths[i]);
+        for (char* c = entry->name; *c != '\0'; c++) {
+            if (*c == '\\') {
+                *c = '/';
+            }
+        }
+        casHash(data, size, entry->hash);
+        entry->size = size;
+        entry->blob = -1;
+        SDL_free(data);
+    }
+
+    SDL_free(paths);
+    SDL_qsort(entries, (size_t)*count, sizeof(CasEntry), casCompareEntryNames);
+    return entries;
+}
+
+static void casFreeEntries(CasEntry* entries, int count) {
+    for (int i = 0; i < count; i++) {
+        SDL_free(entries[i].name);
+    }
+    SDL_free(entries);
+}
+
+/**
+ * Reads the blob records of a base pack.
+ */
+static bool casLoadBase(CasBase* base) {
+    SDL_IOStream* io = SDL_IOFromFile(base->path, "rb");
+    if (io == NULL) {
+        return false;
+    }
+
+    char magic[8];
+    Uint32 version, entryCount, stringsSize, baseCount, reserved;
+    Uint64 indexOffset;
+    bool result = SDL_ReadIO(io, magic, sizeof(magic)) == sizeof(magic) &&
+        SDL_ReadU32LE(io, &version) &&
+        SDL_ReadU32LE(io, &base->count) &&
+        SDL_ReadU32LE(io, &entryCount) &&
+        SDL_ReadU32LE(io, &stringsSize) &&
+        SDL_ReadU64LE(io, &indexOffset) &&
+        SDL_ReadU32LE(io, &baseCount) &&
+        SDL_ReadU32LE(io, &reserved) &&
+        SDL_ReadIO(io, base->id, CAS_HASH_SIZE) == CAS_HASH_SIZE;
+    if (result && (SDL_memcmp(magic, SDL_PHYSFS_CONTENT_PACK_MAGIC, sizeof(magic)) != 0 || version != SDL_PHYSFS_CONTENT_PACK_VERSION)) {
+        result = SDL_SetError("Not a content pack");
+    }
+
+    // The blob records follow the identities of the base's own bases.
+    Sint64 blobsOffset = (Sint64)(indexOffset + (Uint64)baseCount * CAS_HASH_SIZE);
+    base->blobs = result ? (CasBlob*)SDL_malloc(sizeof(CasBlob) * (base->count + 1)) : NULL;
+    result = base->blobs != NULL && SDL_SeekIO(io, blobsOffset, SDL_IO_SEEK_SET) == blobsOffset;
+    for (Uint32 i = 0; i < base->count && result; i++) {
+        CasBlob* blob = &base->blobs[i];
+        result = SDL_ReadIO(io, blob->hash, CAS_HASH_SIZE) == CAS_HASH_SIZE && SDL_ReadU64LE(io, &blob->offset) && SDL_ReadU64LE(io, &blob->size);
+    }
+
+    SDL_CloseIO(io);
+    return result;
+}
+
+/**
+ * Checks whether a base pack has the blob, comparing its contents to make sure.
+ */
+static bool casFindInBase(const CasBase* base, const void* data, const Uint8* hash, Uint64 size, bool* found) {
+    CasBlob key;
+    SDL_memcpy(key.hash, hash, CAS_HASH_SIZE);
+    key.size = size;
+    const CasBlob* blob = (const CasBlob*)SDL_bsearch(&key, base->blobs, base->count, sizeof(CasBlob), casCompareBlobs);
+    *found = false;
+    if (blob == NULL) {
+        return true;
+    }
+
+    SDL_IOStream* io = SDL_IOFromFile(base->path, "rb");
+    void* contents = SDL_malloc((size_t)size + 1);
+    bool result = io != NULL && contents != NULL &&
+        SDL_SeekIO(io, (Sint64)blob->offset, SDL_IO_SEEK_SET) == (Sint64)blob->offset &&
+        SDL_ReadIO(io, contents, (size_t)size) == (size_t)size;
+    if (result && SDL_memcmp(contents, data, (size_t)size) != 0) {
+        result = SDL_SetError("Hash collision with %s", base->path);
+    }
+    *found = result;
+
+    SDL_free(contents);
+    SDL_CloseIO(io);
+    return result;
+}
+
+/**
+ * Checks each base pack for the blob.
+ */
+static bool casFindInBases(CasBlob* blob, const void* data) {
+    blob->inBase = false;
+    for (int i = 0; i < config.numBases && !blob->inBase; i++) {
+        if (!casFindInBase(&config.bases[i], data, blob->hash, blob->size, &blob->inBase)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Groups entries with the same contents into blobs, and finds the blobs that the base packs already have.
+ *
+ * @return The number of blobs, with each entry's blob set, or -1 on failure.
+ */
+static int casFindBlobs(CasEntry* entries, int count, CasBlob* blobs) {
+    int* order = (int*)SDL_malloc(sizeof(int) * ((size_t)count + 1));
+    if (order == NULL) {
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    casSortEntries = entries;
+    SDL_qsort(order, (size_t)count, sizeof(int), casCompareEntryContents);
+
+    int numBlobs = 0;
+    void* first = NULL;
+    for (int i = 0; i < count; i++) {
+        CasEntry* entry = &entries[order[i]];
+        size_t size;
+        void* data = casLoadEntry(entry, &size);
+        if (data == NULL || size != entry->size) {
+            SDL_free(data);
+            numBlobs = -1;
+            break;
+        }
+
+        // The first of each run of identical keys starts a blob, and the rest must match it.
+        CasBlob* blob = numBlobs > 0 ? &blobs[numBlobs - 1] : NULL;
+        if (blob != NULL && casCompareKeys(blob->hash, blob->size, entry->hash, entry->size) == 0) {
+            bool same = SDL_memcmp(first, data, size) == 0;
+            SDL_free(data);
+            if (!same) {
+                SDL_SetError("%s: Hash collision", entry->name);
+                numBlobs = -1;
+                break;
+            }
+            entry->blob = numBlobs - 1;
+            continue;
+        }
+
+        blob = &blobs[numBlobs];
+        SDL_memcpy(blob->hash, entry->hash, CAS_HASH_SIZE);
+        blob->size = entry->size;
+        blob->offset = 0;
+        if (!casFindInBases(blob, data)) {
+            SDL_free(data);
+            numBlobs = -1;
+            break;
+        }
+
+        SDL_free(first);
+        first = data;
+        entry->blob = numBlobs++;
+    }
+
+    SDL_free(first);
+    SDL_free(order);
+    return numBlobs;
+}
+
+/**
+ * Writes the blobs that aren't in a base, in the order their first path comes by name.
+ *
+ * @return The number of blobs written.
+ */
+static int casWriteBlobs(SDL_IOStream* pack, const CasEntry* entries, int count, CasBlob* blobs) {
+    int written = 0;
+    for (int i = 0; i < count; i++) {
+        CasBlob* blob = &blobs[entries[i].blob];
+        if (blob->inBase || blob->offset != 0) {
+            continue;
+        }
+
+        size_t size;
+        void* data = casLoadEntry(&entries[i], &size);
+        Sint64 offset = SDL_TellIO(pack);
+        bool result = data != NULL && offset > 0 && SDL_WriteIO(pack, data, size) == size;
+        SDL_free(data);
+        if (!result) {
+            return -1;
+        }
+        blob->offset = (Uint64)offset;
+        written++;
+    }
+
+    return written;
+}
+
+/**
+ * Writes the index: the identity of each base, the stored blobs sorted by hash
+ * and size, then each entry and its name. The pack's identity is the SHA-256
+ * of its index.
+ */
+static bool casWriteIndex(SDL_IOStream* pack, const CasEntry* entries, int count, const CasBlob* blobs, int numBlobs, Uint32* blobCount, Uint32* stringsSize, Uint8* id) {
+    CasBlob* stored = (CasBlob*)SDL_malloc(sizeof(CasBlob) * ((size_t)numBlobs + 1));
+    if (stored == NULL) {
+        return false;
+    }
+    *blobCount = 0;
+    for (int i = 0; i < numBlobs; i++) {
+        if (!blobs[i].inBase) {
+            stored[(*blobCount)++] = blobs[i];
+        }
+    }
+    SDL_qsort(stored, *blobCount, sizeof(CasBlob), casCompareBlobs);
+
+    // The index is built in memory, so it can be hashed before it's written.
+    *stringsSize = 0;
+    for (int i = 0; i < count; i++) {
+        *stringsSize += (Uint32)SDL_strlen(entries[i].name) + 1;
+    }
+    size_t indexSize = (size_t)config.numBases * CAS_HASH_SIZE + ((size_t)*blobCount + (size_t)count) * SDL_PHYSFS_CONTENT_PACK_RECORD_SIZE + *stringsSize;
+    Uint8* index = (Uint8*)SDL_malloc(indexSize + 1);
+    SDL_IOStream* io = index != NULL ? SDL_IOFromMem(index, indexSize + 1) : NULL;
+    bool result = io != NULL;
+    for (int i = 0; i < config.numBases && result; i++) {
+        result = SDL_WriteIO(io, config.bases[i].id, CAS_HASH_SIZE) == CAS_HASH_SIZE;
+    }
+    for (Uint32 i = 0; i < *blobCount && result; i++) {
+        result = SDL_WriteIO(io, stored[i].hash, CAS_HASH_SIZE) == CAS_HASH_SIZE && SDL_WriteU64LE(io, stored[i].offset) && SDL_WriteU64LE(io, stored[i].size);
+    }
+    SDL_free(stored);
+
+    Uint32 nameOffset = 0;
+    for (int i = 0; i < count && result; i++) {
+        Uint32 nameLength = (Uint32)SDL_strlen(entries[i].name);
+        result = SDL_WriteIO(io, entries[i].hash, CAS_HASH_SIZE) == CAS_HASH_SIZE && SDL_WriteU64LE(io, entries[i].size) &&
+            SDL_WriteU32LE(io, nameOffset) && SDL_WriteU32LE(io, nameLength);
+        nameOffset += nameLength + 1;
+    }
+    for (int i = 0; i < count && result; i++) {
+        size_t nameLength = SDL_strlen(entries[i].name) + 1;
+        result = SDL_WriteIO(io, entries[i].name, nameLength) == nameLength;
+    }
+    if (io != NULL) {
+        result = SDL_TellIO(io) == (Sint64)indexSize && result;
+        SDL_CloseIO(io);
+    }
+
+    if (result) {
+        casHash(index, indexSize, id);
+        result = SDL_WriteIO(pack, index, indexSize) == indexSize;
+    }
+    SDL_free(index);
+    return result;
+}
+
+static bool casWriteHeader(SDL_IOStream* pack, Uint32 blobCount, Uint32 entryCount, Uint32 stringsSize, Uint64 indexOffset, const Uint8* id) {
+    return SDL_SeekIO(pack, 0, SDL_IO_SEEK_SET) == 0 &&
+        SDL_WriteIO(pack, SDL_PHYSFS_CONTENT_PACK_MAGIC, 8) == 8 &&
+        SDL_WriteU32LE(pack, SDL_PHYSFS_CONTENT_PACK_VERSION) &&
+        SDL_WriteU32LE(pack, blobCount) &&
+        SDL_WriteU32LE(pack, entryCount) &&
+        SDL_WriteU32LE(pack, stringsSize) &&
+        SDL_WriteU64LE(pack, indexOffset) &&
+        SDL_WriteU32LE(pack, (Uint32)config.numBases) &&
+        SDL_WriteU32LE(pack, 0) &&
+        SDL_WriteIO(pack, id, CAS_HASH_SIZE) == CAS_HASH_SIZE;
+}
+
+/**
+ * Mounts the written pack with its bases, and compares every file against its source.
+ */
+static bool casVerify(const char* argv0, const CasEntry* entries, int count) {
+    if (!SDL_PhysFS_Init(argv0)) {
+        return false;
+    }
+
+    bool result = SDL_PhysFS_Mount(config.output, "pack");
+    char filename[1024];
+    for (int i = 0; i < config.numBases && result; i++) {
+        SDL_snprintf(filename, sizeof(filename), "base%d", i);
+        result = SDL_PhysFS_Mount(config.bases[i].path, filename);
+    }
+
+    for (int i = 0; i < count && result; i++) {
+        size_t size;
+        SDL_snprintf(filename, sizeof(filename), "pack/%s", entries[i].name);
+        void* data = SDL_PhysFS_LoadFile(filename, &size);
+        Uint8 hash[CAS_HASH_SIZE];
+        if (data != NULL) {
+            casHash(data, size, hash);
+        }
+        if (data == NULL || size != entries[i].size || SDL_memcmp(hash, entries[i].hash, CAS_HASH_SIZE) != 0) {
+            result = SDL_SetError("%s: doesn't match its source", entries[i].name);
+        }
+        SDL_free(data);
+    }
+
+    SDL_PhysFS_Quit();
+    return result;
+}
+
+static bool casParseArguments(int argc, char* argv[]) {
+    config.bases = (CasBase*)SDL_calloc((size_t)argc, sizeof(CasBase));
+    if (config.bases == NULL) {
+        return false;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (SDL_strcmp(argv[i], "--no-verify") == 0) {
+            config.verify = false;
+        }
+        else if (SDL_strcmp(argv[i], "--base") == 0 && i + 1 < argc) {
+            config.bases[config.numBases++].path = argv[++i];
+        }
+        else if (config.directory == NULL) {
+            config.directory = argv[i];
+        }
+        else if (config.output == NULL) {
+            config.output = argv[i];
+        }
+        else {
+            return false;
+        }
+    }
+
+    return config.directory != NULL && config.output != NULL;
+}
+
+static void casFreeBases(void) {
+    for (int i = 0; i < config.numBases; i++) {
+        SDL_free(config.bases[i].blobs);
+    }
+    SDL_free(config.bases);
+}
+
+int main(int argc, char* argv[]) {
+    if (!casParseArguments(argc, argv)) {
+        fprintf(stderr, "Usage: %s [--base BASE.cas]... [--no-verify] <directory> <output.cas>\n", argv[0]);
+        casFreeBases();
+        return 1;
+    }
+
+    for (int i = 0; i < config.numBases; i++) {
+        if (!casLoadBase(&config.bases[i])) {
+            fprintf(stderr, "%s: %s\n", config.bases[i].path, SDL_GetError());
+            casFreeBases();
+            return 1;
+        }
+    }
+
+    int count = 0;
+    CasEntry* entries = casCollectEntries(config.directory, &count);
+    if (entries == NULL) {
+        fprintf(stderr, "%s: %s\n", config.directory, SDL_GetError());
+        casFreeBases();
+        return 1;
+    }
+
+    CasBlob* blobs = (CasBlob*)SDL_malloc(sizeof(CasBlob) * ((size_t)count + 1));
+    int numBlobs = blobs != NULL ? casFindBlobs(entries, count, blobs) : -1;
+    if (numBlobs < 0) {
+        fprintf(stderr, "%s: %s\n", config.directory, SDL_GetError());
+        SDL_free(blobs);
+        casFreeEntries(entries, count);
+        casFreeBases();
+        return 1;
+    }
+
+    // The header is written last, once the index's offset and sizes are known.
+    SDL_IOStream* pack = SDL_IOFromFile(config.output, "wb");
+    Uint32 blobCount = 0;
+    Uint32 stringsSize = 0;
+    int written = -1;
+    Uint8 id[CAS_HASH_SIZE] = { 0 };
+    bool result = pack != NULL && casWriteHeader(pack, 0, 0, 0, 0, id);
+    if (result) {
+        written = casWriteBlobs(pack, entries, count, blobs);
+        result = written >= 0;
+    }
+    Sint64 indexOffset = result ? SDL_TellIO(pack) : -1;
+    result = result && indexOffset > 0 &&
+        casWriteIndex(pack, entries, count, blobs, numBlobs, &blobCount, &stringsSize, id) &&
+        casWriteHeader(pack, blobCount, (Uint32)count, stringsSize, (Uint64)indexOffset, id);
+    if (pack != NULL) {
+        result = SDL_CloseIO(pack) && result;
+    }
+    if (!result) {
+        fprintf(stderr, "%s: %s\n", config.output, SDL_GetError());
+        SDL_free(blobs);
+        casFreeEntries(entries, count);
+        casFreeBases();
+        return 1;
+    }
+
+    if (config.verify && !casVerify(argv[0], entries, count)) {
+        fprintf(stderr, "%s: %s\n", config.output, SDL_GetError());
+        SDL_free(blobs);
+        casFreeEntries(entries, count);
+        casFreeBases();
+        return 1;
+    }
+
+    printf("%s: %d entries, %d blobs written, %d shared, %d in a base\n", config.output, count, written, count - numBlobs, numBlobs - written);
+    SDL_free(blobs);
+    casFreeEntries(entries, count);
+    casFreeBases();
+    return 0;
+}
@@ -0,0 +1,536 @@
+#include <SDL3/SDL.h>
+#include <stdio.h>
+
+#ifdef SDL_PHYSFS_PACK_ZLIB
+#include <zlib.h>
+#endif
+
+#define SDL_PHYSFS_IMPLEMENTATION
+#include "SDL_PhysFS.h"
+
+/**
+ * Packs a directory into a zip archive laid out for SDL_PhysFS.
+ *
+ *   sdl_physfs_pack [--manifest FILE] [--align BYTES] [--index] [--no-verify] <directory> <output.zip>
+ *
+ * - Formats that are already compressed are stored, so they're read, or
+ *   mapped with SDL_PhysFS_MapFile(), without going through inflate.
+ * - Stored entries start on an aligned offset, 4 KB by default. --align
+ *   takes a power of two from 4 to 32768.
+ * - Entries listed in the manifest, such as one written by
+ *   SDL_PhysFS_StopAccessRecording(), come first and in that order, so
+ *   loading them walks the archive front to back. The rest follow by name.
+ * - Everything else is deflated when built with zlib, and when it's worth it.
+ * - With --index, everything is stored, and a mount index is written beside
+ *   the archive, so SDL_PhysFS_Mount() doesn't read its central directory.
+ *
+ * The archive is mounted afterwards, and every entry is checked against its source.
+ */
+
+#define PACK_LOCAL_HEADER_SIZE 30
+#define PACK_ALIGNMENT_EXTRA_ID 0xD935
+
+typedef struct PackEntry {
+    char* name;
+    Uint64 size;
+    SDL_Time modified;
+    int order;
+    Uint16 method;
+    Uint32 crc;
+    Uint32 compressedSize;
+    Uint32 offset;
+    Uint16 extraLength;
+} PackEntry;
+
+typedef struct PackManifestEntry {
+    const char* name;
+    int order;
+} PackManifestEntry;
+
+typedef struct PackConfig {
+    const char* directory;
+    const char* output;
+    const char* manifest;
+    Uint32 alignment;
+    bool index;
+    bool verify;
+} PackConfig;
+
+static PackConfig config = { NULL, NULL, NULL, 4096, false, true };
+
+/**
+ * File extensions whose contents are already compressed, and don't shrink when deflated.
+ */
+static const char* packStoredExtensions[] = {
+    "png", "jpg", "jpeg", "webp", "avif", "jxl", "ogg", "opus", "mp3", "flac",
+    "mp4", "webm", "zip", "gz", "xz", "zst", "7z", "bz2", "ktx2", "basis"
+};
+
+static bool packIsCompressedFormat(const char* name) {
+    const char* extension = SDL_strrchr(name, '.');
+    if (extension == NULL || SDL_strchr(extension, '/') != NULL) {
+        return false;
+    }
+    extension++;
+
+    for (size_t i = 0; i < SDL_arraysize(packStoredExtensions); i++) {
+        if (SDL_strcasecmp(extension, packStoredExtensions[i]) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static int SDLCALL packCompareManifestEntries(const void* a, const void* b) {
+    return SDL_strcmp(((const PackManifestEntry*)a)->name, ((const PackManifestEntry*)b)->name);
+}
+
+static int SDLCALL packCompareEntries(const void* a, const void* b) {
+    const PackEntry* left = (const PackEntry*)a;
+    const PackEntry* right = (const PackEntry*)b;
+    if (left->order != right->order) {
+        return left->order < right->order ? -1 : 1;
+    }
+
+    return SDL_strcmp(left->name, right->name);
+}
+
+/**
+ * Finds each entry's position in the manifest. Entries that aren't listed keep SDL_MAX_SINT32, and sort last.
+ */
+static bool packApplyManifest(PackEntry* entries, int count, const char* manifest) {
+    size_t size;
+    char* text = (char*)SDL_LoadFile(manifest, &size);
+    if (text == NULL) {
+        return false;
+    }
+
+    int lines = 1;
+    for (size_t i = 0; i < size; i++) {
+        lines += text[i] == '\n';
+    }
+
+    PackManifestEntry* listed = (PackManifestEntry*)SDL_malloc(sizeof(PackManifestEntry) * (size_t)lines);
+    if (listed == NULL) {
+        SDL_free(text);
+        return false;
+    }
+
+    int numListed = 0;
+    char* line = text;
+    while (line != NULL && *line != '\0') {
+        char* next = SDL_strchr(line, '\n');
+        if (next != NULL) {
+            *next++ = '\0';
+        }
+        size_t length = SDL_strlen(line);
+        if (length > 0 && line[length - 1] == '\r') {
+            line[length - 1] = '\0';
+        }
+        if (*line == '/') {
+            line++;
+        }
+        if (*line != '\0') {
+            listed[numListed].name = line;
+            listed[numListed].order = numListed;
+            numListed++;
+        }
+        line = next;
+    }
+
+    SDL_qsort(listed, (size_t)numListed, sizeof(PackManifestEntry), packCompareManifestEntries);
+    for (int i = 0; i < count; i++) {
+        PackManifestEntry key = { entries[i].name, 0 };
+        const PackManifestEntry* found = (const PackManifestEntry*)SDL_bsearch(&key, listed, (size_t)numListed, sizeof(PackManifestEntry), packCompareManifestEntries);
+        if (found != NULL) {
+            entries[i].order = found->order;
+        }
+    }
+
+    SDL_free(listed);
+    SDL_free(text);
+    return true;
+}
+
+/**
+ * Lists every regular file under the directory, with paths relative to it.
+ */
+static PackEntry* packCollectEntries(const char* directory, int* count) {
+    int numPaths = 0;
+    char** paths = SDL_GlobDirectory(directory, NULL, 0, &numPaths);
+    if (paths == NULL) {
+        return NULL;
+    }
+
+    PackEntry* entries = (PackEntry*)SDL_calloc((size_t)numPaths + 1, sizeof(PackEntry));
+    if (entries == NULL) {
+        SDL_free(paths);
+        return NULL;
+    }
+
+    *count = 0;
+    char fullPath[1024];
+    for (int i = 0; i < numPaths; i++) {
+        SDL_PathInfo info;
+        SDL_snprintf(fullPath, sizeof(fullPath), "%s/%s", directory, paths[i]);
+        if (!SDL_GetPathInfo(fullPath, &info) || info.type != SDL_PATHTYPE_FILE) {
+            continue;
+        }
+
+        PackEntry* entry = &entries[(*count)++];
+        entry->name = SDL_strdup(paths[i]);
+        for (char* c = entry->name; *c != '\0'; c++) {
+            if (*c == '\\') {
+                *c = '/';
+            }
+        }
+        entry->size = info.size;
+        entry->modified = info.modify_time;
+        entry->order = SDL_MAX_SINT32;
+    }
+
+    SDL_free(paths);
+    return entries;
+}
+
+static void packFreeEntries(PackEntry* entries, int count) {
+    for (int i = 0; i < count; i++) {
+        SDL_free(entries[i].name);
+    }
+    SDL_free(entries);
+}
+
+/**
+ * Converts a file time to the MS-DOS time and date fields used by zip.
+ */
+static void packDosTime(SDL_Time time, Uint16* dosTime, Uint16* dosDate) {
+    SDL_DateTime dt;
+    if (!SDL_TimeToDateTime(time, &dt, true) || dt.year < 1980) {
+        *dosTime = 0;
+        *dosDate = (1 << 5) | 1;
+        return;
+    }
+
+    *dosTime = (Uint16)((dt.hour << 11) | (dt.minute << 5) | (dt.second / 2));
+    *dosDate = (Uint16)(((dt.year - 1980) << 9) | (dt.month << 5) | dt.day);
+}
+
+/**
+ * Deflates the data when it's worth it. Anything that saves less than a sixteenth costs more to inflate than it saves reading.
+ *
+ * @return The deflated data, or NULL to store the entry.
+ */
+static Uint8* packDeflate(const Uint8* data, size_t size, Uint32* compressedSize) {
+#ifdef SDL_PHYSFS_PACK_ZLIB
+    if (size < 64) {
+        return NULL;
+    }
+
+    z_stream stream;
+    SDL_zero(stream);
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return NULL;
+    }
+
+    uLong bound = deflateBound(&stream, (uLong)size);
+    Uint8* compressed = (Uint8*)SDL_malloc(bound);
+    if (compressed == NULL) {
+        deflateEnd(&stream);
+        return NULL;
+    }
+
+    stream.next_in = (Bytef*)data;
+    stream.avail_in = (uInt)size;
+    stream.next_out = compressed;
+    stream.avail_out = (uInt)bound;
+    int result = deflate(&stream, Z_FINISH);
+    size_t total = (size_t)stream.total_out;
+    deflateEnd(&stream);
+
+    if (result != Z_STREAM_END || total >= size - size / 16) {
+        SDL_free(compressed);
+        return NULL;
+    }
+
+    *compressedSize = (Uint32)total;
+    return compressed;
+#else
+    (void)data;
+    (void)size;
+    (void)compressedSize;
+    return NULL;
+#endif
+}
+
+/**
+ * Pads the local header's extra field, so a stored entry's data starts on an aligned offset.
+ */
+static Uint16 packAlignmentPadding(Uint32 offset, size_t nameLength) {
+    Uint32 dataOffset = offset + PACK_LOCAL_HEADER_SIZE + (Uint32)nameLength;
+    Uint32 padding = (config.alignment - dataOffset % config.alignment) % config.alignment;
+
+    // An extra field needs room for its own 4 byte header.
+    if (padding != 0 && padding < 4) {
+        padding += config.alignment;
+    }
+
+    return (Uint16)padding;
+}
+
+static bool packWriteExtraPadding(SDL_IOStream* zip, Uint16 padding) {
+    if (padding == 0) {
+        return true;
+    }
+
+    // The same record zipalign uses: the alignment, then zeros.
+    if (!SDL_WriteU16LE(zip, PACK_ALIGNMENT_EXTRA_ID) || !SDL_WriteU16LE(zip, (Uint16)(padding - 4))) {
+        return false;
+    }
+    Uint8 zeros[256];
+    SDL_zeroa(zeros);
+    Uint16 remaining = (Uint16)(padding - 4);
+    if (remaining >= 2) {
+        if (!SDL_WriteU16LE(zip, (Uint16)SDL_min(config.alignment, 0xFFFF))) {
+            return false;
+        }
+        remaining = (Uint16)(remaining - 2);
+    }
+    while (remaining > 0) {
+        size_t chunk = SDL_min(remaining, sizeof(zeros));
+        if (SDL_WriteIO(zip, zeros, chunk) != chunk) {
+            return false;
+        }
+        remaining = (Uint16)(remaining - chunk);
+    }
+
+    return true;
+}
+
+/**
+ * Writes an entry's local header and data.
+ */
+static bool packWriteEntry(SDL_IOStream* zip, PackEntry* entry) {
+    char path[1024];
+    SDL_snprintf(path, sizeof(path), "%s/%s", config.directory, entry->name);
+    size_t size;
+    Uint8* data = (Uint8*)SDL_LoadFile(path, &size);
+    if (data == NULL) {
+        return false;
+    }
+    if ((Uint64)size >= 0xFFFFFFFF || SDL_TellIO(zip) >= 0xFFFFFFFF) {
+        SDL_free(data);
+        return SDL_SetError("%s: zip64 archives are not supported", entry->name);
+    }
+
+    entry->size = size;
+    entry->crc = SDL_crc32(0, data, size);
+    entry->offset = (Uint32)SDL_TellIO(zip);
+
+    Uint8* compressed = NULL;
+    if (!config.index && !packIsCompressedFormat(entry->name)) {
+        compressed = packDeflate(data, size, &entry->compressedSize);
+    }
+    size_t nameLength = SDL_strlen(entry->name);
+    if (compressed != NULL) {
+        entry->method = 8;
+        entry->extraLength = 0;
+    }
+    else {
+        entry->method = 0;
+        entry->compressedSize = (Uint32)size;
+        entry->extraLength = packAlignmentPadding(entry->offset, nameLength);
+    }
+
+    Uint16 dosTime, dosDate;
+    packDosTime(entry->modified, &dosTime, &dosDate);
+
+    bool result = SDL_WriteU32LE(zip, 0x04034b50) &&
+        SDL_WriteU16LE(zip, entry->method == 8 ? 20 : 10) &&
+        SDL_WriteU16LE(zip, 0) &&
+        SDL_WriteU16LE(zip, entry->method) &&
+        SDL_WriteU16LE(zip, dosTime) &&
+        SDL_WriteU16LE(zip, dosDate) &&
+        SDL_WriteU32LE(zip, entry->crc) &&
+        SDL_WriteU32LE(zip, entry->compressedSize) &&
+        SDL_WriteU32LE(zip, (Uint32)size) &&
+        SDL_WriteU16LE(zip, (Uint16)nameLength) &&
+        SDL_WriteU16LE(zip, entry->extraLength) &&
+        SDL_WriteIO(zip, entry->name, nameLength) == nameLength &&
+        packWriteExtraPadding(zip, entry->extraLength) &&
+        SDL_WriteIO(zip, compressed != NULL ? compressed : data, entry->compressedSize) == entry->compressedSize;
+
+    SDL_free(compressed);
+    SDL_free(data);
+
+    // The next entry, or the central directory, has to start within 4 GiB.
+    if (result && SDL_TellIO(zip) >= 0xFFFFFFFF) {
+        return SDL_SetError("%s: zip64 archives are not supported", entry->name);
+    }
+    return result;
+}
+
+/**
+ * Writes the central directory, in the same order as the entries, followed by the end of central directory record.
+ */
+static bool packWriteCentralDirectory(SDL_IOStream* zip, const PackEntry* entries, int count) {
+    if (count > 0xFFFF || SDL_TellIO(zip) >= 0xFFFFFFFF) {
+        return SDL_SetError("zip64 archives are not supported");
+    }
+    Uint32 directoryOffset = (Uint32)SDL_TellIO(zip);
+    for (int i = 0; i < count; i++) {
+        const PackEntry* entry = &entries[i];
+        Uint16 nameLength = (Uint16)SDL_strlen(entry->name);
+        Uint16 dosTime, dosDate;
+        packDosTime(entry->modified, &dosTime, &dosDate);
+
+        if (!SDL_WriteU32LE(zip, 0x02014b50) ||
+            !SDL_WriteU16LE(zip, 20) ||
+            !SDL_WriteU16LE(zip, entry->method == 8 ? 20 : 10) ||
+            !SDL_WriteU16LE(zip, 0) ||
+            !SDL_WriteU16LE(zip, entry->method) ||
+            !SDL_WriteU16LE(zip, dosTime) ||
+            !SDL_WriteU16LE(zip, dosDate) ||
+            !SDL_WriteU32LE(zip, entry->crc) ||
+            !SDL_WriteU32LE(zip, entry->compressedSize) ||
+            !SDL_WriteU32LE(zip, (Uint32)entry->size) ||
+            !SDL_WriteU16LE(zip, nameLength) ||
+            !SDL_WriteU16LE(zip, 0) ||
+            !SDL_WriteU16LE(zip, 0) ||
+            !SDL_WriteU16LE(zip, 0) ||
+            !SDL_WriteU16LE(zip, 0) ||
+            !SDL_WriteU32LE(zip, 0) ||
+            !SDL_WriteU32LE(zip, entry->offset) ||
+            SDL_WriteIO(zip, entry->name, nameLength) != nameLength) {
+            return false;
+        }
+    }
+    if (SDL_TellIO(zip) >= 0xFFFFFFFF) {
+        return SDL_SetError("zip64 archives are not supported");
+    }
+    Uint32 directorySize = (Uint32)SDL_TellIO(zip) - directoryOffset;
+
+    return SDL_WriteU32LE(zip, 0x06054b50) &&
+        SDL_WriteU16LE(zip, 0) &&
+        SDL_WriteU16LE(zip, 0) &&
+        SDL_WriteU16LE(zip, (Uint16)count) &&
+        SDL_WriteU16LE(zip, (Uint16)count) &&
+        SDL_WriteU32LE(zip, directorySize) &&
+        SDL_WriteU32LE(zip, directoryOffset) &&
+        SDL_WriteU16LE(zip, 0);
+}
+
+/**
+ * Mounts the written archive, and compares every entry against its source.
+ */
+static bool packVerify(const char* argv0, const PackEntry* entries, int count) {
+    if (!SDL_PhysFS_Init(argv0)) {
+        return false;
+    }
+    if (!SDL_PhysFS_Mount(config.output, "pack")) {
+        SDL_PhysFS_Quit();
+        return false;
+    }
+
+    bool result = true;
+    char filename[1024];
+    for (int i = 0; i < count && result; i++) {
+        size_t size;
+        SDL_snprintf(filename, sizeof(filename), "pack/%s", entries[i].name);
+        void* data = SDL_PhysFS_LoadFile(filename, &size);
+        if (data == NULL || size != entries[i].size || SDL_crc32(0, data, size) != entries[i].crc) {
+            result = SDL_SetError("%s: doesn't match its source", entries[i].name);
+        }
+        SDL_free(data);
+    }
+
+    SDL_PhysFS_Quit();
+    return result;
+}
+
+static bool packParseArguments(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (SDL_strcmp(argv[i], "--no-verify") == 0) {
+            config.verify = false;
+        }
+        else if (SDL_strcmp(argv[i], "--index") == 0) {
+            config.index = true;
+        }
+        else if (SDL_strcmp(argv[i], "--manifest") == 0 && i + 1 < argc) {
+            config.manifest = argv[++i];
+        }
+        else if (SDL_strcmp(argv[i], "--align") == 0 && i + 1 < argc) {
+            config.alignment = (Uint32)SDL_strtoul(argv[++i], NULL, 10);
+        }
+        else if (config.directory == NULL) {
+            config.directory = argv[i];
+        }
+        else if (config.output == NULL) {
+            config.output = argv[i];
+        }
+        else {
+            return false;
+        }
+    }
+
+    // The padding needs room for a 4 byte extra field header, and has to fit in 16 bits.
+    bool powerOfTwo = (config.alignment & (config.alignment - 1)) == 0;
+    return config.directory != NULL && config.output != NULL && powerOfTwo && config.alignment >= 4 && config.alignment <= 0x8000;
+}
+
+int main(int argc, char* argv[]) {
+    if (!packParseArguments(argc, argv)) {
+        fprintf(stderr, "Usage: %s [--manifest FILE] [--align BYTES] [--index] [--no-verify] <directory> <output.zip>\n", argv[0]);
+        return 1;
+    }
+
+    int count = 0;
+    PackEntry* entries = packCollectEntries(config.directory, &count);
+    if (entries == NULL) {
+        fprintf(stderr, "%s: %s\n", config.directory, SDL_GetError());
+        return 1;
+    }
+    if (count > 0xFFFF) {
+        fprintf(stderr, "%s: zip64 archives are not supported\n", config.directory);
+        packFreeEntries(entries, count);
+        return 1;
+    }
+    if (config.manifest != NULL && !packApplyManifest(entries, count, config.manifest)) {
+        fprintf(stderr, "%s: %s\n", config.manifest, SDL_GetError());
+        packFreeEntries(entries, count);
+        return 1;
+    }
+    SDL_qsort(entries, (size_t)count, sizeof(PackEntry), packCompareEntries);
+
+    SDL_IOStream* zip = SDL_IOFromFile(config.output, "wb");
+    if (zip == NULL) {
+        fprintf(stderr, "%s: %s\n", config.output, SDL_GetError());
+        packFreeEntries(entries, count);
+        return 1;
+    }
+
+    bool result = true;
+    int stored = 0;
+    for (int i = 0; i < count && result; i++) {
+        result = packWriteEntry(zip, &entries[i]);
+        stored += result && entries[i].method == 0;
+    }
+    result = result && packWriteCentralDirectory(zip, entries, count);
+    result = SDL_CloseIO(zip) && result;
+    result = result && (!config.index || SDL_PhysFS_WriteMountIndex(config.output));
+    if (!result) {
+        fprintf(stderr, "%s: %s\n", config.output, SDL_GetError());
+        packFreeEntries(entries, count);
+        return 1;
+    }
+
+    if (config.verify && !packVerify(argv[0], entries, count)) {
+        fprintf(stderr, "%s: %s\n", config.output, SDL_GetError());
+        packFreeEntries(entries, count);
+        return 1;
+    }
+
+    printf("%s: %d entries, %d stored, %d deflated\n", config.output, count, stored, count - stored);
+    packFreeEntries(entries, count);
+    return 0;
+}